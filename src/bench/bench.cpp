@@ -0,0 +1,95 @@
+// Copyright (c) 2015-2016 The Bitcoin Core developers
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "commons/util/time.h"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+benchmark::BenchRunner::BenchmarkMap &benchmark::BenchRunner::benchmarks() {
+    static BenchmarkMap benchmarksMap;
+    return benchmarksMap;
+}
+
+benchmark::BenchRunner::BenchRunner(std::string name, benchmark::BenchFunction func) {
+    benchmarks().insert(std::make_pair(name, func));
+}
+
+int32_t benchmark::BenchRunner::RunAll(const std::string &filter, double elapsedTimeForOne) {
+    int32_t failed = 0;
+    cout << "#Benchmark" << "," << "count" << "," << "min(us)" << "," << "max(us)" << "," << "average(us)" << "\n";
+
+    for (const auto &item : benchmarks()) {
+        if (!filter.empty() && item.first.find(filter) == string::npos)
+            continue;
+
+        State state(item.first, elapsedTimeForOne);
+        item.second(state);
+        if (state.IsFailed())
+            failed++;
+    }
+    return failed;
+}
+
+void benchmark::BenchRunner::ListAll() {
+    for (const auto &item : benchmarks())
+        cout << item.first << "\n";
+}
+
+bool benchmark::State::KeepRunning() {
+    if (fFailed)
+        return false;
+
+    if (count & countMask) {
+        ++count;
+        return true;
+    }
+
+    double now;
+    if (count == 0) {
+        lastTime = beginTime = now = GetTimeMicros() * 1e-6;
+    } else {
+        now = GetTimeMicros() * 1e-6;
+        double elapsed    = now - lastTime;
+        double elapsedOne = elapsed / (countMask + 1);
+        if (elapsedOne < minTime) minTime = elapsedOne;
+        if (elapsedOne > maxTime) maxTime = elapsedOne;
+
+        // The time is only read every countMask+1 iterations, the mask grows until a batch of
+        // iterations takes long enough to be measured, then min and max are of the batch average.
+        if (elapsed * 128 < maxElapsed) {
+            // much too fast, grow the batch 8x and restart the min/max timing
+            countMask = ((countMask << 3) | 7) & ((1LL << 60) - 1);
+            minTime   = std::numeric_limits<double>::max();
+            maxTime   = std::numeric_limits<double>::min();
+            return true;
+        }
+        if (elapsed * 16 < maxElapsed) {
+            countMask = ((countMask << 1) | 1) & ((1LL << 60) - 1);
+        }
+    }
+    lastTime = now;
+    ++count;
+
+    if (now - beginTime < maxElapsed)
+        return true;  // Keep going
+
+    --count;
+
+    double average = (now - beginTime) / count;
+    cout << fixed << setprecision(3) << name << "," << count << "," << minTime * 1e6 << "," << maxTime * 1e6 << ","
+         << average * 1e6 << "\n";
+
+    return false;
+}
+
+void benchmark::State::Fail(const std::string &reason) {
+    fFailed = true;
+    cout << name << ",failed: " << reason << "\n";
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2015-2016 The Bitcoin Core developers
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COIN_BENCH_BENCH_H
+#define COIN_BENCH_BENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+// Simple micro-benchmarking framework, from the one of Bitcoin Core.
+//
+// A benchmark is a function looping while State::KeepRunning() is true, registered by BENCHMARK():
+//
+// static void CODE_TO_TIME(benchmark::State &state) {
+//     ... do any setup needed...
+//     while (state.KeepRunning()) {
+//        ... do stuff you want to time...
+//     }
+//     ... do any cleanup needed...
+// }
+//
+// BENCHMARK(CODE_TO_TIME);
+
+namespace benchmark {
+
+class State {
+    std::string name;
+    double maxElapsed;
+    double beginTime;
+    double lastTime, minTime, maxTime;
+    uint64_t count;
+    uint64_t countMask;
+    bool fFailed;
+
+public:
+    State(std::string nameIn, double maxElapsedIn) : name(nameIn), maxElapsed(maxElapsedIn), count(0) {
+        minTime   = std::numeric_limits<double>::max();
+        maxTime   = std::numeric_limits<double>::min();
+        countMask = 1;
+        fFailed   = false;
+    }
+
+    bool KeepRunning();
+    // stop the benchmark and report it as failed, e.g. when the timed code returned an error
+    void Fail(const std::string &reason);
+    bool IsFailed() const { return fFailed; }
+};
+
+typedef std::function<void(State &)> BenchFunction;
+
+class BenchRunner {
+    typedef std::map<std::string, BenchFunction> BenchmarkMap;
+    static BenchmarkMap &benchmarks();
+
+public:
+    BenchRunner(std::string name, BenchFunction func);
+
+    // run the benchmarks whose name contains the filter, each for about elapsedTimeForOne seconds.
+    // returns the number of failed benchmarks
+    static int32_t RunAll(const std::string &filter, double elapsedTimeForOne = 1.0);
+    static void ListAll();
+};
+
+}  // namespace benchmark
+
+// BENCHMARK(foo) expands to:  benchmark::BenchRunner bench_11foo("foo", foo);
+#define BENCHMARK(n) \
+    benchmark::BenchRunner BOOST_PP_CAT(bench_, BOOST_PP_CAT(__LINE__, n))(BOOST_PP_STRINGIZE(n), n);
+
+#endif  // COIN_BENCH_BENCH_H
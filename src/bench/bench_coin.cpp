@@ -0,0 +1,62 @@
+// Copyright (c) 2015-2016 The Bitcoin Core developers
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "main.h"
+#include "logging.h"
+#include "config/chainparams.h"
+#include "entities/key.h"
+#include "persistence/cachewrapper.h"
+
+#include <boost/filesystem.hpp>
+
+int main(int argc, char **argv) {
+    SetupEnvironment();
+    CBaseParams::ParseParameters(argc, argv);
+
+    if (CBaseParams::IsArgCount("-?") || CBaseParams::IsArgCount("-help")) {
+        printf("Usage: bench_coin [options]\n\n"
+               "Options:\n"
+               "  -filter=<name>    Run the benchmarks whose name contains <name> only\n"
+               "  -time=<seconds>   Time to run each benchmark (default: 1)\n"
+               "  -list             List the benchmarks\n");
+        return 0;
+    }
+    if (CBaseParams::IsArgCount("-list")) {
+        benchmark::BenchRunner::ListAll();
+        return 0;
+    }
+
+    // The benchmarks run on the regtest params over in-memory dbs, nothing is written to the data dir
+    boost::filesystem::path dataDir = GetTempPath() / strprintf("bench_coin_%d_%d", GetTime(), GetRand(100000));
+    boost::filesystem::create_directories(dataDir);
+    CBaseParams::SoftSetArg("-datadir", dataDir.string());
+    CBaseParams::SoftSetArg("-nettype", "regtest");
+    SysCfg().InitializeConfig();
+
+    // drop the log lines of the benchmarked code
+    LogInstance().m_print_to_console = false;
+    LogInstance().m_print_to_file    = false;
+    LogInstance().m_queue_size       = 0;
+    LogInstance().StartLogging();
+
+    ECC_Start();
+    int32_t failed = 0;
+    {
+        ECCVerifyHandle verifyHandle;
+        pCdMan = new CCacheDBManager(false, true);
+
+        failed = benchmark::BenchRunner::RunAll(CBaseParams::GetArg("-filter", ""),
+                                                atof(CBaseParams::GetArg("-time", "1").c_str()));
+
+        delete pCdMan;
+        pCdMan = nullptr;
+    }
+    ECC_Stop();
+
+    boost::filesystem::remove_all(dataDir);
+    return failed == 0 ? 0 : 1;
+}
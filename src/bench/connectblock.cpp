@@ -0,0 +1,175 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "main.h"
+#include "miner/miner.h"
+#include "persistence/cachewrapper.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+
+#include <memory>
+
+using namespace std;
+
+static const uint32_t BLOCK_TX_COUNT     = 1000;
+static const uint32_t BLOCK_SENDER_COUNT = 100;
+
+// The block at height 1 of regtest on top of the genesis block, transferring coins between
+// BLOCK_SENDER_COUNT accounts and produced by one of the generated delegates.
+class CBenchChain {
+public:
+    unique_ptr<CCacheWrapper> spCw;
+    CBlock block;
+    CBlockIndex genesisIndex;
+    CBlockIndex blockIndex;
+    uint256 blockHash;
+
+    CBenchChain() : spCw(new CCacheWrapper(pCdMan)) {}
+
+    ~CBenchChain() {
+        LOCK(cs_main);
+        mapBlockIndex.erase(SysCfg().GetGenesisBlockHash());
+    }
+
+    bool Init() {
+        const int32_t height = 1;
+        const uint32_t time  = GetTime();
+
+        // the delegates, all mature since the genesis block
+        map<CRegID, CKey> delegateKeys;
+        VoteDelegateVector delegates;
+        for (uint32_t i = 0; i < (uint32_t)IniCfg().GetTotalDelegateNum(); i++) {
+            CKey key;
+            CAccount account = NewAccount(CRegID(0, i + 1), 100 * COIN, key);
+            if (!spCw->accountCache.SaveAccount(account))
+                return false;
+
+            delegateKeys.emplace(account.regid, key);
+            delegates.push_back({account.regid, 100 * COIN - i});
+        }
+
+        PendingDelegates pendingDelegates;
+        pendingDelegates.state               = VoteDelegateState::ACTIVATED;
+        pendingDelegates.counted_vote_height = height;
+        pendingDelegates.top_vote_delegates  = delegates;
+        if (!spCw->delegateCache.SetActiveDelegates(delegates) ||
+            !spCw->delegateCache.SetPendingDelegates(pendingDelegates))
+            return false;
+
+        // the transfers
+        vector<pair<CRegID, CKey>> senders;
+        for (uint32_t i = 0; i < BLOCK_SENDER_COUNT; i++) {
+            CKey key;
+            CAccount account = NewAccount(CRegID(0, 1000 + i), 10000 * COIN, key);
+            if (!spCw->accountCache.SaveAccount(account))
+                return false;
+
+            senders.emplace_back(account.regid, key);
+        }
+
+        uint64_t minFee;
+        if (!GetTxMinFee(BCOIN_TRANSFER_TX, height, SYMB::WICC, minFee))
+            return false;
+
+        uint64_t totalFuel = 0, rewardFees = 0;
+        block.vptx.push_back(std::make_shared<CBlockRewardTx>());
+        for (uint32_t i = 0; i < BLOCK_TX_COUNT; i++) {
+            const auto &sender = senders[i % senders.size()];
+            const auto &to     = senders[(i + 1) % senders.size()];
+            auto pTx = std::make_shared<CBaseCoinTransferTx>(sender.first, to.first, height, COIN + i, minFee, "");
+            if (!sender.second.Sign(pTx->GetHash(), pTx->signature))
+                return false;
+
+            uint64_t fuel = pTx->GetFuel(height, INIT_FUEL_RATES);
+            totalFuel += fuel;
+            rewardFees += minFee - fuel;
+            block.vptx.push_back(pTx);
+        }
+
+        // the block, signed by the delegate of its slot
+        block.SetVersion(CBlockHeader::CURRENT_VERSION);
+        block.SetPrevBlockHash(SysCfg().GetGenesisBlockHash());
+        block.SetHeight(height);
+        block.SetTime(time);
+        block.SetNonce(0);
+        block.SetFuel(totalFuel);
+        block.SetFuelRate(INIT_FUEL_RATES);
+
+        VoteDelegate curDelegate;
+        ShuffleDelegates(height, time, delegates);
+        if (!GetCurrentDelegate(time, height, delegates, curDelegate))
+            return false;
+
+        auto pRewardTx          = (CBlockRewardTx *)block.vptx[0].get();
+        pRewardTx->txUid        = curDelegate.regid;
+        pRewardTx->valid_height = height;
+        pRewardTx->reward_fees  = rewardFees;
+
+        block.SetMerkleRootHash(block.BuildMerkleTree());
+        vector<uint8_t> signature;
+        if (!delegateKeys[curDelegate.regid].Sign(block.GetHash(), signature))
+            return false;
+        block.SetSignature(signature);
+
+        // the chain state of the genesis block
+        {
+            LOCK(cs_main);
+            auto it = mapBlockIndex.insert(make_pair(SysCfg().GetGenesisBlockHash(), &genesisIndex)).first;
+            genesisIndex.pBlockHash = &it->first;
+        }
+        spCw->blockCache.SetBestBlock(SysCfg().GetGenesisBlockHash());
+
+        blockHash             = block.GetHash();
+        blockIndex            = CBlockIndex(block);
+        blockIndex.pBlockHash = &blockHash;
+        blockIndex.pprev      = &genesisIndex;
+        blockIndex.height     = height;
+        return true;
+    }
+
+private:
+    static CAccount NewAccount(const CRegID &regid, const uint64_t balance, CKey &key) {
+        key.MakeNewKey();
+        CAccount account(key.GetPubKey().GetKeyId(), CNickID(), key.GetPubKey());
+        account.regid = regid;
+        account.OperateBalance(SYMB::WICC, BalanceOpType::ADD_FREE, balance);
+        return account;
+    }
+};
+
+// the execution of all the txs of a block on a child cache of the chain state, as the check of
+// a mined or received block does
+static void ConnectBlock1kTx(benchmark::State &state) {
+    CBenchChain chain;
+    if (!chain.Init())
+        return state.Fail("init the chain failed");
+
+    LOCK(cs_main);
+    while (state.KeepRunning()) {
+        CCacheWrapper cw(chain.spCw.get());
+        CValidationState validationState;
+        if (!ConnectBlock(chain.block, cw, &chain.blockIndex, validationState, true))
+            return state.Fail(validationState.GetRejectReason());
+    }
+}
+
+// the context-free checks of a block with its txs, the signatures found in the signature cache
+// after the first round
+static void CheckBlock1kTx(benchmark::State &state) {
+    CBenchChain chain;
+    if (!chain.Init())
+        return state.Fail("init the chain failed");
+
+    LOCK(cs_main);
+    while (state.KeepRunning()) {
+        CValidationState validationState;
+        if (!CheckBlock(chain.block, validationState, *chain.spCw, true, true))
+            return state.Fail(validationState.GetRejectReason());
+    }
+}
+
+BENCHMARK(ConnectBlock1kTx);
+BENCHMARK(CheckBlock1kTx);
@@ -0,0 +1,106 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "config/const.h"
+#include "persistence/cachewrapper.h"
+#include "tx/contracttx.h"
+#include "tx/wasmcontracttx.h"
+#include "vm/luavm/luavmrunenv.h"
+#include "wasm/exception/exceptions.hpp"
+#include "wasm/types/name.hpp"
+#include "wasm/wasm_trace.hpp"
+
+using namespace std;
+
+// sums the squares of 1..1000
+static const string LUA_BENCH_CODE =
+    "local sum = 0\n"
+    "for i = 1, 1000 do\n"
+    "    sum = sum + i * i\n"
+    "end\n";
+
+// a wasm module exporting apply(i64 receiver, i64 code, i64 action), counting from 0 to 10000 in a loop
+static const uint8_t WASM_BENCH_CODE[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,                    // magic, version
+    0x01, 0x07, 0x01, 0x60, 0x03, 0x7e, 0x7e, 0x7e, 0x00,              // type: (i64, i64, i64) -> ()
+    0x03, 0x02, 0x01, 0x00,                                            // function: type 0
+    0x07, 0x09, 0x01, 0x05, 0x61, 0x70, 0x70, 0x6c, 0x79, 0x00, 0x00,  // export: "apply"
+    0x0a, 0x17, 0x01, 0x15, 0x01, 0x01, 0x7f,                          // code: one i32 local
+    0x03, 0x40,                                                        // loop
+    0x20, 0x03, 0x41, 0x01, 0x6a, 0x22, 0x03,                          //   local3 = local3 + 1
+    0x41, 0x90, 0xce, 0x00, 0x49, 0x0d, 0x00,                          //   br_if 0 (local3 < 10000)
+    0x0b, 0x0b                                                         // end, end
+};
+
+static void RunLuaContract(benchmark::State &state, const int32_t height) {
+    CCacheWrapper cw(pCdMan);
+    CUniversalContract contract(LUA_BENCH_CODE, "bench");
+    string arguments;
+    CLuaContractInvokeTx tx;
+    CAccount txAccount, appAccount;
+    appAccount.regid = CRegID(1, 1);
+
+    while (state.KeepRunning()) {
+        CLuaVMContext luaContext;
+        luaContext.p_cw              = &cw;
+        luaContext.height            = height;
+        luaContext.p_base_tx         = &tx;
+        luaContext.fuel_limit        = MAX_BLOCK_RUN_STEP;
+        luaContext.transfer_symbol   = SYMB::WICC;
+        luaContext.p_tx_user_account = &txAccount;
+        luaContext.p_app_account     = &appAccount;
+        luaContext.p_contract        = &contract;
+        luaContext.p_arguments       = &arguments;
+
+        CLuaVMRunEnv vmRunEnv;
+        uint64_t runStep = 0;
+        auto pExecErr    = vmRunEnv.ExecuteContract(&luaContext, runStep);
+        if (pExecErr)
+            return state.Fail(*pExecErr);
+    }
+}
+
+// the contract chunk is loaded from the chunk cache before the feature fork
+static void LuaContractChunkCached(benchmark::State &state) { RunLuaContract(state, 1); }
+
+// the contract code is parsed by every run since the feature fork
+static void LuaContractParsed(benchmark::State &state) {
+    RunLuaContract(state, SysCfg().GetFeatureForkHeight());
+}
+
+static void WasmContractApply(benchmark::State &state) {
+    const uint64_t contractName = wasm::string_to_name("bench");
+
+    CCacheWrapper cw(pCdMan);
+    CAccount contractAccount(CKeyID(Hash160(BEGIN(contractName), END(contractName))));
+    contractAccount.regid  = CRegID(1, 1);
+    contractAccount.nickid = CNickID(contractName);
+    CUniversalContract contract(VMType::WASM_VM, false,
+                                string((const char *)WASM_BENCH_CODE, sizeof(WASM_BENCH_CODE)), "bench", "");
+    if (!cw.accountCache.SaveAccount(contractAccount) || !cw.accountCache.SetNickId(contractAccount, 1) ||
+        !cw.contractCache.SaveContract(contractAccount.regid, contract))
+        return state.Fail("deploy contract failed");
+
+    CWasmContractTx tx;
+    wasm::inline_transaction trx;
+    trx.contract = contractName;
+    trx.action   = wasm::string_to_name("run");
+
+    try {
+        while (state.KeepRunning()) {
+            tx.pseudo_start = system_clock::now();
+            wasm::inline_transaction_trace trace;
+            vector<CReceipt> receipts;
+            tx.execute_inline_transaction(trace, trx, trx.contract, cw, receipts, 0);
+        }
+    } catch (wasm_chain::exception &e) {
+        state.Fail(e.to_detail_string());
+    }
+}
+
+BENCHMARK(LuaContractChunkCached);
+BENCHMARK(LuaContractParsed);
+BENCHMARK(WasmContractApply);
@@ -0,0 +1,141 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "crypto/hash.h"
+#include "entities/account.h"
+#include "persistence/dbaccess.h"
+
+#include <memory>
+
+using namespace std;
+
+typedef CCompositeKVCache<dbk::KEYID_ACCOUNT, CKeyID, CAccount> AccountKVCache;
+
+static const uint32_t DB_ACCOUNT_COUNT = 10000;
+
+static CKeyID GetBenchKeyId(uint32_t i) { return CKeyID(Hash160(BEGIN(i), END(i))); }
+
+// an in-memory account db holding DB_ACCOUNT_COUNT accounts
+static shared_ptr<CDBAccess> NewAccountDb() {
+    auto pDbAccess = make_shared<CDBAccess>(GetDataDir() / "bench", DBNameType::ACCOUNT, true, true);
+
+    AccountKVCache dbCache(pDbAccess.get());
+    for (uint32_t i = 0; i < DB_ACCOUNT_COUNT; i++) {
+        CAccount account(GetBenchKeyId(i));
+        account.OperateBalance(SYMB::WICC, BalanceOpType::ADD_FREE, 100000 + i);
+        dbCache.SetData(account.keyid, account);
+    }
+    dbCache.Flush();
+    return pDbAccess;
+}
+
+// read an account through the tx, block and db level caches, as the execution of a tx does
+static void CompositeCacheGetNested(benchmark::State &state) {
+    auto pDbAccess = NewAccountDb();
+    AccountKVCache dbCache(pDbAccess.get());
+    AccountKVCache blockCache(&dbCache);
+    AccountKVCache txCache(&blockCache);
+
+    CAccount account;
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        if (!txCache.GetData(GetBenchKeyId(i++ % DB_ACCOUNT_COUNT), account))
+            return state.Fail("account not found");
+    }
+}
+
+// update two accounts in a tx level cache and flush it into the block level, once per tx
+static void CompositeCacheSetFlush(benchmark::State &state) {
+    auto pDbAccess = NewAccountDb();
+    AccountKVCache dbCache(pDbAccess.get());
+    AccountKVCache blockCache(&dbCache);
+
+    CAccount from, to;
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        AccountKVCache txCache(&blockCache);
+        CKeyID fromKeyId = GetBenchKeyId(i % DB_ACCOUNT_COUNT);
+        CKeyID toKeyId   = GetBenchKeyId((i + 1) % DB_ACCOUNT_COUNT);
+        if (!txCache.GetData(fromKeyId, from) || !txCache.GetData(toKeyId, to))
+            return state.Fail("account not found");
+
+        from.OperateBalance(SYMB::WICC, BalanceOpType::SUB_FREE, 1);
+        to.OperateBalance(SYMB::WICC, BalanceOpType::ADD_FREE, 1);
+        txCache.SetData(fromKeyId, from);
+        txCache.SetData(toKeyId, to);
+        txCache.Flush();
+        i++;
+    }
+}
+
+// write the 100 accounts changed by a block from the db level cache into the db
+static void CompositeCacheFlushToDb(benchmark::State &state) {
+    auto pDbAccess = NewAccountDb();
+    AccountKVCache dbCache(pDbAccess.get());
+
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        for (uint32_t n = 0; n < 100; n++, i++) {
+            CAccount account(GetBenchKeyId(i % DB_ACCOUNT_COUNT));
+            account.OperateBalance(SYMB::WICC, BalanceOpType::ADD_FREE, i);
+            dbCache.SetData(account.keyid, account);
+        }
+        dbCache.Flush();
+    }
+}
+
+// one tx level cache per tx over a block level cache of large values, as done when packing a block:
+// read 100 values, write one and flush, which must not copy the untouched values of the lower level
+static void CompositeCacheNestedCopyOnWrite(benchmark::State &state) {
+    typedef CCompositeKVCache<dbk::REGID_KEYID, string, string> StringKVCache;
+    auto pDbAccess = make_shared<CDBAccess>(GetDataDir() / "bench", DBNameType::ACCOUNT, true, true);
+    StringKVCache blockCache(pDbAccess.get());
+    const string bigValue(1024, 'v');
+    for (uint32_t i = 0; i < DB_ACCOUNT_COUNT; i++)
+        blockCache.SetData(strprintf("regid-%u", i), bigValue);
+
+    string value;
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        StringKVCache txCache(&blockCache);
+        for (uint32_t i = n % 100; i < DB_ACCOUNT_COUNT; i += 100) {
+            if (!txCache.GetData(strprintf("regid-%u", i), value))
+                return state.Fail("value not found");
+        }
+        txCache.SetData(strprintf("regid-%u", n++ % DB_ACCOUNT_COUNT), value);
+        txCache.Flush();
+    }
+}
+
+// look an account up in the db, as every cache miss does
+static void DbAccessGetData(benchmark::State &state) {
+    auto pDbAccess = NewAccountDb();
+
+    CAccount account;
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        if (!pDbAccess->GetData(dbk::KEYID_ACCOUNT, GetBenchKeyId(i++ % DB_ACCOUNT_COUNT), account))
+            return state.Fail("account not found");
+    }
+}
+
+// iterate over all the accounts of the db
+static void DbAccessGetAllElements(benchmark::State &state) {
+    auto pDbAccess = NewAccountDb();
+
+    while (state.KeepRunning()) {
+        map<CKeyID, CAccount> accounts;
+        if (!pDbAccess->GetAllElements(dbk::KEYID_ACCOUNT, accounts) || accounts.size() != DB_ACCOUNT_COUNT)
+            return state.Fail("accounts not found");
+    }
+}
+
+BENCHMARK(CompositeCacheGetNested);
+BENCHMARK(CompositeCacheSetFlush);
+BENCHMARK(CompositeCacheFlushToDb);
+BENCHMARK(CompositeCacheNestedCopyOnWrite);
+BENCHMARK(DbAccessGetData);
+BENCHMARK(DbAccessGetAllElements);
@@ -0,0 +1,79 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "commons/json/json_spirit_writer_template.h"
+#include "commons/json/json_stream_writer.h"
+#include "commons/util/util.h"
+
+using namespace json_spirit;
+using namespace std;
+
+static const int32_t ORDER_COUNT = 1000;
+
+// an order list shaped like the getdexorders result, built as a value tree then written
+static string WriteOrdersValueTree() {
+    Object obj;
+    obj.push_back(Pair("count", (int64_t)ORDER_COUNT));
+    Array orders;
+    for (int32_t i = 0; i < ORDER_COUNT; i++) {
+        Object order;
+        order.push_back(Pair("order_id",     strprintf("%064x", i)));
+        order.push_back(Pair("order_type",   "LIMIT_PRICE"));
+        order.push_back(Pair("coin_symbol",  "WUSD"));
+        order.push_back(Pair("asset_symbol", "WICC"));
+        order.push_back(Pair("coin_amount",  (uint64_t)i * 100000000));
+        order.push_back(Pair("price",        (uint64_t)i * 3));
+        order.push_back(Pair("dex_id",       (int64_t)0));
+        order.push_back(Pair("has_operator_config", false));
+        orders.push_back(order);
+    }
+    obj.push_back(Pair("orders", orders));
+    return write_string(Value(obj), false);
+}
+
+// the same order list streamed by the writer
+static void WriteOrdersStream(string &out) {
+    out.clear();
+    CJsonWriter writer(out);
+    writer.BeginObject();
+    writer.Pair("count", (int64_t)ORDER_COUNT);
+    writer.Key("orders").BeginArray();
+    for (int32_t i = 0; i < ORDER_COUNT; i++) {
+        writer.BeginObject();
+        writer.Pair("order_id",     strprintf("%064x", i));
+        writer.Pair("order_type",   "LIMIT_PRICE");
+        writer.Pair("coin_symbol",  "WUSD");
+        writer.Pair("asset_symbol", "WICC");
+        writer.Pair("coin_amount",  (uint64_t)i * 100000000);
+        writer.Pair("price",        (uint64_t)i * 3);
+        writer.Pair("dex_id",       (int64_t)0);
+        writer.Pair("has_operator_config", false);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+static void JsonOrdersValueTree(benchmark::State &state) {
+    while (state.KeepRunning()) {
+        if (WriteOrdersValueTree().empty())
+            return state.Fail("empty json");
+    }
+}
+
+static void JsonOrdersStreamWriter(benchmark::State &state) {
+    string out;
+    WriteOrdersStream(out);
+    if (out != WriteOrdersValueTree())
+        return state.Fail("json differs from the value tree");
+
+    while (state.KeepRunning()) {
+        WriteOrdersStream(out);
+    }
+}
+
+BENCHMARK(JsonOrdersValueTree);
+BENCHMARK(JsonOrdersStreamWriter);
@@ -0,0 +1,41 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chain/merkletree.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+
+using namespace std;
+
+static CBlock BuildBlock(const int32_t txCount) {
+    CBlock block;
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(UnsignedCharArray(), 0, 100));
+    for (int32_t i = 1; i < txCount; i++) {
+        block.vptx.push_back(
+            std::make_shared<CBaseCoinTransferTx>(CRegID(1, i), CRegID(2, i), 100, 10000 + i, 10000, ""));
+    }
+    return block;
+}
+
+// the merkle root of a full block, with the txids cached already
+static void MerkleRoot10kTx(benchmark::State &state) {
+    CBlock block = BuildBlock(10000);
+    for (const auto &ptx : block.vptx)
+        ptx->GetHash();
+
+    while (state.KeepRunning())
+        block.BuildMerkleTree();
+}
+
+// the txid of a transfer tx, recalculated every time
+static void TxHash(benchmark::State &state) {
+    CBaseCoinTransferTx tx(CRegID(1, 1), CRegID(2, 1), 100, 10000, 10000, "");
+    while (state.KeepRunning())
+        tx.GetHash(true);
+}
+
+BENCHMARK(MerkleRoot10kTx);
+BENCHMARK(TxHash);
@@ -0,0 +1,118 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "main.h"
+#include "net.h"
+#include "netbase.h"
+#include "p2p/node.h"
+#include "p2p/protocol.h"
+
+#include <memory>
+
+using namespace std;
+
+// A pair of peers connected through a loopback TCP socket, the messages pushed by the sender being
+// read and parsed by the receiver on the same thread.
+class CLoopbackPeers {
+public:
+    unique_ptr<CNode> pSender;
+    unique_ptr<CNode> pReceiver;
+
+    bool Connect() {
+        SOCKET hListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (hListenSocket == INVALID_SOCKET)
+            return false;
+
+        struct sockaddr_in sockaddr;
+        memset(&sockaddr, 0, sizeof(sockaddr));
+        sockaddr.sin_family      = AF_INET;
+        sockaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sockaddr.sin_port        = 0;
+        socklen_t len            = sizeof(sockaddr);
+        if (::bind(hListenSocket, (struct sockaddr *)&sockaddr, len) == SOCKET_ERROR ||
+            listen(hListenSocket, 1) == SOCKET_ERROR ||
+            getsockname(hListenSocket, (struct sockaddr *)&sockaddr, &len) == SOCKET_ERROR) {
+            closesocket(hListenSocket);
+            return false;
+        }
+
+        SOCKET hSendSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (hSendSocket == INVALID_SOCKET ||
+            connect(hSendSocket, (struct sockaddr *)&sockaddr, sizeof(sockaddr)) == SOCKET_ERROR) {
+            closesocket(hListenSocket);
+            return false;
+        }
+        SOCKET hRecvSocket = accept(hListenSocket, nullptr, nullptr);
+        closesocket(hListenSocket);
+        if (hRecvSocket == INVALID_SOCKET) {
+            closesocket(hSendSocket);
+            return false;
+        }
+
+        // both inbound, so that none of them pushes its version
+        CAddress addr = CAddress(CService(sockaddr));
+        pSender.reset(new CNode(hSendSocket, addr, "", true));
+        pReceiver.reset(new CNode(hRecvSocket, addr, "", true));
+        return true;
+    }
+
+    // send the queued messages of the sender and parse them on the receiver until one is complete
+    bool ReceiveMessage() {
+        char pchBuf[0x10000];
+        while (true) {
+            {
+                LOCK(pSender->cs_vSend);
+                if (!pSender->vSendMsg.empty())
+                    pSender->SocketSendData();
+            }
+
+            int32_t nBytes = recv(pReceiver->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+            if (nBytes > 0) {
+                LOCK(pReceiver->cs_vRecvMsg);
+                if (!pReceiver->ReceiveMsgBytes(pchBuf, nBytes))
+                    return false;
+
+                if (pReceiver->vRecvMsg.front().complete()) {
+                    pReceiver->vRecvMsg.clear();
+                    return true;
+                }
+            } else if (nBytes == 0 || (WSAGetLastError() != WSAEWOULDBLOCK && WSAGetLastError() != WSAEINTR)) {
+                return false;
+            }
+        }
+    }
+};
+
+// the round trip of a small message through the socket
+static void NetPingLoopback(benchmark::State &state) {
+    CLoopbackPeers peers;
+    if (!peers.Connect())
+        return state.Fail("connect the peers failed");
+
+    uint64_t nonce = 0;
+    while (state.KeepRunning()) {
+        peers.pSender->PushMessage(NetMsgType::PING, nonce++);
+        if (!peers.ReceiveMessage())
+            return state.Fail("receive the message failed");
+    }
+}
+
+// the throughput of 1MB messages, as the relay of a full block
+static void NetLargeMessageLoopback(benchmark::State &state) {
+    CLoopbackPeers peers;
+    if (!peers.Connect())
+        return state.Fail("connect the peers failed");
+
+    vector<uint8_t> payload(1000000, 0x5a);
+    while (state.KeepRunning()) {
+        peers.pSender->PushMessage(NetMsgType::BLOCK, payload);
+        if (!peers.ReceiveMessage())
+            return state.Fail("receive the message failed");
+    }
+}
+
+BENCHMARK(NetPingLoopback);
+BENCHMARK(NetLargeMessageLoopback);
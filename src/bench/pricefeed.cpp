@@ -0,0 +1,55 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "config/const.h"
+#include "persistence/pricefeeddb.h"
+
+using namespace std;
+
+static const uint64_t PRICE_FEEDER_COUNT  = 11;
+static const uint64_t PRICE_SLIDE_WINDOW  = 11;
+static const CoinPricePair WICC_USD_PAIR  = CoinPricePair(SYMB::WICC, SYMB::USD);
+
+static void AddBlockPrices(CPricePointMemCache &cache, int32_t height) {
+    for (uint32_t i = 0; i < PRICE_FEEDER_COUNT; i++) {
+        vector<CPricePoint> pps = {CPricePoint(WICC_USD_PAIR, 10000000 + (height * 7 + i * 13) % 1000)};
+        cache.AddPrice(height, CRegID(1, i + 1), pps);
+    }
+}
+
+// a block feeding the prices of all the delegates in a child cache, then the median of the slide window,
+// flushed into the chain level cache as the connection of the block does
+static void PriceMedianSlide(benchmark::State &state) {
+    CPricePointMemCache baseCache;
+    int32_t height = 1;
+    for (; height <= (int32_t)PRICE_SLIDE_WINDOW; height++)
+        AddBlockPrices(baseCache, height);
+
+    while (state.KeepRunning()) {
+        CPricePointMemCache blockCache(&baseCache);
+        AddBlockPrices(blockCache, height);
+        if (blockCache.ComputeBlockMedianPrice(height, PRICE_SLIDE_WINDOW, WICC_USD_PAIR) == 0)
+            return state.Fail("no median price");
+
+        blockCache.Flush();
+        height++;
+    }
+}
+
+// the median of a slide window unchanged since the previous computation
+static void PriceMedianUnchanged(benchmark::State &state) {
+    CPricePointMemCache cache;
+    for (int32_t height = 1; height <= (int32_t)PRICE_SLIDE_WINDOW; height++)
+        AddBlockPrices(cache, height);
+
+    while (state.KeepRunning()) {
+        if (cache.ComputeBlockMedianPrice(PRICE_SLIDE_WINDOW, PRICE_SLIDE_WINDOW, WICC_USD_PAIR) == 0)
+            return state.Fail("no median price");
+    }
+}
+
+BENCHMARK(PriceMedianSlide);
+BENCHMARK(PriceMedianUnchanged);
@@ -0,0 +1,79 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "commons/serialize.h"
+#include "entities/account.h"
+#include "persistence/block.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+
+using namespace std;
+
+static CAccount NewAccount() {
+    CKey key;
+    key.MakeNewKey();
+    CAccount account(key.GetPubKey().GetKeyId(), CNickID(), key.GetPubKey());
+    account.regid = CRegID(100, 1);
+    account.OperateBalance(SYMB::WICC, BalanceOpType::ADD_FREE, 100 * COIN);
+    account.OperateBalance(SYMB::WUSD, BalanceOpType::ADD_FREE, 100 * COIN);
+    account.OperateBalance(SYMB::WGRT, BalanceOpType::ADD_FREE, 100 * COIN);
+    return account;
+}
+
+static CBlock NewBlock(const int32_t txCount) {
+    CBlock block;
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(UnsignedCharArray(), 0, 100));
+    for (int32_t i = 1; i < txCount; i++) {
+        block.vptx.push_back(
+            std::make_shared<CBaseCoinTransferTx>(CRegID(1, i), CRegID(2, i), 100, 10000 + i, 10000, ""));
+    }
+    return block;
+}
+
+static void AccountSerialize(benchmark::State &state) {
+    CAccount account = NewAccount();
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    while (state.KeepRunning()) {
+        ss << account;
+        ss.clear();
+    }
+}
+
+static void AccountDeserialize(benchmark::State &state) {
+    CDataStream data(SER_DISK, CLIENT_VERSION);
+    data << NewAccount();
+
+    CAccount account;
+    while (state.KeepRunning()) {
+        CDataStream ss(data.begin(), data.end(), SER_DISK, CLIENT_VERSION);
+        ss >> account;
+    }
+}
+
+static void BlockSerialize1kTx(benchmark::State &state) {
+    CBlock block = NewBlock(1000);
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    while (state.KeepRunning()) {
+        ss << block;
+        ss.clear();
+    }
+}
+
+static void BlockDeserialize1kTx(benchmark::State &state) {
+    CDataStream data(SER_DISK, CLIENT_VERSION);
+    data << NewBlock(1000);
+
+    while (state.KeepRunning()) {
+        CBlock block;
+        CDataStream ss(data.begin(), data.end(), SER_DISK, CLIENT_VERSION);
+        ss >> block;
+    }
+}
+
+BENCHMARK(AccountSerialize);
+BENCHMARK(AccountDeserialize);
+BENCHMARK(BlockSerialize1kTx);
+BENCHMARK(BlockDeserialize1kTx);
@@ -0,0 +1,76 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "main.h"
+#include "sigcache.h"
+#include "entities/key.h"
+
+#include <vector>
+
+using namespace std;
+
+struct SignedHash {
+    uint256 sigHash;
+    vector<uint8_t> signature;
+    CPubKey pubKey;
+};
+
+static vector<SignedHash> SignHashes(uint32_t count) {
+    CKey key;
+    key.MakeNewKey();
+
+    vector<SignedHash> hashes(count);
+    for (uint32_t i = 0; i < count; i++) {
+        hashes[i].sigHash = Hash(BEGIN(i), END(i));
+        hashes[i].pubKey  = key.GetPubKey();
+        key.Sign(hashes[i].sigHash, hashes[i].signature);
+    }
+    return hashes;
+}
+
+// the secp256k1 verification of every tx signature
+static void VerifySignatureUncached(benchmark::State &state) {
+    vector<SignedHash> hashes = SignHashes(100);
+
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const SignedHash &item = hashes[i++ % hashes.size()];
+        if (!item.pubKey.Verify(item.sigHash, item.signature))
+            return state.Fail("bad signature");
+    }
+}
+
+// the verification of signatures found in the signature cache, e.g. verified ahead of their block
+static void VerifySignatureCached(benchmark::State &state) {
+    vector<SignedHash> hashes = SignHashes(100);
+    for (const auto &item : hashes)
+        ::VerifySignature(item.sigHash, item.signature, item.pubKey);
+
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const SignedHash &item = hashes[i++ % hashes.size()];
+        if (!::VerifySignature(item.sigHash, item.signature, item.pubKey))
+            return state.Fail("bad signature");
+    }
+}
+
+// the insertion and lookup of a signature cache entry
+static void SignatureCacheSetGet(benchmark::State &state) {
+    vector<SignedHash> hashes = SignHashes(100);
+    CSignatureCache cache;
+
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const SignedHash &item = hashes[i++ % hashes.size()];
+        cache.Set(item.sigHash, item.signature, item.pubKey);
+        if (!cache.Get(item.sigHash, item.signature, item.pubKey))
+            return state.Fail("signature not cached");
+    }
+}
+
+BENCHMARK(VerifySignatureUncached);
+BENCHMARK(VerifySignatureCached);
+BENCHMARK(SignatureCacheSetGet);
@@ -53,15 +53,9 @@ static bool GenPendingDelegates(CBlock &block, CCacheWrapper &cw, PendingDelegat
     return true;
 }
 
-// process block delegates, call in the tail of block executing
-bool chain::ProcessBlockDelegates(CBlock &block, CCacheWrapper &cw, CValidationState &state) {
-    // required preparing the undo for cw
-
-    int32_t countVoteInterval; // the interval to count the vote
-    int32_t activateDelegateInterval; // the interval to count the vote
-
+static void GetDelegateIntervals(const int32_t height, int32_t &countVoteInterval, int32_t &activateDelegateInterval) {
     // TODO: move to sysconf
-    FeatureForkVersionEnum version = GetFeatureForkVersion(block.GetHeight());
+    FeatureForkVersionEnum version = GetFeatureForkVersion(height);
     if (version >= MAJOR_VER_R3) {
         countVoteInterval = 8;
         activateDelegateInterval = 24;
@@ -69,6 +63,16 @@ bool chain::ProcessBlockDelegates(CBlock &block, CCacheWrapper &cw, CValidationS
         countVoteInterval = 0;
         activateDelegateInterval = 0;
     }
+}
+
+// process block delegates, call in the tail of block executing
+bool chain::ProcessBlockDelegates(CBlock &block, CCacheWrapper &cw, CValidationState &state) {
+    // required preparing the undo for cw
+
+    int32_t countVoteInterval; // the interval to count the vote
+    int32_t activateDelegateInterval; // the interval to count the vote
+
+    GetDelegateIntervals(block.GetHeight(), countVoteInterval, activateDelegateInterval);
 
     PendingDelegates pendingDelegates;
     cw.delegateCache.GetPendingDelegates(pendingDelegates);
@@ -115,3 +119,33 @@ bool chain::ProcessBlockDelegates(CBlock &block, CCacheWrapper &cw, CValidationS
     }
     return true;
 }
+
+int32_t chain::GetActiveDelegatesLastHeight(int32_t tipHeight, CDelegateDBCache &delegateCache) {
+    int32_t countVoteInterval, activateDelegateInterval;
+    GetDelegateIntervals(tipHeight + 1, countVoteInterval, activateDelegateInterval);
+    // the delegates may change with every block until the intervals apply
+    if (countVoteInterval == 0 || activateDelegateInterval == 0)
+        return tipHeight + 1;
+
+    PendingDelegates pendingDelegates;
+    delegateCache.GetPendingDelegates(pendingDelegates);
+
+    int32_t lastHeight;
+    if (pendingDelegates.state == VoteDelegateState::PENDING) {
+        // activated by the first block at counted_vote_height + activateDelegateInterval
+        lastHeight = pendingDelegates.counted_vote_height + activateDelegateInterval;
+    } else if (pendingDelegates.state == VoteDelegateState::ACTIVATED) {
+        // counted at the next count vote slot height at the earliest, and activated after that
+        int32_t countHeight = (tipHeight / countVoteInterval + 1) * countVoteInterval;
+        lastHeight          = countHeight + activateDelegateInterval;
+    } else {
+        return tipHeight + 1;
+    }
+    lastHeight = max(lastHeight, tipHeight + 1);
+
+    // the intervals of another feature fork may apply before that
+    if (GetFeatureForkVersion(lastHeight) != GetFeatureForkVersion(tipHeight + 1))
+        return tipHeight + 1;
+
+    return lastHeight;
+}
@@ -13,6 +13,10 @@ namespace chain {
 
     // process block delegates, call in the tail of block executing
     bool ProcessBlockDelegates(CBlock &block, CCacheWrapper &cw, CValidationState &state);
+
+    // the last height of the blocks produced by the active delegates of the chain state at tipHeight,
+    // the votes counted by the blocks after the tip may activate other delegates from there on
+    int32_t GetActiveDelegatesLastHeight(int32_t tipHeight, CDelegateDBCache &delegateCache);
 };
 
 
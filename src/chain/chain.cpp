@@ -102,3 +102,103 @@ CBlockIndex* CChain::FindFork(map<uint256, CBlockIndex *> &mapBlockIndex, const
 
     return Genesis();
 }
+
+//////////////////////////////////////////////////////////////////////////////
+//class CHeadersChain implementation
+
+void CHeadersChain::EraseFrom(int32_t height) {
+    auto it = mapHashByHeight.lower_bound(height);
+    while (it != mapHashByHeight.end()) {
+        mapHeightByHash.erase(it->second);
+        setCheckedHashes.erase(it->second);
+        it = mapHashByHeight.erase(it);
+    }
+}
+
+void CHeadersChain::Clear() {
+    mapHashByHeight.clear();
+    mapHeightByHash.clear();
+    setCheckedHashes.clear();
+}
+
+bool CHeadersChain::Connect(const map<uint256, CBlockIndex *> &mapBlockIndex, const vector<CBlock> &vHeaders,
+                            const vector<bool> &vChecked) {
+    assert(vChecked.size() == vHeaders.size());
+    if (vHeaders.empty())
+        return true;
+
+    const uint256 prevHash = vHeaders.front().GetPrevBlockHash();
+    const int32_t height   = vHeaders.front().GetHeight();
+    auto itHeight          = mapHeightByHash.find(prevHash);
+    auto itIndex           = mapBlockIndex.find(prevHash);
+    bool fInChain          = itHeight != mapHeightByHash.end() && itHeight->second + 1 == height;
+    if (!fInChain && (itIndex == mapBlockIndex.end() || itIndex->second->height + 1 != height))
+        return false;
+
+    const int32_t lastHeight = height + (int32_t)vHeaders.size() - 1;
+    for (uint32_t i = 0; i < vHeaders.size(); i++) {
+        uint256 hash = vHeaders[i].GetHash();
+        auto it      = mapHashByHeight.find(height + i);
+        if (it != mapHashByHeight.end() && it->second == hash) {
+            fInChain = true;
+            if (vChecked[i])
+                setCheckedHashes.insert(hash);
+            continue;
+        }
+        if (!fInChain && mapBlockIndex.count(hash))
+            continue;
+
+        // A new branch starts here. It replaces the current one only if it reaches higher and its first
+        // header is signed by its delegate, so that a peer can not evict the headers of the others by
+        // making up a longer branch.
+        bool fReplace = fInChain ? it != mapHashByHeight.end() : !mapHashByHeight.empty();
+        if (fReplace && (lastHeight <= Height() || !vChecked[i]))
+            return true;
+
+        if (fInChain)
+            EraseFrom(height + i);
+        else
+            Clear();
+
+        for (; i < vHeaders.size(); i++) {
+            hash = vHeaders[i].GetHash();
+            mapHashByHeight[height + i] = hash;
+            mapHeightByHash[hash]       = height + i;
+            if (vChecked[i])
+                setCheckedHashes.insert(hash);
+        }
+        break;
+    }
+
+    return true;
+}
+
+void CHeadersChain::Prune(const CChain &chain) {
+    bool fForked = false;
+    auto it      = mapHashByHeight.begin();
+    while (it != mapHashByHeight.end() && it->first <= chain.Height()) {
+        if (chain[it->first]->GetBlockHash() != it->second)
+            fForked = true;
+
+        mapHeightByHash.erase(it->second);
+        setCheckedHashes.erase(it->second);
+        it = mapHashByHeight.erase(it);
+    }
+
+    // The rest no longer extends the active chain, it is rebuilt from the next "headers" reply
+    if (fForked)
+        Clear();
+}
+
+uint256 CHeadersChain::operator[](int32_t height) const {
+    auto it = mapHashByHeight.find(height);
+    return it != mapHashByHeight.end() ? it->second : uint256();
+}
+
+CBlockLocator CHeadersChain::GetLocator(const CChain &chain) const {
+    CBlockLocator locator = chain.GetLocator();
+    if (!mapHashByHeight.empty())
+        locator.vHave.insert(locator.vHave.begin(), mapHashByHeight.rbegin()->second);
+
+    return locator;
+}
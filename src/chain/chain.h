@@ -9,6 +9,8 @@
 
 #include "persistence/block.h"
 
+#include <set>
+
 /** An in-memory indexed chain of blocks. */
 class CChain {
 private:
@@ -52,5 +54,45 @@ public:
 
 }; //end of CChain
 
+/** The best chain of block headers announced by peers beyond the blocks we have. Blocks along it are
+ *  downloaded from many peers at once and connected in order as their parents arrive. Headers are
+ *  checked for linkage, and against the delegate signature while the delegates producing them are
+ *  known, the blocks are fully validated once received. Protected by cs_main. */
+class CHeadersChain {
+private:
+    map<int32_t, uint256> mapHashByHeight;
+    map<uint256, int32_t> mapHeightByHash;
+    set<uint256> setCheckedHashes;  // the headers whose delegate signature was verified
+
+    void EraseFrom(int32_t height);
+    void Clear();
+
+public:
+    /** Connect linked headers to a block we have or to this chain. vChecked flags the headers whose
+     *  delegate signature was verified. A new branch replaces the current one only if it reaches higher
+     *  and its first header was checked, any peer can make up unchecked headers.
+     *  Returns false if the first header does not connect. */
+    bool Connect(const map<uint256, CBlockIndex *> &mapBlockIndex, const vector<CBlock> &vHeaders,
+                 const vector<bool> &vChecked);
+
+    /** Drop the headers at or below the tip of the given chain, whose blocks have been connected. */
+    void Prune(const CChain &chain);
+
+    /** Efficiently check whether a header is present in this chain. */
+    bool Contains(const uint256 &hash) const { return mapHeightByHash.count(hash) > 0; }
+
+    /** Check whether the delegate signature of a header in this chain was verified. */
+    bool IsChecked(const uint256 &hash) const { return setCheckedHashes.count(hash) > 0; }
+
+    /** Returns the header hash at a particular height in this chain, or a null hash if there is none. */
+    uint256 operator[](int32_t height) const;
+
+    /** Return the height of the best header, or -1 if this chain is empty. */
+    int32_t Height() const { return mapHashByHeight.empty() ? -1 : mapHashByHeight.rbegin()->first; }
+
+    /** Return a CBlockLocator that starts from the best header and continues along the given chain. */
+    CBlockLocator GetLocator(const CChain &chain) const;
+};
+
 
 #endif //CHAIN_CHAIN_H
\ No newline at end of file
@@ -5,24 +5,24 @@
 
 #include "merkletree.h"
 
+#include "crypto/sha256.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 // class CPartialMerkleTree
 
 uint256 CPartialMerkleTree::CalcHash(int32_t height, uint32_t pos, const vector<uint256> &vTxid) {
-    if (height == 0) {
-        // hash at height 0 is the txids themself
-        return vTxid[pos];
-    } else {
-        // calculate left hash
-        uint256 left = CalcHash(height - 1, pos * 2, vTxid), right;
-        // calculate right hash if not beyond the end of the array - copy left hash otherwise1
-        if (pos * 2 + 1 < CalcTreeWidth(height - 1))
-            right = CalcHash(height - 1, pos * 2 + 1, vTxid);
-        else
-            right = left;
-        // combine subhashes
-        return Hash(BEGIN(left), END(left), BEGIN(right), END(right));
+    // hash the subtree of the node level by level from the txids, the pairs of a level are contiguous
+    // 64-byte blobs hashed in place in multi-lane batches by SHA256D64()
+    vector<uint256> vLevel(vTxid.begin() + (pos << height),
+                           vTxid.begin() + min((pos + 1) << height, nTransactions));
+    for (int32_t h = 0; h < height; h++) {
+        // a node without a right sibling is paired with itself
+        if (vLevel.size() & 1)
+            vLevel.push_back(vLevel.back());
+        SHA256D64(vLevel[0].begin(), vLevel[0].begin(), vLevel.size() / 2);
+        vLevel.resize(vLevel.size() / 2);
     }
+    return vLevel[0];
 }
 
 void CPartialMerkleTree::TraverseAndBuild(int32_t height, uint32_t pos, const vector<uint256> &vTxid, const vector<bool> &vMatch) {
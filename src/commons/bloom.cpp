@@ -11,11 +11,12 @@
 #define LN2SQUARED 0.4804530139182014246671025263266649717305529515945455
 #define LN2 0.6931471805599453094172321214581765680755001343602552
 
-CBloomFilter::CBloomFilter(uint32_t nElements, double nFPRate, uint32_t nTweakIn, uint8_t nFlagsIn)
+CBloomFilter::CBloomFilter(uint32_t nElements, double nFPRate, uint32_t nTweakIn, uint8_t nFlagsIn,
+                           uint32_t nMaxSize)
     :  // The ideal size for a bloom filter with a given number of elements and false positive rate is:
        // - nElements * log(fp rate) / ln(2)^2
        // We ignore filter parameters which will create a bloom filter larger than the protocol limits
-      vData(min((uint32_t)(-1 / LN2SQUARED * nElements * log(nFPRate)), MAX_BLOOM_FILTER_SIZE * 8) / 8),
+      vData(min((uint32_t)(-1 / LN2SQUARED * nElements * log(nFPRate)), nMaxSize * 8) / 8),
       // The ideal number of hash functions is filter size * ln(2) / number of elements
       // Again, we ignore filter parameters which will create a bloom filter with more hash functions than the protocol
       // limits See http://en.wikipedia.org/wiki/Bloom_filter for an explanation of these formulas
@@ -25,16 +26,20 @@ CBloomFilter::CBloomFilter(uint32_t nElements, double nFPRate, uint32_t nTweakIn
       nTweak(nTweakIn),
       nFlags(nFlagsIn) {}
 
-inline uint32_t CBloomFilter::Hash(uint32_t nHashNum, const vector<uint8_t>& vDataToHash) const {
+inline uint32_t CBloomFilter::Hash(uint32_t nHashNum, const uint8_t* pDataToHash, size_t nDataSize) const {
     // 0xFBA4C795 chosen as it guarantees a reasonable bit difference between nHashNum values.
-    return MurmurHash3(nHashNum * 0xFBA4C795 + nTweak, vDataToHash) % (vData.size() * 8);
+    return MurmurHash3(nHashNum * 0xFBA4C795 + nTweak, pDataToHash, nDataSize) % (vData.size() * 8);
 }
 
 void CBloomFilter::insert(const vector<uint8_t>& vKey) {
+    insert(vKey.data(), vKey.size());
+}
+
+void CBloomFilter::insert(const uint8_t* pKey, size_t nKeySize) {
     if (isFull)
         return;
     for (uint32_t i = 0; i < nHashFuncs; i++) {
-        uint32_t index = Hash(i, vKey);
+        uint32_t index = Hash(i, pKey, nKeySize);
         // Sets bit index of vData
         vData[index >> 3] |= (1 << (7 & index));
     }
@@ -47,12 +52,16 @@ void CBloomFilter::insert(const uint256& hash) {
 }
 
 bool CBloomFilter::contains(const vector<uint8_t>& vKey) const {
+    return contains(vKey.data(), vKey.size());
+}
+
+bool CBloomFilter::contains(const uint8_t* pKey, size_t nKeySize) const {
     if (isFull)
         return true;
     if (isEmpty)
         return false;
     for (uint32_t i = 0; i < nHashFuncs; i++) {
-        uint32_t index = Hash(i, vKey);
+        uint32_t index = Hash(i, pKey, nKeySize);
         // Checks bit index of vData
         if (!(vData[index >> 3] & (1 << (7 & index))))
             return false;
@@ -51,7 +51,7 @@ private:
     uint32_t nTweak;
     uint8_t nFlags;
 
-    uint32_t Hash(uint32_t nHashNum, const vector<uint8_t>& vDataToHash) const;
+    uint32_t Hash(uint32_t nHashNum, const uint8_t* pDataToHash, size_t nDataSize) const;
 
 public:
     // Creates a new bloom filter which will provide the given fp rate when filled with the given number of elements
@@ -61,16 +61,21 @@ public:
     // nTweak is a constant which is added to the seed value passed to the hash function
     // It should generally always be a random value (and is largely only exposed for unit testing)
     // nFlags should be one of the BLOOM_UPDATE_* enums (not _MASK)
-    CBloomFilter(uint32_t nElements, double nFPRate, uint32_t nTweak, uint8_t nFlagsIn);
+    // nMaxSize is the size limit in bytes, a filter which is never relayed may use a larger limit
+    CBloomFilter(uint32_t nElements, double nFPRate, uint32_t nTweak, uint8_t nFlagsIn,
+                 uint32_t nMaxSize = MAX_BLOOM_FILTER_SIZE);
     CBloomFilter() : isFull(true) {}
 
     IMPLEMENT_SERIALIZE(READWRITE(vData); READWRITE(nHashFuncs); READWRITE(nTweak); READWRITE(nFlags);)
 
     void insert(const vector<uint8_t>& vKey);
+    // insert the key without copying it into a vector, e.g. a db key
+    void insert(const uint8_t* pKey, size_t nKeySize);
 
     void insert(const uint256& hash);
 
     bool contains(const vector<uint8_t>& vKey) const;
+    bool contains(const uint8_t* pKey, size_t nKeySize) const;
     bool contains(const uint256& hash) const;
 
     // True if the size is <= MAX_BLOOM_FILTER_SIZE and the number of hash functions is <= MAX_HASH_FUNCS
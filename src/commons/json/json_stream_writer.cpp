@@ -0,0 +1,185 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "json_stream_writer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <cwctype>
+
+static const char kHexChars[] = "0123456789ABCDEF";
+
+CJsonWriter &CJsonWriter::BeginObject() {
+    Separate();
+    out += '{';
+    ++depth;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::EndObject() {
+    assert(depth > 0);
+    out += '}';
+    --depth;
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::BeginArray() {
+    Separate();
+    out += '[';
+    ++depth;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::EndArray() {
+    assert(depth > 0);
+    out += ']';
+    --depth;
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Key(const char *key) {
+    Separate();
+    WriteString(key, strlen(key));
+    out += ':';
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Key(const std::string &key) {
+    Separate();
+    WriteString(key.data(), key.size());
+    out += ':';
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Null() {
+    Separate();
+    out.append("null", 4);
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(const char *value) {
+    Separate();
+    WriteString(value, strlen(value));
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(const std::string &value) {
+    Separate();
+    WriteString(value.data(), value.size());
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(bool value) {
+    Separate();
+    if (value)
+        out.append("true", 4);
+    else
+        out.append("false", 5);
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(int32_t value) { return Write((int64_t)value); }
+
+CJsonWriter &CJsonWriter::Write(int64_t value) {
+    Separate();
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%" PRId64, value);
+    out.append(buf, len);
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(uint32_t value) { return Write((uint64_t)value); }
+
+CJsonWriter &CJsonWriter::Write(uint64_t value) {
+    Separate();
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%" PRIu64, value);
+    out.append(buf, len);
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(double value) {
+    Separate();
+    // same as the json_spirit generator: std::showpoint << std::fixed << std::setprecision(8)
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf), "%.8f", value);
+    out.append(buf, std::min<size_t>(len, sizeof(buf) - 1));
+    needComma = true;
+    return *this;
+}
+
+CJsonWriter &CJsonWriter::Write(const json_spirit::Value &value) {
+    switch (value.type()) {
+        case json_spirit::obj_type: {
+            BeginObject();
+            for (const auto &item : value.get_obj()) {
+                Key(item.name_);
+                Write(item.value_);
+            }
+            return EndObject();
+        }
+        case json_spirit::array_type: {
+            BeginArray();
+            for (const auto &item : value.get_array())
+                Write(item);
+            return EndArray();
+        }
+        case json_spirit::str_type:  return Write(value.get_str());
+        case json_spirit::bool_type: return Write(value.get_bool());
+        case json_spirit::int_type:
+            return value.is_uint64() ? Write(value.get_uint64()) : Write(value.get_int64());
+        case json_spirit::real_type: return Write(value.get_real());
+        case json_spirit::null_type: return Null();
+        default: assert(false);
+    }
+    return *this;
+}
+
+void CJsonWriter::WriteString(const char *str, size_t len) {
+    // escapes exactly as json_spirit::add_esc_chars() does
+    out += '"';
+    const char *end = str + len;
+    const char *plain = str;  // start of the pending run of chars that need no escaping
+    for (const char *p = str; p != end; ++p) {
+        const char c = *p;
+        const char *esc = nullptr;
+        switch (c) {
+            case '"':  esc = "\\\""; break;
+            case '\\': esc = "\\\\"; break;
+            case '\b': esc = "\\b";  break;
+            case '\f': esc = "\\f";  break;
+            case '\n': esc = "\\n";  break;
+            case '\r': esc = "\\r";  break;
+            case '\t': esc = "\\t";  break;
+            default: {
+                const wint_t unsignedChar = (c >= 0) ? c : 256 + c;
+                if (iswprint(unsignedChar))
+                    continue;
+            }
+        }
+
+        out.append(plain, p - plain);
+        plain = p + 1;
+        if (esc != nullptr) {
+            out.append(esc, 2);
+        } else {
+            const uint32_t unsignedChar = (uint8_t)c;
+            const char hex[6] = {'\\', 'u', '0', '0', kHexChars[(unsignedChar >> 4) & 0xF],
+                                 kHexChars[unsignedChar & 0xF]};
+            out.append(hex, 6);
+        }
+    }
+    out.append(plain, end - plain);
+    out += '"';
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef JSON_STREAM_WRITER_H
+#define JSON_STREAM_WRITER_H
+
+#include "json_spirit_value.h"
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * Streaming JSON writer.
+ *
+ * Appends compact JSON text straight into a caller-owned string buffer, without building a
+ * json_spirit value tree first. The output is byte-for-byte identical to
+ * json_spirit::write_string(value, false) of the equivalent tree, so RPC handlers can switch
+ * between the two paths transparently.
+ *
+ * Keys and values must be written in a valid order (a Key() before every value of an object);
+ * commas and colons are inserted automatically.
+ */
+class CJsonWriter {
+public:
+    explicit CJsonWriter(std::string &outIn) : out(outIn) {}
+
+    CJsonWriter &BeginObject();
+    CJsonWriter &EndObject();
+    CJsonWriter &BeginArray();
+    CJsonWriter &EndArray();
+
+    CJsonWriter &Key(const char *key);
+    CJsonWriter &Key(const std::string &key);
+
+    CJsonWriter &Null();
+    CJsonWriter &Write(const char *value);
+    CJsonWriter &Write(const std::string &value);
+    CJsonWriter &Write(bool value);
+    CJsonWriter &Write(int32_t value);
+    CJsonWriter &Write(int64_t value);
+    CJsonWriter &Write(uint32_t value);
+    CJsonWriter &Write(uint64_t value);
+    CJsonWriter &Write(double value);
+    // write an existing value tree, e.g. a fragment produced by a ToJson() helper
+    CJsonWriter &Write(const json_spirit::Value &value);
+
+    template <typename T>
+    CJsonWriter &Pair(const char *key, const T &value) {
+        Key(key);
+        return Write(value);
+    }
+
+    std::string &GetBuffer() { return out; }
+    uint32_t GetDepth() const { return depth; }
+
+private:
+    void Separate() {
+        if (needComma)
+            out += ',';
+        needComma = false;
+    }
+    void WriteString(const char *str, size_t len);
+
+private:
+    std::string &out;
+    bool needComma = false;
+    uint32_t depth = 0;
+};
+
+#endif  // JSON_STREAM_WRITER_H
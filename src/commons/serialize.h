@@ -1256,6 +1256,60 @@ public:
     }
 };
 
+/**
+ * Read-only stream over a buffer it does not own, e.g. a leveldb::Slice, so that the bytes are
+ * unserialized in place instead of being copied into a CDataStream first.
+ * The buffer must outlive the stream.
+ */
+class CReadOnlyDataStream
+{
+private:
+    const char* pbegin;
+    const char* pend;
+
+public:
+    int nType;
+    int nVersion;
+
+    CReadOnlyDataStream(const char* pbeginIn, const char* pendIn, int nTypeIn, int nVersionIn)
+        : pbegin(pbeginIn), pend(pendIn), nType(nTypeIn), nVersion(nVersionIn) {
+        assert(pbegin <= pend);
+    }
+
+    size_t size() const          { return pend - pbegin; }
+    bool empty() const           { return pbegin == pend; }
+    bool eof() const             { return empty(); }
+    int GetType()                { return nType; }
+    int GetVersion()             { return nVersion; }
+
+    CReadOnlyDataStream& read(char* pch, int nSize)
+    {
+        assert(nSize >= 0);
+        if ((size_t)nSize > size())
+            throw ios_base::failure("CReadOnlyDataStream::read() : end of data");
+        memcpy(pch, pbegin, nSize);
+        pbegin += nSize;
+        return (*this);
+    }
+
+    CReadOnlyDataStream& ignore(int nSize)
+    {
+        assert(nSize >= 0);
+        if ((size_t)nSize > size())
+            throw ios_base::failure("CReadOnlyDataStream::ignore() : end of data");
+        pbegin += nSize;
+        return (*this);
+    }
+
+    template<typename T>
+    CReadOnlyDataStream& operator>>(T& obj)
+    {
+        // Unserialize from this stream
+        ::Unserialize(*this, obj, nType, nVersion);
+        return (*this);
+    }
+};
+
 
 
 /** RAII wrapper for FILE*.
@@ -435,6 +435,7 @@ CBaseParams::CBaseParams() {
     nTxCacheHeight          = 500;
     nTimeBestReceived       = 0;
     nCacheSize              = 300 << 10;  // 300K bytes
+    nIbdCacheSize           = DEFAULT_IBD_DB_CACHE << 20;
     nDefaultPort            = 0;
     fServer                 = 0;
     fServer                 = 0;
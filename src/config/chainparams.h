@@ -69,6 +69,7 @@ protected:
     mutable bool fGenReceipt;
     mutable int64_t nTimeBestReceived;
     mutable uint32_t nCacheSize;
+    mutable uint64_t nIbdCacheSize;
     mutable int32_t nTxCacheHeight;
     mutable int32_t nMaxForkTime;  // to limit the maximum fork time in seconds.
 
@@ -79,6 +80,7 @@ public:
         fServer = GetBoolArg("-rpcserver", false);
         fDebug = !m_mapMultiArgs["-debug"].empty();
         nMaxForkTime = GetArg("-maxforktime", 24 * 60 * 60);
+        nIbdCacheSize = std::min(std::max(GetArg("-ibddbcache", DEFAULT_IBD_DB_CACHE), MIN_DB_CACHE), MAX_DB_CACHE) << 20;
 
         return true;
     }
@@ -105,6 +107,7 @@ public:
         te += strprintf("nBlockIntervalPreStableCoinRelease:%u\n",  nBlockIntervalPreStableCoinRelease);
         te += strprintf("nBlockIntervalStableCoinRelease:%u\n",     nBlockIntervalStableCoinRelease);
         te += strprintf("nCacheSize:%u\n",                          nCacheSize);
+        te += strprintf("nIbdCacheSize:%llu\n",                     nIbdCacheSize);
         te += strprintf("nTxCacheHeight:%u\n",                      nTxCacheHeight);
         te += strprintf("nMaxForkTime:%d\n",                        nMaxForkTime);
 
@@ -157,6 +160,7 @@ public:
     bool IsGenReceipt() const { return fGenReceipt; };
     int64_t GetBestRecvTime() const { return nTimeBestReceived; }
     uint32_t GetCacheSize() const { return nCacheSize; }
+    uint64_t GetIbdCacheSize() const { return nIbdCacheSize; }
     int32_t GetTxCacheHeight() const { return nTxCacheHeight; }
     void SetImporting(bool flag) const { fImporting = flag; }
     void SetReIndex(bool flag) const { fReindex = flag; }
@@ -107,12 +107,44 @@ static const uint32_t DEFAULT_BLOCK_MAX_SIZE = 3750000;
 /** The maximum size for transactions we're willing to relay/mine */
 static const uint32_t MAX_STANDARD_TX_SIZE = 100000;
 
+/** Maximum number of signature check threads allowed */
+static const int32_t MAX_SCRIPTCHECK_THREADS = 32;
+/** -par default (number of signature check threads, 0 = auto) */
+static const int32_t DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Number of signature checks handed to a worker thread at once */
+static const uint32_t SCRIPTCHECK_BATCH_SIZE = 128;
+/** Maximum number of txs received from the network validated per batch by the tx validation thread */
+static const uint32_t TX_VALIDATION_BATCH_SIZE = 128;
+/** Maximum number of txs of a single peer waiting for validation, more are dropped */
+static const uint32_t MAX_PEER_TX_VALIDATION_QUEUE = 5000;
+/** Maximum number of txs of all peers waiting for validation, the peer with the most queued txs loses its newest */
+static const uint32_t MAX_TX_VALIDATION_QUEUE = 20000;
+
+/** Maximum number of missing keys remembered per db level cache to avoid repeated db misses */
+static const uint32_t MAX_DB_MISSING_KEYS = 100000;
+/** -dbbloomfilter default (build bloom filters of db keys at startup) */
+static const bool DEFAULT_DB_BLOOM_FILTER = false;
+/** The maximum size of the bloom filter of db keys, in bytes */
+static const uint32_t MAX_DB_BLOOM_FILTER_SIZE = 0x1000000;  // 16 MiB
+/** The false positive rate of the bloom filter of db keys */
+static const double DB_BLOOM_FILTER_FP_RATE = 0.01;
+/** The minimum number of elements the bloom filter of db keys is sized for */
+static const uint32_t DB_BLOOM_FILTER_MIN_ELEMENTS = 10000;
+
 /** The maximum number of orphan blocks kept in memory */
 static const uint32_t MAX_ORPHAN_BLOCKS = 750;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int32_t MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
 /** Timeout in seconds before considering a block download peer unresponsive. */
 static const uint32_t BLOCK_DOWNLOAD_TIMEOUT  = 60;
+/** Number of blocks ahead of the tip downloaded in parallel during headers-first sync, kept below MAX_ORPHAN_BLOCKS */
+static const int32_t BLOCK_DOWNLOAD_WINDOW = 512;
+/** Timeout in seconds before disconnecting a peer that holds back the download window. */
+static const uint32_t BLOCK_STALLING_TIMEOUT = 5;
+/** The maximum number of headers in a "headers" message */
+static const uint32_t MAX_HEADERS_RESULTS = 2000;
+/** The maximum size of the serialized recent blocks kept to answer getdata, in bytes */
+static const uint64_t MAX_BLOCK_MESSAGE_CACHE_SIZE = 0x4000000;  // 64 MiB
 
 /** Minimum disk space required */
 static const uint64_t MIN_DISK_SPACE = 52428800;
@@ -128,6 +160,16 @@ static const int64_t DEFAULT_DB_CACHE = 100;
 static const int64_t MAX_DB_CACHE = sizeof(void *) > 4 ? 4096 : 1024;
 /** min. -dbcache in (MiB) */
 static const int64_t MIN_DB_CACHE = 4;
+/** -ibddbcache default (MiB), the chain state changes held in memory between two flushes during initial block download */
+static const int64_t DEFAULT_IBD_DB_CACHE = 256;
+/** Maximum seconds between two flushes of the chain state during initial block download */
+static const int64_t IBD_DB_FLUSH_INTERVAL = 300;
+/** Minimum seconds between two snapshots of the transaction and price point memory caches */
+static const int64_t MEMCACHE_SNAPSHOT_INTERVAL = 600;
+/** Maximum number of threads reading blocks when the memory caches are rebuilt from the block files */
+static const int32_t MAX_BLOCK_READ_THREADS = 8;
+/** Maximum number of blocks read and deserialized ahead of their connection during reindex, import and catch-up */
+static const int32_t MAX_BLOCKS_CONNECT_AHEAD = 32;
 
 /** Coinbase transaction outputs can only be spent after this number of new blocks (network rule) */
 static const int32_t BLOCK_REWARD_MATURITY = 100;
@@ -139,6 +181,7 @@ static const int32_t NICK_ID_MATURITY = 100;
 static const uint16_t MAX_MINED_BLOCK_COUNT      = 100;        // maximun cache size for mined blocks
 static const int32_t MAX_RECENT_BLOCK_COUNT      = 10000;      // most recent block number limit
 static const uint32_t MAX_RPC_SIG_STR_LEN        = 65 * 1024;  // 65K max length of raw string to be signed via rpc call
+static const uint32_t MAX_SUBMIT_TX_BATCH_SIZE   = 1000;       // max number of raw txs submitted by one submittxbatch call
 static const uint32_t MAX_SIGNATURE_SIZE         = 100;        // 100 bytes max size of tx or block signature
 static const uint32_t MAX_CONTRACT_CODE_SIZE     = 65536;      // 64 KB max for contract script size
 static const uint32_t MAX_CONTRACT_ARGUMENT_SIZE = 4096;       // 4 KB max for contract argument size
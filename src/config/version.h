@@ -28,7 +28,7 @@ extern const std::string CLIENT_DATE;
 // network protocol versioning
 //
 
-static const int PROTOCOL_VERSION = 10001;
+static const int PROTOCOL_VERSION = 10002;
 
 // initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 10001;
@@ -36,6 +36,10 @@ static const int INIT_PROTO_VERSION = 10001;
 // disconnect from peers older than this proto version
 static const int MIN_PEER_PROTO_VERSION = 10001;
 
+// "headers" replies carry the full block header, so the chain can be synced headers-first,
+// starting with this version
+static const int HEADERS_FIRST_VERSION = 10002;
+
 // nTime field added to CAddress, starting with this version;
 // if possible, avoid requesting addresses nodes older than this
 //static const int CADDR_TIME_VERSION = 31402;
@@ -8,16 +8,20 @@
 inline uint32_t ROTL32(uint32_t x, int8_t r) { return (x << r) | (x >> (32 - r)); }
 
 uint32_t MurmurHash3(uint32_t nHashSeed, const vector<uint8_t> &vDataToHash) {
+    return MurmurHash3(nHashSeed, vDataToHash.data(), vDataToHash.size());
+}
+
+uint32_t MurmurHash3(uint32_t nHashSeed, const uint8_t *pDataToHash, size_t nDataSize) {
     // The following is MurmurHash3 (x86_32), see http://code.google.com/p/smhasher/source/browse/trunk/MurmurHash3.cpp
     uint32_t h1       = nHashSeed;
     const uint32_t c1 = 0xcc9e2d51;
     const uint32_t c2 = 0x1b873593;
 
-    const int32_t nblocks = vDataToHash.size() / 4;
+    const int32_t nblocks = nDataSize / 4;
 
     //----------
     // body
-    const uint32_t *blocks = (const uint32_t *)(&vDataToHash[0] + nblocks * 4);
+    const uint32_t *blocks = (const uint32_t *)(pDataToHash + nblocks * 4);
 
     for (int32_t i = -nblocks; i; i++) {
         uint32_t k1 = blocks[i];
@@ -33,11 +37,11 @@ uint32_t MurmurHash3(uint32_t nHashSeed, const vector<uint8_t> &vDataToHash) {
 
     //----------
     // tail
-    const uint8_t *tail = (const uint8_t *)(&vDataToHash[0] + nblocks * 4);
+    const uint8_t *tail = (const uint8_t *)(pDataToHash + nblocks * 4);
 
     uint32_t k1 = 0;
 
-    switch (vDataToHash.size() & 3) {
+    switch (nDataSize & 3) {
         case 3:
             k1 ^= tail[2] << 16;  // Falls through
         case 2:
@@ -52,7 +56,7 @@ uint32_t MurmurHash3(uint32_t nHashSeed, const vector<uint8_t> &vDataToHash) {
 
     //----------
     // finalization
-    h1 ^= vDataToHash.size();
+    h1 ^= nDataSize;
     h1 ^= h1 >> 16;
     h1 *= 0x85ebca6b;
     h1 ^= h1 >> 13;
@@ -141,6 +141,7 @@ inline uint160 Hash160(std::string str) {
 // }
 
 uint32_t MurmurHash3(uint32_t nHashSeed, const vector<uint8_t> &vDataToHash);
+uint32_t MurmurHash3(uint32_t nHashSeed, const uint8_t *pDataToHash, size_t nDataSize);
 
 typedef struct {
     SHA512_CTX ctxInner;
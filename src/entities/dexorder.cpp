@@ -72,6 +72,32 @@ namespace dex {
         obj.push_back(Pair("total_deal_asset_amount",   total_deal_asset_amount));
     }
 
+    void CDEXOrderDetail::ToJson(CJsonWriter &writer) const {
+        writer.Pair("generate_type",                GetOrderGenTypeName(generate_type));
+        writer.Pair("order_type",                   kOrderTypeHelper.GetName(order_type));
+        writer.Pair("order_side",                   kOrderSideHelper.GetName(order_side));
+        writer.Pair("coin_symbol",                  coin_symbol);
+        writer.Pair("asset_symbol",                 asset_symbol);
+        writer.Pair("coin_amount",                  coin_amount);
+        writer.Pair("asset_amount",                 asset_amount);
+        writer.Pair("price",                        price);
+        writer.Pair("dex_id",                       (int64_t)dex_id);
+        writer.Pair("public_mode",                  dex::kPublicModeHelper.GetName(public_mode));
+        writer.Pair("has_operator_config",          opt_operator_fee_ratios.has_value());
+        if (opt_operator_fee_ratios) {
+            writer.Key("operator_config").BeginObject();
+            writer.Key("fee_ratios").BeginObject();
+            writer.Pair("taker_fee_ratio",          opt_operator_fee_ratios.value().taker_fee_ratio);
+            writer.Pair("maker_fee_ratio",          opt_operator_fee_ratios.value().maker_fee_ratio);
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.Pair("tx_cord",                      tx_cord.ToString());
+        writer.Pair("user_regid",                   user_regid.ToString());
+        writer.Pair("total_deal_coin_amount",       total_deal_coin_amount);
+        writer.Pair("total_deal_asset_amount",      total_deal_asset_amount);
+    }
+
 
     ///////////////////////////////////////////////////////////////////////////////
     // class CSysOrder
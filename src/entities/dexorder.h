@@ -13,6 +13,7 @@
 #include "asset.h"
 #include "commons/util/enumhelper.hpp"
 #include "commons/json/json_spirit.h"
+#include "commons/json/json_stream_writer.h"
 
 typedef uint32_t DexID;
 
@@ -145,6 +146,8 @@ namespace dex {
 
         string ToString() const;
         void ToJson(json_spirit::Object &obj) const;
+        // write the same fields as ToJson(obj) into the opened object of writer
+        void ToJson(CJsonWriter &writer) const;
     };
 
 
@@ -12,6 +12,7 @@
 #include "init.h"
 #include "config/configuration.h"
 #include "p2p/addrman.h"
+#include "p2p/txvalidationqueue.h"
 
 #include "rpc/core/rpcserver.h"
 #include "vm/luavm/lua/lua.h"
@@ -27,6 +28,8 @@
 #include "tx/tx.h"
 #include "commons/util/util.h"
 #include "commons/util/time.h"
+#include "crypto/sha256.h"
+#include "vm/wasm/wasm_interface.hpp"
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -68,8 +71,6 @@ CWallet *pWalletMain;
 
 static std::unique_ptr<ECCVerifyHandle> globalVerifyHandle;
 
-extern void wasm_code_cache_free();
-
 #ifdef WIN32
 // Win32 LevelDB doesn't use filedescriptors, and the ones used for
 // accessing block files, don't count towards to fd_set size limit
@@ -86,6 +87,64 @@ enum BindFlags {
     BF_REPORT_ERROR = (1U << 1)
 };
 
+static boost::filesystem::path GetWasmCodeCachePath() { return GetDataDir() / "wasmcache.dat"; }
+
+// Instantiate the wasm modules cached at last shutdown so that the hot contracts are not parsed on their first call
+static uint32_t LoadWasmCodeCache() {
+    FILE *file       = fopen(GetWasmCodeCachePath().string().c_str(), "rb");
+    CAutoFile filein = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return 0;
+
+    vector<vector<uint8_t>> codes;
+    try {
+        filein >> codes;
+    } catch (std::exception &e) {
+        LogPrint(BCLog::ERROR, "%s : Deserialize or I/O error - %s\n", __func__, e.what());
+        return 0;
+    }
+    filein.fclose();
+
+    wasm::wasm_interface wasmif;
+    // the same runtime as wasm_context uses
+    wasmif.initialize(wasm::vm_type::eos_vm_jit);
+
+    uint32_t count = 0;
+    // the codes are saved most recently used first
+    for (auto it = codes.rbegin(); it != codes.rend(); ++it) {
+        try {
+            wasmif.preload(*it);
+            count++;
+        } catch (...) {
+            LogPrint(BCLog::ERROR, "%s : Failed to instantiate cached wasm code\n", __func__);
+        }
+    }
+    return count;
+}
+
+static bool SaveWasmCodeCache() {
+    vector<vector<uint8_t>> codes = wasm::get_wasm_cached_codes();
+
+    boost::filesystem::path pathTmp = GetDataDir() / "wasmcache.dat.new";
+    FILE *file                      = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout               = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!fileout)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << codes;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout);
+    fileout.fclose();
+
+    if (!RenameOver(pathTmp, GetWasmCodeCachePath()))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Shutdown
@@ -152,6 +211,7 @@ void Shutdown() {
 
         if (pCdMan != nullptr) {
             pCdMan->Flush();
+            WriteMemCacheSnapshot();
             delete pCdMan;
             pCdMan = nullptr;
         }
@@ -166,9 +226,17 @@ void Shutdown() {
     globalVerifyHandle.reset();
     ECC_Stop();
 
+    if (SysCfg().GetBoolArg("-persistwasmcache", false))
+        SaveWasmCodeCache();
+
+    wasm::wasm_code_cache_stats wasmCacheStats = wasm::get_wasm_code_cache_stats();
+    LogPrint(BCLog::INFO, "wasm module cache: %u modules, %u bytes, %u hits, %u misses, %u evictions\n",
+             wasmCacheStats.count, wasmCacheStats.memory_size, wasmCacheStats.hits, wasmCacheStats.misses,
+             wasmCacheStats.evictions);
     wasm_code_cache_free();
 
     LogPrint(BCLog::INFO, "Shutdown() : done\n");
+    LogInstance().StopLogging();
 }
 
 //
@@ -213,7 +281,12 @@ string HelpMessage() {
 #endif
     strUsage += "  -datadir=<dir>         " + _("Specify data directory") + "\n";
     strUsage += "  -dbcache=<n>           " + strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), MIN_DB_CACHE, MAX_DB_CACHE, DEFAULT_DB_CACHE) + "\n";
+    strUsage += "  -ibddbcache=<n>        " + strprintf(_("Hold up to <n> megabytes of chain state changes in memory during initial block download and reindex, flushed without sync writes (%d to %d, default: %d)"), MIN_DB_CACHE, MAX_DB_CACHE, DEFAULT_IBD_DB_CACHE) + "\n";
+    strUsage += "  -dbbloomfilter         " + strprintf(_("Build bloom filters of account and order keys at startup to avoid db lookups for non-existent keys (default: %u)"), DEFAULT_DB_BLOOM_FILTER) + "\n";
     strUsage += "  -loadblock=<file>      " + _("Imports blocks from external blk000??.dat file") + " " + _("on startup") + "\n";
+    strUsage += "  -wasmcachesize=<n>     " + strprintf(_("Set the memory bound of the instantiated wasm module cache in megabytes (default: %u)"), wasm::default_wasm_code_cache_size >> 20) + "\n";
+    strUsage += "  -persistwasmcache      " + _("Save the codes of the cached wasm modules at shutdown and instantiate them at startup (default: 0)") + "\n";
+    strUsage += "  -par=<n>               " + strprintf(_("Set the number of signature verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"), -(int32_t)boost::thread::hardware_concurrency(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS) + "\n";
     strUsage += "  -pid=<file>            " + _("Specify pid file (default: coin.pid)") + "\n";
     strUsage += "  -reindex               " + _("Rebuild block chain index from current blk000??.dat files") + " " + _("on startup") + "\n";
     strUsage += "  -txindex               " + _("Maintain a full transaction index (default: 0)") + "\n";
@@ -282,6 +355,8 @@ string HelpMessage() {
     strUsage += " addrman, alert, coindb, db, lock, rand, rpc, selectcoins, mempool, net";
     strUsage += "  -help-debug            " + _("Show all debugging options (usage: --help -help-debug)") + "\n";
     strUsage += "  -logtimestamps         " + _("Prepend debug output with timestamp (default: 1)") + "\n";
+    strUsage += "  -logqueuesize=<n>      " + strprintf(_("Queue up to <n> log lines for the background log writer, 0 to write them on the logging thread (default: %u)"), DEFAULT_LOGQUEUESIZE) + "\n";
+    strUsage += "  -logratelimit=<n>      " + strprintf(_("Drop the log lines over <n> per second of a category except error, 0 for no limit (default: %u)"), DEFAULT_LOGRATELIMIT) + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
         strUsage += "  -limitfreerelay=<n>    " + _("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default:15)") + "\n";
         strUsage += "  -maxsigcachesize=<n>   " + _("Limit size of signature cache to <n> entries (default: 50000)") + "\n";
@@ -449,6 +524,10 @@ bool AppInit(boost::thread_group &threadGroup) {
 #endif
 #endif
 
+    // Use the fastest SHA-256 transforms of this cpu for the block, tx and merkle hashing
+    sha256Impl = SHA256AutoDetect();
+    LogPrint(BCLog::INFO, "Using the '%s' SHA256 implementation\n", sha256Impl);
+
     if (SysCfg().IsArgCount("-bind")) {
         // when specifying an explicit binding address, you want to listen on it
         // even when -connect or -proxy is specified
@@ -493,9 +572,14 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
 
     // Make sure enough file descriptors are available
-    int32_t nBind   = max((int32_t)SysCfg().IsArgCount("-bind"), 1);
     nMaxConnections = SysCfg().GetArg("-maxconnections", 125);
+#ifdef USE_EPOLL
+    // epoll has no FD_SETSIZE limit, only the file descriptor limit below applies
+    nMaxConnections = max(nMaxConnections, 0);
+#else
+    int32_t nBind   = max((int32_t)SysCfg().IsArgCount("-bind"), 1);
     nMaxConnections = max(min(nMaxConnections, (int32_t)(FD_SETSIZE - nBind - MIN_CORE_FILEDESCRIPTORS)), 0);
+#endif
     int32_t nFD     = RaiseFileDescriptorLimit(nMaxConnections + MIN_CORE_FILEDESCRIPTORS);
     if (nFD < MIN_CORE_FILEDESCRIPTORS)
         return InitError(_("Not enough file descriptors available."));
@@ -503,6 +587,15 @@ bool AppInit(boost::thread_group &threadGroup) {
     if (nFD - MIN_CORE_FILEDESCRIPTORS < nMaxConnections)
         nMaxConnections = nFD - MIN_CORE_FILEDESCRIPTORS;
 
+    // -par=0 means autodetect, but nScriptCheckThreads==0 means no concurrency
+    nScriptCheckThreads = SysCfg().GetArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
+    if (nScriptCheckThreads <= 0)
+        nScriptCheckThreads += boost::thread::hardware_concurrency();
+    if (nScriptCheckThreads <= 1)
+        nScriptCheckThreads = 0;
+    else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
+        nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
+
     SysCfg().SetBenchMark(SysCfg().GetBoolArg("-benchmark", false));
     mempool.SetSanityCheck(SysCfg().GetBoolArg("-checkmempool", RegTest()));
 
@@ -553,6 +646,11 @@ bool AppInit(boost::thread_group &threadGroup) {
     LogPrint(BCLog::INFO, "Default data directory %s\n", GetDefaultDataDir().string());
     LogPrint(BCLog::INFO, "Using data directory %s\n", strDataDir);
     LogPrint(BCLog::INFO, "Using at most %i connections (%i file descriptors available)\n", nMaxConnections, nFD);
+    LogPrint(BCLog::INFO, "Using %u threads for signature verification\n", nScriptCheckThreads);
+    if (nScriptCheckThreads) {
+        for (int32_t i = 0; i < nScriptCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadScriptCheck);
+    }
 
     RegisterNodeSignals(GetNodeSignals());
 
@@ -698,6 +796,11 @@ bool AppInit(boost::thread_group &threadGroup) {
                 if (fReIndex)
                     pCdMan->pBlockCache->WriteReindexing(true);
 
+                if (!fReIndex && !pCdMan->RecoverFlushedState()) {
+                    strLoadError = _("Incomplete flush of the state databases detected");
+                    break;
+                }
+
                 mempool.SetMemPoolCache();
 
                 if (!LoadBlockIndex()) {
@@ -758,6 +861,23 @@ bool AppInit(boost::thread_group &threadGroup) {
 
     LogPrint(BCLog::INFO, "Build %lu block indexes into memory (%lldms)\n", mapBlockIndex.size(), GetTimeMillis() - nStart);
 
+    if (SysCfg().GetBoolArg("-dbbloomfilter", DEFAULT_DB_BLOOM_FILTER)) {
+        nStart = GetTimeMillis();
+        pCdMan->InitBloomFilters();
+        LogPrint(BCLog::INFO, "Build bloom filters of db keys (%lldms)\n", GetTimeMillis() - nStart);
+    }
+
+    // the state queries of rpc run on snapshots of the flushed dbs, without cs_main
+    pCdMan->UpdateSnapshot(chainActive.Height());
+
+    wasm::set_wasm_code_cache_size(
+        std::max<int64_t>(SysCfg().GetArg("-wasmcachesize", wasm::default_wasm_code_cache_size >> 20), 1) << 20);
+    if (SysCfg().GetBoolArg("-persistwasmcache", false)) {
+        nStart = GetTimeMillis();
+        uint32_t count = LoadWasmCodeCache();
+        LogPrint(BCLog::INFO, "Instantiate %u cached wasm modules (%lldms)\n", count, GetTimeMillis() - nStart);
+    }
+
     if (SysCfg().GetBoolArg("-printblockindex", false) || SysCfg().GetBoolArg("-printblocktree", false)) {
         PrintBlockTree();
         return false;
@@ -788,45 +908,8 @@ bool AppInit(boost::thread_group &threadGroup) {
     if (!ActivateBestChain(state))
         return InitError("Failed to connect best block");
 
-    nStart                   = GetTimeMillis();
-    CBlockIndex *pBlockIndex = chainActive.Tip();
-    int32_t nCacheHeight     = SysCfg().GetTxCacheHeight();
-    int32_t nCount           = 0;
-    CBlock block;
-    while (pBlockIndex && nCacheHeight-- > 0) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-
-        if (!pCdMan->pTxCache->AddBlockTx(block))
-            return InitError("Failed to add block to transaction memory cache");
-
-        pBlockIndex = pBlockIndex->pprev;
-        ++nCount;
-    }
-    LogPrint(BCLog::INFO, "Added the latest %d blocks to transaction memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
-
-    nStart       = GetTimeMillis();
-    pBlockIndex  = chainActive.Tip();
-    nCacheHeight = 11;  // TODO: parameterize 11.
-    nCount       = 0;
-
-
-    if (pBlockIndex) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-    }
-
-    while (pBlockIndex && nCacheHeight-- > 0) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-
-        if (!pCdMan->pPpCache->AddPriceByBlock(block))
-            return InitError("Failed to add block to price point memory cache");
-
-        pBlockIndex = pBlockIndex->pprev;
-        ++nCount;
-    }
-    LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
+    if (!LoadMemCaches())
+        return InitError("Failed to load transaction and price point memory caches");
 
     vector<boost::filesystem::path> vImportFiles;
     if (SysCfg().IsArgCount("-loadblock")) {
@@ -854,7 +937,10 @@ bool AppInit(boost::thread_group &threadGroup) {
 
     RandAddSeedPerfmon();
 
-    StartNode(threadGroup);
+    if (!StartNode(threadGroup))
+        return InitError(_("Failed to start the network, see debug.log for details."));
+    // Accept the txs received from the network to the mempool
+    threadGroup.create_thread(&ThreadTxValidation);
 
     if (SysCfg().IsServer()) {
         if (!StartRPCServer()) {
@@ -900,6 +986,8 @@ void InitLogging()
     LogInstance().m_log_threadnames = SysCfg().GetBoolArg("-logthreadnames", DEFAULT_LOGTHREADNAMES);
     LogInstance().m_totoal_written_size = LogInstance().GetCurrentLogSize() ;
     LogInstance().m_max_log_size = SysCfg().GetArg("-debuglogfilesize", 500 * 1024 * 1024);
+    LogInstance().m_queue_size = std::max<int64_t>(0, SysCfg().GetArg("-logqueuesize", DEFAULT_LOGQUEUESIZE));
+    LogInstance().m_rate_limit = std::max<int64_t>(0, SysCfg().GetArg("-logratelimit", DEFAULT_LOGRATELIMIT));
     fLogIPs = SysCfg().GetBoolArg("-logips", DEFAULT_LOGIPS);
 
     // TODO: ...
@@ -10,6 +10,8 @@
 #include "commons/util/util.h"
 #include "commons/types.h"
 
+#include <chrono>
+#include <cstring>
 #include <mutex>
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
@@ -42,6 +44,25 @@ static int FileWriteStr(const std::string &str, FILE *fp)
     return fwrite(str.data(), 1, str.size(), fp);
 }
 
+/** Max lines the writer thread takes from the queue for one write */
+static const size_t LOG_WRITE_BATCH_LINES = 1024;
+/** Max milliseconds the writer thread sleeps before checking the queue again */
+static const int64_t LOG_WRITER_WAIT_MILLIS = 100;
+
+/** The counter slot of a category bit, the last slot counts NONE, ALL and the combined flags */
+static int GetCategorySlot(BCLog::LogFlags category)
+{
+    uint32_t flags = category;
+    if (flags == 0 || (flags & (flags - 1)) != 0)
+        return BCLog::LOG_CATEGORY_SLOTS - 1;
+    int slot = 0;
+    while ((flags & 1) == 0) {
+        flags >>= 1;
+        slot++;
+    }
+    return slot;
+}
+
 bool BCLog::Logger::StartLogging()
 {
     std::lock_guard<std::mutex> scoped_lock(m_cs);
@@ -78,11 +99,52 @@ bool BCLog::Logger::StartLogging()
     }
     if (m_print_to_console) fflush(stdout);
 
+    // format on the logging threads, write on a background thread in batches
+    if (m_queue_size > 0) {
+        if (!m_queue)
+            m_queue.reset(new LogRingBuffer(m_queue_size));
+        m_stop_writer = false;
+        m_writer = std::thread(&BCLog::Logger::WriterThread, this);
+        m_async = true;
+    }
+
     return true;
 }
 
+void BCLog::Logger::StopLogging()
+{
+    if (!m_async.exchange(false))
+        return;
+
+    m_stop_writer = true;
+    m_writer_cond.notify_one();
+    if (m_writer.joinable())
+        m_writer.join();
+
+    // the lines pushed while the writer was stopping, the later ones are written by LogPrintStr()
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
+    WriteQueued();
+}
+
+void BCLog::Logger::WriteQueued()
+{
+    std::string line;
+    while (m_queue->TryPop(line)) {
+        WriteStr(line);
+        for (const auto& cb : m_print_callbacks) {
+            cb(line);
+        }
+    }
+}
+
+uint64_t BCLog::Logger::GetDroppedCount(BCLog::LogFlags category) const
+{
+    return m_dropped[GetCategorySlot(category)].load();
+}
+
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopLogging();
     std::lock_guard<std::mutex> scoped_lock(m_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
@@ -232,14 +294,14 @@ std::vector<CLogCategoryActive> ListActiveLogCategories()
     return ret;
 }
 
-std::string BCLog::Logger::LogTimestampStr(const std::string& str)
+std::string BCLog::Logger::LogTimestampStr(const std::string& str, bool started_new_line)
 {
     std::string strStamped;
 
     if (!m_log_timestamps)
         return str;
 
-    if (m_started_new_line) {
+    if (started_new_line) {
         int64_t nTimeMicros = GetTimeMicros();
         strStamped = FormatISO8601DateTime(nTimeMicros/1000000);
         if (m_log_time_micros) {
@@ -283,8 +345,8 @@ namespace BCLog {
 void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* file, int line,
     const std::string& str) {
 
+    bool started_new_line = m_started_new_line.exchange(!str.empty() && str[str.size()-1] == '\n');
 
-    std::lock_guard<std::mutex> scoped_lock(m_cs);
     std::string str_prefixed = LogEscapeMessage(str);
 
     str_prefixed.insert(0, "[" + GetLogCategoryName(category) + "] ");
@@ -292,28 +354,82 @@ void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* fil
     if (m_print_file_line)
         str_prefixed.insert(0, tfm::format("[%s:%d] ", file, line));
 
-    if (m_log_threadnames && m_started_new_line) {
+    if (m_log_threadnames && started_new_line) {
         str_prefixed.insert(0, "[" + util::ThreadGetInternalName() + "] ");
     }
 
-    str_prefixed = LogTimestampStr(str_prefixed);
+    str_prefixed = LogTimestampStr(str_prefixed, started_new_line);
 
-    m_started_new_line = !str.empty() && str[str.size()-1] == '\n';
+    // errors are written synchronously, the last ones before an abort or a crash must not wait in the queue
+    if (m_async && category != BCLog::ERROR) {
+        if (!m_queue->TryPush(std::move(str_prefixed))) {
+            ++m_dropped[GetCategorySlot(category)];
+            return;
+        }
+        if (m_writer_waiting.load(std::memory_order_relaxed))
+            m_writer_cond.notify_one();
+
+        // StopLogging() may have drained the queue before the push, then the line is written here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_async) {
+            std::lock_guard<std::mutex> scoped_lock(m_cs);
+            WriteQueued();
+        }
+        return;
+    }
 
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
     if (m_buffering) {
         // buffer if we haven't started logging yet
         m_msgs_before_open.push_back(str_prefixed);
         return;
     }
 
+    // the lines queued before go first
+    if (m_queue)
+        WriteQueued();
+    WriteStr(str_prefixed);
+    for (const auto& cb : m_print_callbacks) {
+        cb(str_prefixed);
+    }
+}
+
+bool BCLog::Logger::AcceptLine(BCLog::LogFlags category, const char* fmt)
+{
+    // checked by LogPrintf() before formatting, so the dropped lines cost next to nothing
+    if (category == BCLog::ERROR || m_rate_limit == 0)
+        return true;
+
+    int slot = GetCategorySlot(category);
+    if (AcceptRate(slot))
+        return true;
+
+    ++m_dropped[slot];
+    // the dropped line ends where its format does, so the next line is stamped as LogPrintStr() would
+    size_t len = strlen(fmt);
+    m_started_new_line = len > 0 && fmt[len - 1] == '\n';
+    return false;
+}
+
+bool BCLog::Logger::AcceptRate(int slot)
+{
+    if (m_rate_limit == 0)
+        return true;
+
+    int64_t now = GetTimeMillis() / 1000;
+    int64_t second = m_rate_second[slot].load(std::memory_order_relaxed);
+    if (second != now && m_rate_second[slot].compare_exchange_strong(second, now, std::memory_order_relaxed))
+        m_rate_count[slot].store(0, std::memory_order_relaxed);
+    return m_rate_count[slot].fetch_add(1, std::memory_order_relaxed) < m_rate_limit;
+}
+
+void BCLog::Logger::WriteStr(const std::string& str)
+{
     if (m_print_to_console) {
         // print to console
-        fwrite(str_prefixed.data(), 1, str_prefixed.size(), stdout);
+        fwrite(str.data(), 1, str.size(), stdout);
         fflush(stdout);
     }
-    for (const auto& cb : m_print_callbacks) {
-        cb(str_prefixed);
-    }
     if (m_print_to_file) {
 
         assert(m_fileout != nullptr);
@@ -328,8 +444,8 @@ void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* fil
             }
         }
 
-        FileWriteStr(str_prefixed, m_fileout);
-        m_totoal_written_size += str_prefixed.size();
+        FileWriteStr(str, m_fileout);
+        m_totoal_written_size += str.size();
 
         if(m_totoal_written_size > m_max_log_size){
             ShrinkDebugFile();
@@ -340,6 +456,125 @@ void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* fil
     }
 }
 
+void BCLog::Logger::WriterThread()
+{
+    util::ThreadRename("coin-logwriter");
+
+    std::vector<std::string> lines;
+    std::string batch;
+    while (true) {
+        // take all the queued lines, and write them to the file and console at once
+        std::string line;
+        while (lines.size() < LOG_WRITE_BATCH_LINES && m_queue->TryPop(line)) {
+            batch += line;
+            lines.push_back(std::move(line));
+        }
+
+        if (!lines.empty()) {
+            std::lock_guard<std::mutex> scoped_lock(m_cs);
+            WriteStr(batch);
+            for (const auto& cb : m_print_callbacks) {
+                for (const auto& l : lines)
+                    cb(l);
+            }
+        }
+        ReportDropped();
+
+        if (lines.empty()) {
+            if (m_stop_writer)
+                break;
+
+            std::unique_lock<std::mutex> lock(m_writer_mutex);
+            m_writer_waiting = true;
+            m_writer_cond.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_WAIT_MILLIS));
+            m_writer_waiting = false;
+        }
+        lines.clear();
+        batch.clear();
+    }
+}
+
+void BCLog::Logger::ReportDropped()
+{
+    for (int slot = 0; slot < LOG_CATEGORY_SLOTS; slot++) {
+        uint64_t dropped = m_dropped[slot].load(std::memory_order_relaxed);
+        uint64_t reported = m_dropped_reported[slot].load(std::memory_order_relaxed);
+        if (dropped == reported)
+            continue;
+
+        m_dropped_reported[slot] = dropped;
+        const std::string& name = (slot < LOG_CATEGORY_SLOTS - 1) ? GetLogCategoryName((BCLog::LogFlags)(1U << slot))
+                                                                  : LOG_CATEGORY_UNKOWN;
+        std::string str = LogTimestampStr(strprintf("[%s] dropped %llu log lines, %llu in total\n", name,
+                                                    dropped - reported, dropped), true);
+        std::lock_guard<std::mutex> scoped_lock(m_cs);
+        WriteStr(str);
+    }
+}
+
+BCLog::LogRingBuffer::LogRingBuffer(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    m_slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++)
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+    m_mask = size - 1;
+}
+
+bool BCLog::LogRingBuffer::TryPush(std::string&& line)
+{
+    Slot* slot;
+    size_t pos = m_push_pos.load(std::memory_order_relaxed);
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            // the slot is free in this round, claim it
+            if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            // the slot is still filled from the previous round
+            return false;
+        } else {
+            pos = m_push_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->line = std::move(line);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool BCLog::LogRingBuffer::TryPop(std::string& line)
+{
+    Slot* slot;
+    size_t pos = m_pop_pos.load(std::memory_order_relaxed);
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            // the slot is filled in this round, claim it
+            if (m_pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = m_pop_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    line = std::move(slot->line);
+    slot->line.clear();
+    // free for the push of the next round
+    slot->seq.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
 void BCLog::Logger::ShrinkDebugFile()
 {
     assert(!m_file_path.empty());
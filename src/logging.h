@@ -10,10 +10,13 @@
 #include "commons/tinyformat.h"
 #include <boost/filesystem.hpp>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace fs = boost::filesystem;
@@ -22,6 +25,10 @@ static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
+/** Default number of log lines queued for the background writer, 0 writes them on the logging thread */
+static const uint32_t DEFAULT_LOGQUEUESIZE = 8192;
+/** Default limit of log lines per second of a category, 0 means unlimited */
+static const uint32_t DEFAULT_LOGRATELIMIT = 0;
 extern const char * const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogIPs;
@@ -60,13 +67,42 @@ namespace BCLog { //blockchain log
         ALL         = ~(uint32_t)0,
     };
 
+    /**
+     * Bounded lock-free queue of formatted log lines, pushed by any thread and popped by the log
+     * writer thread. Every slot carries a sequence number telling whether it is free for the push or
+     * filled for the pop of the current round over the ring.
+     */
+    class LogRingBuffer
+    {
+    public:
+        explicit LogRingBuffer(size_t capacity);
+
+        // false if the queue is full
+        bool TryPush(std::string&& line);
+        // false if the queue is empty
+        bool TryPop(std::string& line);
+
+    private:
+        struct Slot {
+            std::atomic<size_t> seq;
+            std::string line;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask;
+        alignas(64) std::atomic<size_t> m_push_pos{0};
+        alignas(64) std::atomic<size_t> m_pop_pos{0};
+    };
+
+    static const int LOG_CATEGORY_SLOTS = 32;
+
     class Logger
     {
     private:
         mutable std::mutex m_cs;                   // Can not use Mutex from sync.h because in debug mode it would cause a deadlock when a potential deadlock was detected
         FILE* m_fileout = nullptr;                 // GUARDED_BY(m_cs)
         std::list<std::string> m_msgs_before_open; // GUARDED_BY(m_cs)
-        bool m_buffering{true};                    //!< Buffer messages before logging can be started. GUARDED_BY(m_cs)
+        std::atomic_bool m_buffering{true};        //!< Buffer messages before logging can be started. Changed under m_cs
 
         /**
          * m_started_new_line is a state variable that will suppress printing of
@@ -78,7 +114,31 @@ namespace BCLog { //blockchain log
         /** Log categories bitfield. */
         std::atomic<uint32_t> m_categories{0};
 
-        std::string LogTimestampStr(const std::string& str);
+        std::string LogTimestampStr(const std::string& str, bool started_new_line);
+
+        /** Lines queued for the writer thread, nullptr when written on the logging thread */
+        std::unique_ptr<LogRingBuffer> m_queue;
+        std::thread m_writer;
+        std::mutex m_writer_mutex;
+        std::condition_variable m_writer_cond;
+        std::atomic<bool> m_async{false};
+        std::atomic<bool> m_writer_waiting{false};
+        std::atomic<bool> m_stop_writer{false};
+
+        /** Lines dropped by the full queue or the rate limit, per category bit */
+        std::atomic<uint64_t> m_dropped[LOG_CATEGORY_SLOTS] = {};
+        std::atomic<uint64_t> m_dropped_reported[LOG_CATEGORY_SLOTS] = {};
+        /** Second and count of lines of the current rate limit window, per category bit */
+        std::atomic<int64_t> m_rate_second[LOG_CATEGORY_SLOTS] = {};
+        std::atomic<uint32_t> m_rate_count[LOG_CATEGORY_SLOTS] = {};
+
+        bool AcceptRate(int slot);
+        /** Write the lines to the console and the file, requires m_cs */
+        void WriteStr(const std::string& str);
+        /** Write the lines left in the queue, requires m_cs */
+        void WriteQueued();
+        void WriterThread();
+        void ReportDropped();
 
         /** Slots that connect to the print signal */
         std::list<std::function<void(const std::string&)>> m_print_callbacks /* GUARDED_BY(m_cs) */ {};
@@ -94,10 +154,18 @@ namespace BCLog { //blockchain log
         bool m_log_threadnames = DEFAULT_LOGTHREADNAMES;
         uint64_t m_totoal_written_size = 0 ;
         uint64_t m_max_log_size = 0 ;
+        uint32_t m_queue_size = DEFAULT_LOGQUEUESIZE;
+        uint32_t m_rate_limit = DEFAULT_LOGRATELIMIT;
 
         fs::path m_file_path;
         std::atomic<bool> m_reopen_file{false};
 
+        /**
+         * Check the rate limit of the category before the line is formatted, and count the line as
+         * dropped if it is over. Errors are never dropped.
+         */
+        bool AcceptLine(LogFlags category, const char* fmt);
+
         /** Send a string to the log output */
         void LogPrintStr(const BCLog::LogFlags& category, const char* file, int line,
             const std::string& str);
@@ -105,8 +173,10 @@ namespace BCLog { //blockchain log
         /** Returns whether logs will be written to any output */
         bool Enabled() const
         {
+            if (m_buffering || m_print_to_console || m_print_to_file)
+                return true;
             std::lock_guard<std::mutex> scoped_lock(m_cs);
-            return m_buffering || m_print_to_console || m_print_to_file || !m_print_callbacks.empty();
+            return !m_print_callbacks.empty();
         }
 
         /** Connect a slot to the print signal and return the connection */
@@ -128,6 +198,10 @@ namespace BCLog { //blockchain log
 
         /** Start logging (and flush all buffered messages) */
         bool StartLogging();
+        /** Write the queued lines and stop the writer thread, the later lines are written synchronously */
+        void StopLogging();
+        /** Number of lines of the category dropped by the full queue or the rate limit */
+        uint64_t GetDroppedCount(LogFlags category) const;
         /** Only for testing */
         void DisconnectTestLogger();
 
@@ -172,7 +246,7 @@ template <typename... Args>
 static inline void LogPrintf(const BCLog::LogFlags& category, const char* file, int line,
     const char* fmt, const Args&... args) {
 
-    if (LogInstance().Enabled()) {
+    if (LogInstance().Enabled() && LogInstance().AcceptLine(category, fmt)) {
         std::string log_msg;
         try {
             log_msg = tfm::format(fmt, args...);
@@ -14,6 +14,7 @@
 #include "config/configuration.h"
 #include "config/scoin.h"
 #include "init.h"
+#include "checkqueue.h"
 #include "miner/miner.h"
 #include "net.h"
 #include "tx/merkletx.h"
@@ -29,6 +30,7 @@
 #include "persistence/blockundo.h"
 #include "tx/txserializer.h"
 
+#include <atomic>
 #include <sstream>
 #include <algorithm>
 #include <boost/algorithm/string/replace.hpp>
@@ -56,13 +58,16 @@ CTxMemPool mempool;
 map<uint256, CBlockIndex *> mapBlockIndex;
 int32_t nSyncTipHeight = 0;
 string publicIp;
+string sha256Impl;
 map<uint256/* blockhash */, std::shared_ptr<CCacheWrapper>> mapForkCache;
 CSignatureCache signatureCache;
 CChain chainActive;
 CChain chainMostWork;
+CHeadersChain headersChain;
 bool mining;        // could change from time to time due to vote change
 CKeyID minerKeyId;  // miner accout keyId
 CKeyID nodeKeyId;   // 1st keyId of the node
+int32_t nScriptCheckThreads = 0;
 extern CPBFTMan pbftMan;
 
 map<uint256/* blockhash */, COrphanBlock *> mapOrphanBlocks;
@@ -250,10 +255,121 @@ bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signatu
     return true;
 }
 
-bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee) {
-    AssertLockHeld(cs_main);
+static CCheckQueue<CSignatureCheck> scriptCheckQueue(SCRIPTCHECK_BATCH_SIZE);
+
+void ThreadScriptCheck() {
+    RenameThread("coin-scriptch");
+    scriptCheckQueue.Thread();
+}
+
+bool CSignatureCheck::operator()() {
+    // A bad signature must not stop the batch: the serial CheckTx() pass is the one to reject it.
+    ::VerifySignature(sigHash, signature, pubKey);
+    return true;
+}
+
+// Resolve the signer's pubkey of each tx from the given state; txs of accounts unknown to it
+// (e.g. registered within the same block) are simply left to the serial pass.
+static void AddSignatureChecks(const vector<std::shared_ptr<CBaseTx>> &vptx, CAccountDBCache &accountCache,
+                               vector<CSignatureCheck> &vChecks) {
+    vChecks.reserve(vChecks.size() + vptx.size());
+    for (const auto &pBaseTx : vptx) {
+        if (pBaseTx->IsBlockRewardTx() || pBaseTx->IsPriceMedianTx() || pBaseTx->signature.empty())
+            continue;
+
+        CPubKey pubKey;
+        if (pBaseTx->txUid.is<CPubKey>()) {
+            pubKey = pBaseTx->txUid.get<CPubKey>();
+        } else {
+            CAccount account;
+            if (!accountCache.GetAccount(pBaseTx->txUid, account))
+                continue;
+
+            pubKey = account.owner_pubkey;
+        }
+
+        if (!pubKey.IsFullyValid())
+            continue;
+
+        // verified already, e.g. ahead of the connection of its block
+        if (signatureCache.Get(pBaseTx->GetHash(), pBaseTx->signature, pubKey))
+            continue;
+
+        vChecks.emplace_back(pBaseTx->GetHash(), pBaseTx->signature, pubKey);
+    }
+}
+
+static void RunSignatureChecks(vector<CSignatureCheck> &vChecks) {
+    if (vChecks.empty())
+        return;
+
+    int64_t nStart = GetTimeMicros();
+    size_t nChecks = vChecks.size();
+    CCheckQueueControl<CSignatureCheck> control(&scriptCheckQueue);
+    control.Add(vChecks);
+    control.Wait();
+
+    int64_t nTime = GetTimeMicros() - nStart;
+    if (SysCfg().IsBenchmark())
+        LogPrint(BCLog::INFO, "- Verify %u signatures with %d threads: %.2fms\n", (uint32_t)nChecks,
+                 nScriptCheckThreads, 0.001 * nTime);
+}
 
+void PreVerifyBlockSignatures(const CBlock &block, CCacheWrapper &cw) {
+    if (nScriptCheckThreads <= 0 || block.vptx.size() <= 1)
+        return;
+
+    // signers are resolved from the state before this block
+    vector<CSignatureCheck> vChecks;
+    AddSignatureChecks(block.vptx, cw.accountCache, vChecks);
+    RunSignatureChecks(vChecks);
+}
+
+// Verifies the signatures of the next block on the script check threads while the calling thread connects
+// the current one, so that CheckBlock() of the next block finds them in the signature cache. Signers are
+// resolved from the state before the current block: txs of accounts it registers are left to the serial pass.
+class CSignatureVerifyAhead {
+private:
+    boost::thread verifyThread;
+
+public:
+    ~CSignatureVerifyAhead() { Wait(); }
+
+    void Wait() {
+        if (verifyThread.joinable())
+            verifyThread.join();
+    }
+
+    // Requires cs_main.
+    void Start(const CBlock &block, CAccountDBCache &accountCache) {
+        Wait();
+        if (nScriptCheckThreads <= 0 || block.vptx.size() <= 1)
+            return;
+
+        auto spChecks = std::make_shared<vector<CSignatureCheck>>();
+        AddSignatureChecks(block.vptx, accountCache, *spChecks);
+        if (!spChecks->empty())
+            verifyThread = boost::thread([spChecks]() { RunSignatureChecks(*spChecks); });
+    }
+};
+
+void PreVerifyTxSignatures(const vector<std::shared_ptr<CBaseTx>> &vptx) {
+    if (nScriptCheckThreads <= 0 || vptx.size() <= 1)
+        return;
+
+    vector<CSignatureCheck> vChecks;
+    {
+        LOCK(cs_main);
+        AddSignatureChecks(vptx, mempool.cw->accountCache, vChecks);
+    }
+    RunSignatureChecks(vChecks);
+}
+
+// The checks of a tx before it is executed into the mempool cache. The state of cw is the mempool
+// cache, or the cache layer of a tx batch on top of it; cw is not flushed.
+static bool CheckTxForMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
+                                 const CTxMemPoolEntry &entry, CCacheWrapper &cw, bool fLimitFree,
+                                 bool fRejectInsaneFee) {
     // is it already in the memory pool?
     uint256 hash = pBaseTx->GetHash();
     if (pool.Exists(hash))
@@ -272,18 +388,15 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
         return state.DoS(0, ERRORMSG("AcceptToMemoryPool() : txid: %s is nonstandard transaction due to %s",
                         hash.GetHex(), reason), REJECT_NONSTANDARD, reason);
 
-    auto spCW = std::make_shared<CCacheWrapper>(mempool.cw.get());
-
     CBlockIndex *pTip =  chainActive.Tip();
     uint32_t fuelRate  = GetElementForBurn(pTip);
     uint32_t blockTime = pTip->GetBlockTime();
     uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
 
-    CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, spCW.get(), &state);
+    CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, &cw, &state);
     if (!pBaseTx->CheckTx(context))
         return ERRORMSG("AcceptToMemoryPool() : CheckTx failed, txid: %s", hash.GetHex());
 
-    CTxMemPoolEntry entry(pBaseTx, GetTime(), chainActive.Height());
     auto nFees = std::get<1>(entry.GetFees());
     auto nSize = entry.GetTxSize();
     // Continuously rate-limit free transactions
@@ -312,7 +425,50 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
     if (fRejectInsaneFee && nFees > SysCfg().GetMaxFee())
         return ERRORMSG("AcceptToMemoryPool() : txid: %s pay insane fees, %d > %d", hash.GetHex(), nFees, SysCfg().GetMaxFee());
 
-    return pool.AddUnchecked(hash, entry, state);
+    return true;
+}
+
+bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
+                        bool fLimitFree, bool fRejectInsaneFee) {
+    AssertLockHeld(cs_main);
+
+    CTxMemPoolEntry entry(pBaseTx, GetTime(), chainActive.Height());
+    auto spCW = std::make_shared<CCacheWrapper>(mempool.cw.get());
+    if (!CheckTxForMemoryPool(pool, state, pBaseTx, entry, *spCW, fLimitFree, fRejectInsaneFee))
+        return false;
+
+    return pool.AddUnchecked(pBaseTx->GetHash(), entry, state);
+}
+
+uint32_t AcceptTxBatchToMemoryPool(CTxMemPool &pool, const vector<std::shared_ptr<CBaseTx>> &vptx,
+                                   vector<CValidationState> &states, vector<bool> &accepted, bool fLimitFree) {
+    AssertLockHeld(cs_main);
+
+    states.assign(vptx.size(), CValidationState());
+    accepted.assign(vptx.size(), false);
+
+    // Every tx sees the effects of the txs accepted before it, as with one by one submission. The
+    // changes of a failed tx are dropped with its own cache layer.
+    auto spBatchCW = std::make_shared<CCacheWrapper>(pool.cw.get());
+    uint32_t nAccepted = 0;
+    for (size_t i = 0; i < vptx.size(); i++) {
+        CBaseTx *pBaseTx = vptx[i].get();
+        CTxMemPoolEntry entry(pBaseTx, GetTime(), chainActive.Height());
+        auto spCW = std::make_shared<CCacheWrapper>(spBatchCW.get());
+        if (!CheckTxForMemoryPool(pool, states[i], pBaseTx, entry, *spCW, fLimitFree, false))
+            continue;
+
+        if (!pool.AddUnchecked(pBaseTx->GetHash(), entry, states[i], spBatchCW.get()))
+            continue;
+
+        accepted[i] = true;
+        nAccepted++;
+    }
+
+    // the accepted txs reach the mempool cache with a single flush
+    spBatchCW->Flush();
+
+    return nAccepted;
 }
 
 int32_t CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex *&pindexRet) const {
@@ -1009,7 +1165,8 @@ static bool ComputeVoteStakingInterestAndRevokeVotes(const int32_t currHeight, c
     return true;
 }
 
-bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool fJustCheck) {
+bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool fJustCheck,
+                  CBlockUndo *pBlockUndoOut) {
     AssertLockHeld(cs_main);
 
     bool isGensisBlock = block.GetHeight() == 0 && block.GetHash() == SysCfg().GetGenesisBlockHash();
@@ -1294,13 +1451,16 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
     // Set best block to current account cache.
     cw.blockCache.SetBestBlock(pIndex->GetBlockHash());
 
+    if (pBlockUndoOut != nullptr)
+        *pBlockUndoOut = std::move(blockUndo);
+
     return true;
 }
 
 // Update the on-disk chain state.
-bool static WriteChainState(CValidationState &state) {
-    static int64_t nLastWrite = 0;
-    uint32_t cacheSize        =
+bool static WriteChainState(CValidationState &state, int32_t tipHeight) {
+    static int64_t nLastWrite = GetTime();
+    uint64_t cacheSize        =
         pCdMan->pSysParamCache->GetCacheSize() +
         pCdMan->pAccountCache->GetCacheSize() +
         pCdMan->pAssetCache->GetCacheSize() +
@@ -1311,10 +1471,17 @@ bool static WriteChainState(CValidationState &state) {
         pCdMan->pDexCache->GetCacheSize() +
         pCdMan->pBlockCache->GetCacheSize() +
         pCdMan->pLogCache->GetCacheSize() +
-        pCdMan->pReceiptCache->GetCacheSize();
-
-    if (!IsInitialBlockDownload() || cacheSize > SysCfg().GetCacheSize() ||
-        GetTimeMicros() > nLastWrite + 60 * 1000000) {
+        pCdMan->pReceiptCache->GetCacheSize() +
+        pCdMan->pSysGovernCache->GetCacheSize();
+
+    // During the initial block download and reindex the caches absorb the changes of many blocks up to
+    // -ibddbcache or IBD_DB_FLUSH_INTERVAL, then go to disk in one batch per db without sync writes.
+    // After the process crashes between two flushes the dbs agree on the last one, and RecoverFlushedState()
+    // replays the blocks after it at startup. An OS crash, or a crash in the middle of one of these
+    // unsynced flushes, may leave the dbs at different blocks, then startup fails and the node must be
+    // reindexed. The first flush after the download is a synced, atomic one again.
+    bool fInitialDownload = IsInitialBlockDownload();
+    if (!fInitialDownload || cacheSize > SysCfg().GetIbdCacheSize() || GetTime() > nLastWrite + IBD_DB_FLUSH_INTERVAL) {
         // Typical CCoins structures on disk are around 100 bytes in size.
         // Pushing a new one to the database can cause it to be written
         // twice (once in the log, and once in the tables). This is already
@@ -1323,11 +1490,24 @@ bool static WriteChainState(CValidationState &state) {
         if (!CheckDiskSpace(cacheSize))
             return state.Error("out of disk space");
 
+        int64_t beginTime = GetTimeMillis();
         FlushBlockFile();
         // pCdMan->pBlockCache->Sync();
-        pCdMan->Flush();
+        pCdMan->Flush(!fInitialDownload);
+        nLastWrite = GetTime();
+        // the flushed dbs are consistent with the new tip, publish them to the queries running without cs_main
+        pCdMan->UpdateSnapshot(tipHeight);
         mapForkCache.clear();
-        nLastWrite = GetTimeMicros();
+        if (fInitialDownload)
+            LogPrint(BCLog::CDB, "WriteChainState() : flushed %llu bytes of cache at height %d in %lld ms\n",
+                     cacheSize, tipHeight, GetTimeMillis() - beginTime);
+    }
+
+    // a recent snapshot of the memory caches spares reading the latest blocks at the next startup
+    static int64_t nLastSnapshot = GetTime();
+    if (!IsInitialBlockDownload() && GetTime() > nLastSnapshot + MEMCACHE_SNAPSHOT_INTERVAL) {
+        WriteMemCacheSnapshot();
+        nLastSnapshot = GetTime();
     }
     return true;
 }
@@ -1398,10 +1578,12 @@ bool static DisconnectTip(CValidationState &state) {
     if (SysCfg().IsBenchmark())
         LogPrint(BCLog::INFO, "- Disconnect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexDelete->pprev->height))
         return false;
     // Update chainActive and related variables.
     UpdateTip(pIndexDelete->pprev, block);
+    // The mempool state was built on the disconnected block, it must be rebuilt entirely.
+    mempool.SetFullRescan();
     // Resurrect mempool transactions from the disconnected block.
     for (const auto &pTx : block.vptx) {
         list<std::shared_ptr<CBaseTx> > removed;
@@ -1418,21 +1600,117 @@ bool static DisconnectTip(CValidationState &state) {
     return true;
 }
 
-// Connect a new block to chainActive.
-bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
+static bool ReadBlocksFromDisk(const vector<const CBlockIndex *> &indexes, vector<CBlock> &blocks);
+
+// Reads and deserializes a run of blocks to connect on a thread of its own, up to MAX_BLOCKS_CONNECT_AHEAD
+// blocks ahead of ConnectTip().
+class CBlockPrefetcher {
+private:
+    vector<const CBlockIndex *> indexes;
+    vector<std::shared_ptr<CBlock>> blocks;
+    size_t nRead;  // number of blocks read so far
+    size_t nNext;  // position of the next block to connect
+    bool fStop;
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    boost::thread readThread;
+
+    void Thread() {
+        while (true) {
+            size_t first;
+            vector<const CBlockIndex *> batch;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex);
+                while (!fStop && nRead < indexes.size() && nRead >= nNext + MAX_BLOCKS_CONNECT_AHEAD)
+                    cond.wait(lock);
+                if (fStop || nRead >= indexes.size())
+                    return;
+
+                first = nRead;
+                batch.assign(indexes.begin() + first,
+                             indexes.begin() + std::min(indexes.size(), nNext + MAX_BLOCKS_CONNECT_AHEAD));
+            }
+
+            vector<CBlock> vBlocks;
+            bool fRead = ReadBlocksFromDisk(batch, vBlocks);
+            if (fRead) {
+                for (auto &block : vBlocks)
+                    block.BuildMerkleTree();
+            }
+
+            {
+                boost::unique_lock<boost::mutex> lock(mutex);
+                if (fRead) {
+                    for (size_t i = 0; i < vBlocks.size(); i++)
+                        blocks[first + i] = std::make_shared<CBlock>(std::move(vBlocks[i]));
+                    nRead = first + batch.size();
+                } else {
+                    // ConnectTip() reads the rest by itself and reports the failure
+                    nRead = indexes.size();
+                }
+            }
+            cond.notify_all();
+        }
+    }
+
+public:
+    explicit CBlockPrefetcher(const vector<const CBlockIndex *> &indexesIn)
+        : indexes(indexesIn), blocks(indexesIn.size()), nRead(0), nNext(0), fStop(false) {
+        readThread = boost::thread(&CBlockPrefetcher::Thread, this);
+    }
+
+    ~CBlockPrefetcher() {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fStop = true;
+        }
+        cond.notify_all();
+        readThread.join();
+    }
+
+    // Returns the block of pIndex once read if it is the next of the run, otherwise nullptr.
+    std::shared_ptr<CBlock> Next(const CBlockIndex *pIndex) {
+        std::shared_ptr<CBlock> pBlock;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            if (nNext >= indexes.size() || indexes[nNext] != pIndex)
+                return nullptr;
+
+            while (nRead <= nNext)
+                cond.wait(lock);
+            pBlock = std::move(blocks[nNext++]);
+        }
+        cond.notify_all();
+        return pBlock;
+    }
+
+    // Returns the block after the one last returned by Next() if it has been read already.
+    std::shared_ptr<CBlock> PeekNext() {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        return nNext < nRead ? blocks[nNext] : nullptr;
+    }
+};
+
+// Connect a new block to chainActive, pBlock is the block of pIndexNew if it is in memory already.
+bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew, CBlock *pBlock = nullptr) {
     assert(pIndexNew->pprev == chainActive.Tip());
     // Read block from disk.
-    CBlock block;
-    if (!ReadBlockFromDisk(pIndexNew, block))
-        return state.Abort(strprintf("Failed to read block hash: %s", pIndexNew->GetBlockHash().GetHex()));
+    CBlock blockRead;
+    if (pBlock == nullptr) {
+        if (!ReadBlockFromDisk(pIndexNew, blockRead))
+            return state.Abort(strprintf("Failed to read block hash: %s", pIndexNew->GetBlockHash().GetHex()));
+        pBlock = &blockRead;
+    }
+    CBlock &block = *pBlock;
 
     // Apply the block automatically to the chain state.
     int64_t nStart = GetTimeMicros();
+    CBlockUndo blockUndo;
     {
         CInv inv(MSG_BLOCK, pIndexNew->GetBlockHash());
 
         auto spCW = std::make_shared<CCacheWrapper>(pCdMan);
-        if (!ConnectBlock(block, *spCW, pIndexNew, state)) {
+        if (!ConnectBlock(block, *spCW, pIndexNew, state, false, &blockUndo)) {
             if (state.IsInvalid()) {
                 InvalidBlockFound(pIndexNew, state);
             }
@@ -1452,15 +1730,14 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
         LogPrint(BCLog::INFO, "- Connect: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
 
     // Write the chain state to disk, if necessary.
-    if (!WriteChainState(state))
+    if (!WriteChainState(state, pIndexNew->height))
         return false;
 
     // Update chainActive & related variables.
     UpdateTip(pIndexNew, block);
 
-    for (auto &pTxItem : block.vptx) {
-        mempool.memPoolTxs.erase(pTxItem->GetHash());
-    }
+    // Remove the confirmed txs from mempool, the keys modified by the block are revalidated by next rescan.
+    mempool.RemoveForBlock(block, blockUndo);
     return true;
 }
 
@@ -1518,10 +1795,10 @@ void static FindMostWorkChain() {
     chainMostWork.SetTip(pIndexNew);
 }
 
-bool connectBlockOnFinChain(CBlockIndex* pNewIndex, CValidationState& state){
+bool connectBlockOnFinChain(CBlockIndex* pNewIndex, CValidationState& state, CBlock *pNewBlock = nullptr){
 
     if(pNewIndex && chainActive.Tip() == pNewIndex->pprev){
-        if (!ConnectTip(state, pNewIndex)) {
+        if (!ConnectTip(state, pNewIndex, pNewBlock)) {
             if (state.IsInvalid()) {
                 // The block violates a consensus rule.
                 if (!state.CorruptionPossible())
@@ -1540,7 +1817,7 @@ bool connectBlockOnFinChain(CBlockIndex* pNewIndex, CValidationState& state){
 
 }
 // Try to activate to the most-work chain (thereby connecting it).
-bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex) {
+bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex, CBlock *pNewBlock) {
     LOCK(cs_main);
     CBlockIndex *pIndexOldTip = chainActive.Tip();
     bool fComplete            = false;
@@ -1564,14 +1841,14 @@ bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex) {
                         pbftMan.SetLocalFinTimeout() ;
                     } else{
                         LogPrint(BCLog::INFO, "connect block on fin chain\n") ;
-                        return connectBlockOnFinChain(pNewIndex, state) ;
+                        return connectBlockOnFinChain(pNewIndex, state, pNewBlock) ;
                     }
                 }
 
                 uint256 globalFinIndexHash = pbftMan.GetGlobalFinBlockHash() ;
                 if( chainIndex->GetBlockHash() == globalFinIndexHash){
                     LogPrint(BCLog::INFO, "globalfinality block can't be reverse\n");
-                    return connectBlockOnFinChain(pNewIndex, state) ;
+                    return connectBlockOnFinChain(pNewIndex, state, pNewBlock) ;
                 }
 
                 height-- ;
@@ -1591,10 +1868,27 @@ bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex) {
             }
         }
 
-        // Connect new blocks.
+        // Connect new blocks. A longer run is read ahead, and the signatures of the next block are
+        // verified while the current one is connected.
+        std::unique_ptr<CBlockPrefetcher> pPrefetcher;
+        if (chainMostWork.Height() - chainActive.Height() > 1) {
+            vector<const CBlockIndex *> indexes;
+            for (int32_t height = chainActive.Height() + 1; height <= chainMostWork.Height(); height++)
+                indexes.push_back(chainMostWork[height]);
+            pPrefetcher.reset(new CBlockPrefetcher(indexes));
+        }
+        CSignatureVerifyAhead verifyAhead;
         while (!chainActive.Contains(chainMostWork.Tip())) {
             CBlockIndex *pIndexConnect = chainMostWork[chainActive.Height() + 1];
-            if (!ConnectTip(state, pIndexConnect)) {
+            std::shared_ptr<CBlock> pBlock;
+            if (pPrefetcher) {
+                pBlock = pPrefetcher->Next(pIndexConnect);
+                std::shared_ptr<CBlock> pNextBlock = pPrefetcher->PeekNext();
+                if (pNextBlock)
+                    verifyAhead.Start(*pNextBlock, *pCdMan->pAccountCache);
+            }
+            CBlock *pConnectBlock = pBlock ? pBlock.get() : (pIndexConnect == pNewIndex ? pNewBlock : nullptr);
+            if (!ConnectTip(state, pIndexConnect, pConnectBlock)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (!state.CorruptionPossible())
@@ -1668,7 +1962,7 @@ bool AddToBlockIndex(CBlock &block, CValidationState &state, const CDiskBlockPos
         return state.Abort(_("Failed to write block index"));
     int64_t beginTime = GetTimeMillis();
     // New best?
-    if (!ActivateBestChain(state, pIndexNew)) {
+    if (!ActivateBestChain(state, pIndexNew, &block)) {
         LogPrint(BCLog::INFO, "ActivateBestChain() elapse time:%lld ms\n", GetTimeMillis() - beginTime);
         return false;
     }
@@ -1680,7 +1974,8 @@ bool AddToBlockIndex(CBlock &block, CValidationState &state, const CDiskBlockPos
     } else
         CheckForkWarningConditionsOnNewFork(pIndexNew);
 
-    if (!pCdMan->pBlockCache->Flush())
+    // during the initial block download the best block is written with the state dbs by WriteChainState()
+    if (!IsInitialBlockDownload() && !pCdMan->pBlockCache->Flush())
         return state.Abort(_("Failed to sync block index"));
 
     if (chainActive.Height() > nSyncTipHeight)
@@ -1911,6 +2206,11 @@ bool CheckBlock(const CBlock &block, CValidationState &state, CCacheWrapper &cw,
     // recalculated many times during this block's validation.
     block.BuildMerkleTree();
 
+    // Verify all tx signatures in parallel first, so that the serial CheckTx() pass below
+    // finds them in the signature cache.
+    if (fCheckTx)
+        PreVerifyBlockSignatures(block, cw);
+
     // Check for duplicate txids. This is caught by ConnectInputs(),
     // but catching it earlier avoids a potential DoS attack:
     set<uint256> uniqueTx;
@@ -2039,11 +2339,21 @@ bool AcceptBlock(CBlock &block, CValidationState &state, CDiskBlockPos *dbp, boo
     CBlockIndex* pTip = chainActive.Tip() ;
     if (pTip->GetBlockHash() == blockHash) {
         {
+            // a producing delegate pushes the block at once, compact to the peers which rebuild it from their mempool
+            CSerializeDataPtr pBlockMessage, pCmpctBlockMessage;
             LOCK(cs_vNodes);
             for (auto pNode : vNodes) {
                 //p2p_xiaoyu_20191116
                 if (mining) {
-                    pNode->PushMessage(NetMsgType::BLOCK, block);
+                    if (pNode->fSupportsCompactBlocks) {
+                        if (!pCmpctBlockMessage)
+                            pCmpctBlockMessage = CNode::MakeMessage(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(block));
+                        pNode->PushSerializedMessage(pCmpctBlockMessage);
+                    } else {
+                        if (!pBlockMessage)
+                            pBlockMessage = CNode::MakeMessage(NetMsgType::BLOCK, block);
+                        pNode->PushSerializedMessage(pBlockMessage);
+                    }
                     continue;
                 }
                 if (chainActive.Height() > (pNode->nStartingHeight != -1 ? pNode->nStartingHeight - 2000 : 0))
@@ -2185,6 +2495,24 @@ void PushGetBlocksOnCondition(CNode *pNode, CBlockIndex *pIndexBegin, uint256 ha
     }
 }
 
+void PushGetHeaders(CNode *pNode, uint256 hashEnd) {
+    AssertLockHeld(cs_main);
+    CBlockLocator blockLocator = headersChain.GetLocator(chainActive);
+    // Filter out duplicate requests, the reply to the previous one is likely still on its way
+    int64_t now = GetTimeMillis();
+    if (blockLocator.vHave.front() == pNode->hashLastGetHeadersBegin && hashEnd == pNode->hashLastGetHeadersEnd &&
+        now - pNode->nLastGetHeadersTime < 2000) {
+        LogPrint(BCLog::NET, "filter the same getheaders locator from peer %s\n", pNode->addr.ToString());
+        return;
+    }
+    pNode->hashLastGetHeadersBegin = blockLocator.vHave.front();
+    pNode->hashLastGetHeadersEnd   = hashEnd;
+    pNode->nLastGetHeadersTime     = now;
+    pNode->PushMessage(NetMsgType::GETHEADERS, blockLocator, hashEnd);
+    LogPrint(BCLog::NET, "getheaders from peer %s, header_height=%d, hashEnd:%s\n", pNode->addr.ToString(),
+             max(headersChain.Height(), chainActive.Height()), hashEnd.GetHex());
+}
+
 bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBlockPos *dbp) {
     int64_t llBeginTime = GetTimeMillis();
     // LogPrint(BCLog::INFO, "ProcessBlock() enter:%lld\n", llBeginTime);
@@ -2243,7 +2571,14 @@ bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBl
                      pBlock->GetHeight(), pBlock->GetHash().GetHex(), success ? "keep" : "abandon",
                      chainActive.Height(), chainActive.Tip()->GetBlockHash().GetHex(), mapOrphanBlocksByPrev.size());
 
-            PushGetBlocksOnCondition(pFrom, chainActive.Tip(), GetOrphanRoot(blockHash));
+            // Blocks along the headers chain arrive out of order and are connected once their parents do
+            if (headersChain.Contains(blockHash))
+                return true;
+
+            if (pFrom->nVersion >= HEADERS_FIRST_VERSION)
+                PushGetHeaders(pFrom, uint256());
+            else
+                PushGetBlocksOnCondition(pFrom, chainActive.Tip(), GetOrphanRoot(blockHash));
         }
         return true;
     }
@@ -2258,19 +2593,32 @@ bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBl
     }
     // LogPrint(BCLog::INFO, "AcceptBlock() elapse time:%lld ms\n", GetTimeMillis() - llAcceptBlockTime);
 
-    // Recursively process any orphan blocks that depended on this one
+    // Recursively process any orphan blocks that depended on this one, verifying the signatures of the
+    // next one while the current one is connected
+    auto DecodeOrphanBlock = [](const COrphanBlock *pOrphan) {
+        auto pDecoded = std::make_shared<CBlock>();
+        CDataStream ss(pOrphan->vchBlock, SER_DISK, CLIENT_VERSION);
+        ss >> *pDecoded;
+        pDecoded->BuildMerkleTree();
+        return pDecoded;
+    };
+    CSignatureVerifyAhead verifyAhead;
+    std::shared_ptr<CBlock> pNextOrphan;
     vector<uint256> vWorkQueue;
     vWorkQueue.push_back(blockHash);
     for (uint32_t i = 0; i < vWorkQueue.size(); i++) {
         uint256 prevBlockHash = vWorkQueue[i];
         for (multimap<uint256, COrphanBlock *>::iterator mi = mapOrphanBlocksByPrev.lower_bound(prevBlockHash);
              mi != mapOrphanBlocksByPrev.upper_bound(prevBlockHash); ++mi) {
-            CBlock block;
-            {
-                CDataStream ss(mi->second->vchBlock, SER_DISK, CLIENT_VERSION);
-                ss >> block;
+            std::shared_ptr<CBlock> pOrphan = (pNextOrphan && pNextOrphan->GetHash() == mi->second->blockHash)
+                                                  ? pNextOrphan : DecodeOrphanBlock(mi->second);
+            CBlock &block = *pOrphan;
+            pNextOrphan.reset();
+            auto miNext = mapOrphanBlocksByPrev.find(mi->second->blockHash);
+            if (miNext != mapOrphanBlocksByPrev.end()) {
+                pNextOrphan = DecodeOrphanBlock(miNext->second);
+                verifyAhead.Start(*pNextOrphan, *pCdMan->pAccountCache);
             }
-            block.BuildMerkleTree();
             /**
              * Use a dummy CValidationState so someone can't setup nodes to counter-DoS based on orphan resolution
              * (that is, feeding people an invalid block based on LegitBlockX in order to get anyone relaying LegitBlockX banned)
@@ -2462,6 +2810,159 @@ bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth) {
     return true;
 }
 
+static boost::filesystem::path GetMemCacheSnapshotPath() { return GetDataDir() / "memcache.dat"; }
+
+// the memory caches are incomplete until LoadMemCaches() has filled them at startup
+static bool fMemCachesLoaded = false;
+
+bool WriteMemCacheSnapshot() {
+    const CBlockIndex *pTip = chainActive.Tip();
+    if (pTip == nullptr || !fMemCachesLoaded)
+        return true;
+
+    // serialize the caches of the tip, checksum data up to that point, then append csum
+    CDataStream ssCache(SER_DISK, CLIENT_VERSION);
+    ssCache << FLATDATA(SysCfg().MessageStart());
+    ssCache << pTip->GetBlockHash() << SysCfg().GetTxCacheHeight();
+    ssCache << *pCdMan->pTxCache << *pCdMan->pPpCache;
+    uint256 hash = Hash(ssCache.begin(), ssCache.end());
+    ssCache << hash;
+
+    boost::filesystem::path pathTmp = GetDataDir() / "memcache.dat.new";
+    FILE *file                      = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout               = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!fileout)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << ssCache;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout);
+    fileout.fclose();
+
+    if (!RenameOver(pathTmp, GetMemCacheSnapshotPath()))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    return true;
+}
+
+// Read the snapshot written by WriteMemCacheSnapshot(), only if it was taken at the current tip.
+static bool ReadMemCacheSnapshot(CTxMemCache &txCache, CPricePointMemCache &ppCache) {
+    boost::filesystem::path pathSnapshot = GetMemCacheSnapshotPath();
+    FILE *file                           = fopen(pathSnapshot.string().c_str(), "rb");
+    CAutoFile filein                     = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return false;
+
+    // read the whole snapshot in one go
+    int64_t dataSize = (int64_t)boost::filesystem::file_size(pathSnapshot) - (int64_t)sizeof(uint256);
+    if (dataSize <= 0)
+        return ERRORMSG("%s : Invalid snapshot size", __func__);
+
+    vector<uint8_t> vchData(dataSize);
+    uint256 hashIn;
+    try {
+        filein.read((char *)&vchData[0], dataSize);
+        filein >> hashIn;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    CDataStream ssCache(vchData, SER_DISK, CLIENT_VERSION);
+    if (hashIn != Hash(ssCache.begin(), ssCache.end()))
+        return ERRORMSG("%s : Checksum mismatch, data corrupted", __func__);
+
+    uint8_t pchMsgTmp[4];
+    uint256 tipHash;
+    int32_t txCacheHeight;
+    try {
+        ssCache >> FLATDATA(pchMsgTmp) >> tipHash >> txCacheHeight;
+        if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp)))
+            return ERRORMSG("%s : Invalid network magic number", __func__);
+
+        if (tipHash != chainActive.Tip()->GetBlockHash() || txCacheHeight != SysCfg().GetTxCacheHeight()) {
+            LogPrint(BCLog::INFO, "%s : Snapshot of block %s is stale\n", __func__, tipHash.GetHex());
+            return false;
+        }
+
+        ssCache >> txCache >> ppCache;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    return true;
+}
+
+// Read the blocks of the given indexes with several threads, the block files are opened per read.
+static bool ReadBlocksFromDisk(const vector<const CBlockIndex *> &indexes, vector<CBlock> &blocks) {
+    blocks.resize(indexes.size());
+    int32_t nThreads = std::min<int32_t>(MAX_BLOCK_READ_THREADS, boost::thread::hardware_concurrency());
+    nThreads         = std::max<int32_t>(1, std::min<int32_t>(nThreads, indexes.size()));
+
+    std::atomic<bool> fFailed(false);
+    auto readBlocks = [&](const int32_t first) {
+        for (size_t i = first; i < indexes.size() && !fFailed; i += nThreads) {
+            if (!ReadBlockFromDisk(indexes[i], blocks[i]))
+                fFailed = true;
+        }
+    };
+
+    boost::thread_group readThreads;
+    for (int32_t i = 1; i < nThreads; i++)
+        readThreads.create_thread(boost::bind<void>(readBlocks, i));
+    readBlocks(0);
+    readThreads.join_all();
+
+    return !fFailed;
+}
+
+bool LoadMemCaches() {
+    const CBlockIndex *pTip = chainActive.Tip();
+    fMemCachesLoaded        = true;
+    if (pTip == nullptr)
+        return true;
+
+    int64_t nStart = GetTimeMillis();
+    CTxMemCache txCache;
+    CPricePointMemCache ppCache;
+    if (ReadMemCacheSnapshot(txCache, ppCache)) {
+        *pCdMan->pTxCache = txCache;
+        *pCdMan->pPpCache = ppCache;
+        LogPrint(BCLog::INFO, "Loaded memory caches of block %d from snapshot, %llu txids (%dms)\n", pTip->height,
+                 pCdMan->pTxCache->GetSize(), GetTimeMillis() - nStart);
+        return true;
+    }
+
+    // The snapshot is missing or stale, rebuild the caches from the latest blocks.
+    // TODO: parameterize 11.
+    const int32_t txCacheHeight = SysCfg().GetTxCacheHeight();
+    const int32_t ppCacheHeight = 11;
+    vector<const CBlockIndex *> indexes;
+    for (const CBlockIndex *pIndex = pTip;
+         pIndex && (int32_t)indexes.size() < std::max(txCacheHeight, ppCacheHeight); pIndex = pIndex->pprev) {
+        indexes.push_back(pIndex);
+    }
+
+    vector<CBlock> blocks;
+    if (!ReadBlocksFromDisk(indexes, blocks))
+        return ERRORMSG("%s : Failed to read block from disk", __func__);
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if ((int32_t)i < txCacheHeight && !pCdMan->pTxCache->AddBlockTx(blocks[i]))
+            return ERRORMSG("%s : Failed to add block to transaction memory cache", __func__);
+
+        if ((int32_t)i < ppCacheHeight && !pCdMan->pPpCache->AddPriceByBlock(blocks[i]))
+            return ERRORMSG("%s : Failed to add block to price point memory cache", __func__);
+    }
+    LogPrint(BCLog::INFO, "Added the latest %d blocks to memory caches (%dms)\n", blocks.size(),
+             GetTimeMillis() - nStart);
+
+    return true;
+}
+
 void UnloadBlockIndex() {
     mapBlockIndex.clear();
     setBlockIndexValid.clear();
@@ -2571,71 +3072,166 @@ void PrintBlockTree() {
     }
 }
 
+// Scans a block file and deserializes its blocks on a thread of its own, up to MAX_BLOCKS_CONNECT_AHEAD blocks
+// ahead of their processing.
+class CBlockFileReader {
+private:
+    FILE *fileIn;
+    uint64_t nStartByte;  // the blocks before are indexed already
+    deque<pair<uint64_t, std::shared_ptr<CBlock>>> blocks;  // position in the file and block
+    bool fDone;
+    bool fStop;
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    boost::thread readThread;
+
+    bool Push(const uint64_t nBlockPos, const std::shared_ptr<CBlock> &pBlock) {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (!fStop && blocks.size() >= (size_t)MAX_BLOCKS_CONNECT_AHEAD)
+                cond.wait(lock);
+            if (fStop)
+                return false;
+
+            blocks.emplace_back(nBlockPos, pBlock);
+        }
+        cond.notify_all();
+        return true;
+    }
+
+    void Thread() {
+        try {
+            CBufferedFile blkdat(fileIn, 2 * MAX_BLOCK_SIZE, MAX_BLOCK_SIZE + 8, SER_DISK, CLIENT_VERSION);
+            if (nStartByte > 0)
+                blkdat.Seek(nStartByte);
+
+            uint64_t nRewind = blkdat.GetPos();
+            while (blkdat.good() && !blkdat.eof()) {
+                blkdat.SetPos(nRewind);
+                nRewind++;          // start one byte further next time, in case of failure
+                blkdat.SetLimit();  // remove former limit
+                uint32_t nSize = 0;
+                try {
+                    // locate a header
+                    uint8_t buf[MESSAGE_START_SIZE];
+                    blkdat.FindByte(SysCfg().MessageStart()[0]);
+                    nRewind = blkdat.GetPos() + 1;
+                    blkdat >> FLATDATA(buf);
+                    if (memcmp(buf, SysCfg().MessageStart(), MESSAGE_START_SIZE))
+                        continue;
+                    // read size
+                    blkdat >> nSize;
+                    if (nSize < 80 || nSize > MAX_BLOCK_SIZE)
+                        continue;
+                } catch (std::exception &e) {
+                    // no valid block header found; don't complain
+                    break;
+                }
+                try {
+                    // read block
+                    uint64_t nBlockPos = blkdat.GetPos();
+                    blkdat.SetLimit(nBlockPos + nSize);
+                    auto pBlock = std::make_shared<CBlock>();
+                    blkdat >> *pBlock;
+                    nRewind = blkdat.GetPos();
+
+                    if (nBlockPos >= nStartByte) {
+                        pBlock->BuildMerkleTree();
+                        if (!Push(nBlockPos, pBlock))
+                            break;
+                    }
+                } catch (std::exception &e) {
+                    LogPrint(BCLog::INFO, "%s : Deserialize or I/O error - %s\n", __func__, e.what());
+                }
+            }
+        } catch (runtime_error &e) {
+            AbortNode(_("Error: system error: ") + e.what());
+        }
+
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fDone = true;
+        }
+        cond.notify_all();
+    }
+
+public:
+    CBlockFileReader(FILE *fileInIn, const uint64_t nStartByteIn)
+        : fileIn(fileInIn), nStartByte(nStartByteIn), fDone(false), fStop(false) {
+        readThread = boost::thread(&CBlockFileReader::Thread, this);
+    }
+
+    ~CBlockFileReader() {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fStop = true;
+        }
+        cond.notify_all();
+        readThread.join();
+    }
+
+    // Pops the next block of the file, returns false at the end of the file.
+    bool Next(uint64_t &nBlockPos, std::shared_ptr<CBlock> &pBlock) {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (!fDone && blocks.empty())
+                cond.wait(lock);
+            if (blocks.empty())
+                return false;
+
+            nBlockPos = blocks.front().first;
+            pBlock    = std::move(blocks.front().second);
+            blocks.pop_front();
+        }
+        cond.notify_all();
+        return true;
+    }
+
+    // Returns the block after the one last returned by Next() if it has been read already.
+    std::shared_ptr<CBlock> PeekNext() {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        return blocks.empty() ? nullptr : blocks.front().second;
+    }
+};
+
 bool LoadExternalBlockFile(FILE *fileIn, CDiskBlockPos *dbp) {
     int64_t nStart = GetTimeMillis();
     int32_t nLoaded    = 0;
-    try {
-        CBufferedFile blkdat(fileIn, 2 * MAX_BLOCK_SIZE, MAX_BLOCK_SIZE + 8, SER_DISK, CLIENT_VERSION);
-        uint64_t nStartByte = 0;
-        if (dbp) {
-            // (try to) skip already indexed part
-            CBlockFileInfo info;
-            if (pCdMan->pBlockIndexDb->ReadBlockFileInfo(dbp->nFile, info)) {
-                nStartByte = info.nSize;
-                blkdat.Seek(info.nSize);
-            }
-        }
-        uint64_t nRewind = blkdat.GetPos();
-        while (blkdat.good() && !blkdat.eof()) {
+    uint64_t nStartByte = 0;
+    if (dbp) {
+        // (try to) skip already indexed part
+        CBlockFileInfo info;
+        if (pCdMan->pBlockIndexDb->ReadBlockFileInfo(dbp->nFile, info))
+            nStartByte = info.nSize;
+    }
+
+    {
+        // The file is read ahead, and the signatures of the next block are verified while the current
+        // one is processed.
+        CBlockFileReader reader(fileIn, nStartByte);
+        CSignatureVerifyAhead verifyAhead;
+        uint64_t nBlockPos = 0;
+        std::shared_ptr<CBlock> pBlock;
+        while (reader.Next(nBlockPos, pBlock)) {
             boost::this_thread::interruption_point();
 
-            blkdat.SetPos(nRewind);
-            nRewind++;          // start one byte further next time, in case of failure
-            blkdat.SetLimit();  // remove former limit
-            uint32_t nSize = 0;
-            try {
-                // locate a header
-                uint8_t buf[MESSAGE_START_SIZE];
-                blkdat.FindByte(SysCfg().MessageStart()[0]);
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> FLATDATA(buf);
-                if (memcmp(buf, SysCfg().MessageStart(), MESSAGE_START_SIZE))
-                    continue;
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SIZE)
-                    continue;
-            } catch (std::exception &e) {
-                // no valid block header found; don't complain
+            // process block
+            LOCK(cs_main);
+            std::shared_ptr<CBlock> pNextBlock = reader.PeekNext();
+            if (pNextBlock)
+                verifyAhead.Start(*pNextBlock, *pCdMan->pAccountCache);
+
+            if (dbp)
+                dbp->nPos = nBlockPos;
+            CValidationState state;
+            if (ProcessBlock(state, nullptr, pBlock.get(), dbp))
+                nLoaded++;
+            if (state.IsError())
                 break;
-            }
-            try {
-                // read block
-                uint64_t nBlockPos = blkdat.GetPos();
-                blkdat.SetLimit(nBlockPos + nSize);
-                CBlock block;
-                blkdat >> block;
-                nRewind = blkdat.GetPos();
-
-                // process block
-                if (nBlockPos >= nStartByte) {
-                    LOCK(cs_main);
-                    if (dbp)
-                        dbp->nPos = nBlockPos;
-                    CValidationState state;
-                    if (ProcessBlock(state, nullptr, &block, dbp))
-                        nLoaded++;
-                    if (state.IsError())
-                        break;
-                }
-            } catch (std::exception &e) {
-                LogPrint(BCLog::INFO, "%s : Deserialize or I/O error - %s\n", __func__, e.what());
-            }
         }
-        fclose(fileIn);
-    } catch (runtime_error &e) {
-        AbortNode(_("Error: system error: ") + e.what());
     }
+    fclose(fileIn);
+
     if (nLoaded > 0)
         LogPrint(BCLog::INFO, "Loaded %i blocks from external file in %dms\n", nLoaded, GetTimeMillis() - nStart);
     return nLoaded > 0;
@@ -36,12 +36,15 @@
 //#include "tx/txserializer.h"
 
 class CBloomFilter;
+class CBlockUndo;
 class CChain;
 class CInv;
 
 extern CCriticalSection cs_main;
 /** The currently-connected chain of blocks. */
 extern CChain chainActive;
+/** The best headers chain ahead of chainActive, downloaded in parallel during headers-first sync. */
+extern CHeadersChain headersChain;
 extern CSignatureCache signatureCache;
 
 extern CTxMemPool mempool;
@@ -54,6 +57,7 @@ extern bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block) ;
 extern bool mining;     // could be changed due to vote change
 extern CKeyID minerKeyId;  // miner accout keyId
 extern CKeyID nodeKeyId;   // first keyId of the node
+extern int32_t nScriptCheckThreads;
 
 class CValidationState;
 class CWalletInterface;
@@ -95,6 +99,10 @@ bool CheckDiskSpace(uint64_t nAdditionalBytes = 0);
 
 /** Verify consistency of the block and coin databases */
 bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth);
+/** Load the transaction and price point memory caches of the active tip, from the snapshot if it is up to date */
+bool LoadMemCaches();
+/** Write a snapshot of the transaction and price point memory caches of the active tip */
+bool WriteMemCacheSnapshot();
 
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
@@ -115,9 +123,54 @@ void Misbehaving(NodeId nodeid, int32_t howmuch);
 
 bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signature, const CPubKey &pubKey);
 
+/**
+ * Closure representing one signature verification, run by the script check threads.
+ * A verified signature is stored in the signature cache, so the serial CheckTx() pass
+ * of the same tx is answered without touching secp256k1.
+ */
+class CSignatureCheck {
+private:
+    uint256 sigHash;
+    std::vector<uint8_t> signature;
+    CPubKey pubKey;
+
+public:
+    CSignatureCheck() {}
+    CSignatureCheck(const uint256 &sigHashIn, const std::vector<uint8_t> &signatureIn, const CPubKey &pubKeyIn)
+        : sigHash(sigHashIn), signature(signatureIn), pubKey(pubKeyIn) {}
+
+    bool operator()();
+
+    void swap(CSignatureCheck &check) {
+        std::swap(sigHash, check.sigHash);
+        signature.swap(check.signature);
+        std::swap(pubKey, check.pubKey);
+    }
+};
+
+/**
+ * Verify the signatures of all block transactions in parallel on the script check threads
+ * before the serial CheckTx()/ExecuteTx() pass. Only warms the signature cache: a signature
+ * which fails here is verified again, and rejected, by the tx's own CheckTx().
+ */
+void PreVerifyBlockSignatures(const CBlock &block, CCacheWrapper &cw);
+
+/**
+ * Warm the signature cache for txs about to be accepted to the mempool, the same way as
+ * PreVerifyBlockSignatures(). Holds cs_main only to resolve the signers' pubkeys.
+ */
+void PreVerifyTxSignatures(const vector<std::shared_ptr<CBaseTx>> &vptx);
+
 /** (try to) add transaction to memory pool **/
 bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
                         bool fLimitFree, bool fRejectInsaneFee = false);
+/**
+ * Accept a batch of txs to the memory pool in order, executing them in one cache layer over the mempool
+ * cache and rolling back only the txs which fail. Returns the number of accepted txs; states and accepted
+ * hold the result of each tx. The signatures should be verified beforehand by PreVerifyTxSignatures().
+ */
+uint32_t AcceptTxBatchToMemoryPool(CTxMemPool &pool, const vector<std::shared_ptr<CBaseTx>> &vptx,
+                                   vector<CValidationState> &states, vector<bool> &accepted, bool fLimitFree);
 
 struct CNodeStateStats {
     int32_t nMisbehavior;
@@ -195,6 +248,8 @@ extern CCacheDBManager *pCdMan;
 extern int32_t nSyncTipHeight;
 extern std::tuple<bool, boost::thread *> RunCoin(int32_t argc, char *argv[]);
 extern string publicIp;
+/** The SHA-256 implementation picked by SHA256AutoDetect() at startup */
+extern string sha256Impl;
 
 bool EraseBlockIndexFromSet(CBlockIndex *pIndex);
 
@@ -217,7 +272,8 @@ protected:
  *  of problems. Note that in any case, coins may be modified. */
 bool DisconnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool *pfClean = nullptr);
 // Apply the effects of this block (with given index) on the UTXO set represented by coins
-bool ConnectBlock   (CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool fJustCheck = false);
+bool ConnectBlock   (CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValidationState &state, bool fJustCheck = false,
+                     CBlockUndo *pBlockUndoOut = nullptr);
 
 // Add this block to the block index, and if necessary, switch the active block chain to this
 bool AddToBlockIndex(CBlock &block, CValidationState &state, const CDiskBlockPos &pos);
@@ -250,6 +306,8 @@ void UnloadBlockIndex();
 void PushGetBlocks(CNode *pNode, CBlockIndex *pindexBegin, uint256 hashEnd);
 /** Push getblocks request with different filtering strategies */
 void PushGetBlocksOnCondition(CNode *pNode, CBlockIndex *pindexBegin, uint256 hashEnd);
+/** Push getheaders request from the best known header */
+void PushGetHeaders(CNode *pNode, uint256 hashEnd);
 /** Process an incoming block */
 bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBlockPos *dbp = nullptr);
 /** Print the loaded block tree */
@@ -257,8 +315,9 @@ void PrintBlockTree();
 
 void UpdateTime(CBlockHeader &block, const CBlockIndex *pIndexPrev);
 
-/** Find the best known block, and make it the tip of the block chain */
-bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex = nullptr);
+/** Find the best known block, and make it the tip of the block chain. pNewBlock is the block of pNewIndex if it
+ *  is in memory already, it is not read back from disk then */
+bool ActivateBestChain(CValidationState &state, CBlockIndex* pNewIndex = nullptr, CBlock *pNewBlock = nullptr);
 
 /** Remove invalidity status from a block and its descendants. */
 bool ReconsiderBlock(CValidationState &state, CBlockIndex *pIndex);
@@ -82,25 +82,17 @@ uint32_t GetElementForBurn(CBlockIndex *pIndex) {
     return newFuelRate;
 }
 
-// Sort transactions by priority and fee to decide priority orders to process transactions.
-void GetPriorityTx(int32_t height, set<TxPriority> &txPriorities, const int32_t nFuelRate) {
-    static TokenSymbol feeSymbol;
-    static uint64_t fee    = 0;
-    static uint32_t txSize = 0;
-    static double feePerKb = 0;
-    static double priority = 0;
-
-    for (map<uint256, CTxMemPoolEntry>::iterator mi = mempool.memPoolTxs.begin(); mi != mempool.memPoolTxs.end(); ++mi) {
-        CBaseTx *pBaseTx = mi->second.GetTransaction().get();
-        if (!pBaseTx->IsBlockRewardTx() && !pCdMan->pTxCache->HaveTx(pBaseTx->GetHash())) {
-            feeSymbol = std::get<0>(mi->second.GetFees());
-            fee       = std::get<1>(mi->second.GetFees());
-            txSize    = mi->second.GetTxSize();
-            feePerKb  = double(fee - pBaseTx->GetFuel(height, nFuelRate)) / txSize * 1000.0;
-            priority  = mi->second.GetPriority();
-
-            txPriorities.emplace(TxPriority(priority, feePerKb, mi->second.GetTransaction()));
-        }
+// Collect transactions in priority orders to process transactions, the highest first. The mempool keeps
+// them sorted by priority and fee as they arrive, so no sorting is needed here.
+void GetPriorityTx(vector<TxPriority> &txPriorities) {
+    AssertLockHeld(mempool.cs);
+
+    const auto &priorityIndex = mempool.memPoolTxs.get<priority_index>();
+    txPriorities.reserve(priorityIndex.size() + 1);
+    for (auto it = priorityIndex.rbegin(); it != priorityIndex.rend(); ++it) {
+        const auto &spTx = it->GetTransaction();
+        if (!spTx->IsBlockRewardTx() && !pCdMan->pTxCache->HaveTx(it->GetHash()))
+            txPriorities.emplace_back(it->GetPriority(), it->GetFeePerKb(), spTx);
     }
 }
 
@@ -176,6 +168,28 @@ void ShuffleDelegates(const int32_t curHeight, const int64_t blockTime, VoteDele
 }
 
 
+bool VerifyHeaderSignature(const CBlock &header, const VoteDelegateVector &activeDelegates, CAccountDBCache &accountCache) {
+    if (activeDelegates.empty())
+        return false;
+
+    VoteDelegateVector delegates = activeDelegates;
+    ShuffleDelegates(header.GetHeight(), header.GetTime(), delegates);
+
+    VoteDelegate curDelegate;
+    CAccount delegateAccount;
+    if (!GetCurrentDelegate(header.GetTime(), header.GetHeight(), delegates, curDelegate) ||
+        !accountCache.GetAccount(curDelegate.regid, delegateAccount))
+        return false;
+
+    const auto &blockHash      = header.GetHash();
+    const auto &blockSignature = header.GetSignature();
+    if (blockSignature.size() == 0 || blockSignature.size() > MAX_SIGNATURE_SIZE)
+        return false;
+
+    return VerifySignature(blockHash, blockSignature, delegateAccount.owner_pubkey) ||
+           VerifySignature(blockHash, blockSignature, delegateAccount.miner_pubkey);
+}
+
 bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx, VoteDelegate &curDelegateOut, uint32_t& totalDelegateNumOut) {
     uint32_t maxNonce = SysCfg().GetBlockMaxNonce();
 
@@ -313,15 +327,15 @@ static bool CreateNewBlockPreStableCoinRelease(CCacheWrapper &cwIn, std::unique_
         uint64_t totalFuel      = 0;
         uint64_t reward         = 0;
 
-        // Calculate && sort transactions from memory pool.
-        set<TxPriority> txPriorities;
-        GetPriorityTx(height, txPriorities, fuelRate);
+        // Get transactions sorted by priority from memory pool.
+        vector<TxPriority> txPriorities;
+        GetPriorityTx(txPriorities);
 
         LogPrint(BCLog::MINER, "CreateNewBlockPreStableCoinRelease() : got %lu transaction(s) sorted by priority rules\n",
                  txPriorities.size());
 
         // Collect transactions into the block.
-        for (auto itor = txPriorities.rbegin(); itor != txPriorities.rend(); ++itor) {
+        for (auto itor = txPriorities.begin(); itor != txPriorities.end(); ++itor) {
             CBaseTx *pBaseTx = itor->baseTx.get();
 
             uint32_t txSize = pBaseTx->GetSerializeSize(SER_NETWORK, PROTOCOL_VERSION);
@@ -445,18 +459,21 @@ static bool CreateNewBlockStableCoinRelease(int64_t startMiningMs, CCacheWrapper
         uint64_t totalFuel                 = 0;
         map<TokenSymbol, uint64_t> rewards = {{SYMB::WICC, 0}, {SYMB::WUSD, 0}};
 
-        // Calculate && sort transactions from memory pool.
-        set<TxPriority> txPriorities;
-        GetPriorityTx(height, txPriorities, fuelRate);
+        // Get transactions sorted by priority from memory pool.
+        vector<TxPriority> txPriorities;
+        GetPriorityTx(txPriorities);
 
-        // Push block price median transaction into queue.
-        txPriorities.emplace(TxPriority(PRICE_MEDIAN_TRANSACTION_PRIORITY, 0, std::make_shared<CBlockPriceMedianTx>(height)));
+        // Push block price median transaction into queue, behind the txs of higher priority.
+        TxPriority medianTx(PRICE_MEDIAN_TRANSACTION_PRIORITY, 0, std::make_shared<CBlockPriceMedianTx>(height));
+        auto itMedian = std::upper_bound(txPriorities.begin(), txPriorities.end(), medianTx,
+                                         [](const TxPriority &a, const TxPriority &b) { return b < a; });
+        txPriorities.insert(itMedian, medianTx);
 
         LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : got %lu transaction(s) sorted by priority rules\n",
                  txPriorities.size());
 
         // Collect transactions into the block.
-        for (auto itor = txPriorities.rbegin(); itor != txPriorities.rend(); ++itor) {
+        for (auto itor = txPriorities.begin(); itor != txPriorities.end(); ++itor) {
 
             if (!CheckPackBlockTime(startMiningMs, height)) {
                 LogPrint(BCLog::MINER, "%s() : no time left to pack more tx, ignore! height=%d, start_ms=%lld, tx_count=%u\n",
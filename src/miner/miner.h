@@ -16,6 +16,7 @@
 #include "entities/key.h"
 #include "commons/uint256.h"
 #include "tx/tx.h"
+#include "tx/txmempool.h"
 
 class CBlock;
 class CBlockIndex;
@@ -48,15 +49,8 @@ struct TxPriority {
         : priority(priorityIn), feePerKb(feePerKbIn), baseTx(baseTxIn) {}
 
     bool operator<(const TxPriority &other) const {
-        if (fabs(this->priority - other.priority) <= 1000) {
-            if (fabs(this->feePerKb < other.feePerKb) <= 1e-8) {
-                return this->baseTx->GetHash() < other.baseTx->GetHash();
-            } else {
-                return this->feePerKb < other.feePerKb;
-            }
-        } else {
-            return this->priority < other.priority;
-        }
+        return ComparePackPriority(priority, feePerKb, baseTx->GetHash(), other.priority, other.feePerKb,
+                                   other.baseTx->GetHash());
     }
 };
 
@@ -87,13 +81,16 @@ void GenerateProduceBlockThread(bool fGenerate, CWallet *pWallet, int32_t nThrea
 
 bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx, VoteDelegate &curDelegateOut, uint32_t& totalDelegateNumOut);
 
+/** Verify the signature of a block header by the delegate of its slot among the given active delegates */
+bool VerifyHeaderSignature(const CBlock &header, const VoteDelegateVector &activeDelegates, CAccountDBCache &accountCache);
+
 /** Check mined block */
 bool CheckWork(CBlock *pBlock);
 
 /** Get burn element */
 uint32_t GetElementForBurn(CBlockIndex *pIndex);
 
-void GetPriorityTx(vector<TxPriority> &vecPriority, int32_t nFuelRate);
+void GetPriorityTx(vector<TxPriority> &txPriorities);
 
 void ShuffleDelegates(const int32_t nCurHeight, const int64_t blockTime,
         VoteDelegateVector &delegates);
@@ -22,6 +22,11 @@
 #include <fcntl.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -33,10 +38,12 @@
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
 
+#include <atomic>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 
@@ -467,6 +474,8 @@ CNode* ConnectNode(CAddress addrConnect, const char* pszDest) {
             LOCK(cs_vNodes);
             vNodes.push_back(pNode);
         }
+        // let the socket handler register the new socket
+        WakeSocketHandler();
 
         pNode->nTimeConnected = GetTime();
         return pNode;
@@ -478,67 +487,391 @@ CNode* ConnectNode(CAddress addrConnect, const char* pszDest) {
 
 static list<CNode*> vNodesDisconnected;
 
+#ifdef USE_EPOLL
+static int32_t hEpoll       = -1;
+static int32_t hWakeupEvent = -1;
+// set while a wakeup is pending so that concurrent callers write the eventfd only once
+static std::atomic<bool> fSocketHandlerWakeup(false);
+#endif
+
+static boost::mutex csMessageHandlerWakeup;
+static boost::condition_variable condMessageHandlerWakeup;
+static bool fMessageHandlerWakeup = false;
+
+void WakeSocketHandler() {
+#ifdef USE_EPOLL
+    if (hWakeupEvent == -1 || fSocketHandlerWakeup.exchange(true))
+        return;
+
+    uint64_t nValue = 1;
+    if (write(hWakeupEvent, &nValue, sizeof(nValue)) != sizeof(nValue))
+        LogPrint(BCLog::INFO, "socket handler wakeup failed: %s\n", NetworkErrorString(errno));
+#endif
+}
+
+void WakeMessageHandler() {
+    {
+        boost::unique_lock<boost::mutex> lock(csMessageHandlerWakeup);
+        fMessageHandlerWakeup = true;
+    }
+    condMessageHandlerWakeup.notify_one();
+}
+
+static void DisconnectNodes(uint32_t& nPrevNodeCount) {
+    {
+        LOCK(cs_vNodes);
+        // Disconnect unused nodes
+        vector<CNode*> vNodesCopy = vNodes;
+        for (auto pNode : vNodesCopy) {
+            if (pNode->fDisconnect || (pNode->GetRefCount() <= 0 && pNode->vRecvMsg.empty() &&
+                                       pNode->nSendSize == 0 && pNode->ssSend.empty())) {
+                // remove from vNodes
+                vNodes.erase(remove(vNodes.begin(), vNodes.end(), pNode), vNodes.end());
+
+                // release outbound grant (if any)
+                pNode->grantOutbound.Release();
+
+                // close socket and cleanup
+                pNode->CloseSocketDisconnect();
+                pNode->Cleanup();
+
+                // hold in disconnected pool until all refs are released
+                if (pNode->fNetworkNode || pNode->fInbound)
+                    pNode->Release();
+                vNodesDisconnected.push_back(pNode);
+            }
+        }
+    }
+    {
+        // Delete disconnected nodes
+        list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
+        for (auto pNode : vNodesDisconnectedCopy) {
+            // wait until threads are done using it
+            if (pNode->GetRefCount() <= 0) {
+                bool fDelete = false;
+                {
+                    TRY_LOCK(pNode->cs_vSend, lockSend);
+                    if (lockSend) {
+                        TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
+                        if (lockRecv) {
+                            TRY_LOCK(pNode->cs_inventory, lockInv);
+                            if (lockInv)
+                                fDelete = true;
+                        }
+                    }
+                }
+                if (fDelete) {
+                    vNodesDisconnected.remove(pNode);
+                    delete pNode;
+                }
+            }
+        }
+    }
+    if (vNodes.size() != nPrevNodeCount) {
+        LogPrint(BCLog::INFO, "Connections number changed, %d -> %d\n", nPrevNodeCount, vNodes.size());
+
+        nPrevNodeCount = vNodes.size();
+    }
+}
+
+// Accept one pending connection, returns false once the listen socket has nothing left to accept
+static bool AcceptConnection(SOCKET hListenSocket) {
+    struct sockaddr_storage sockaddr;
+    socklen_t len  = sizeof(sockaddr);
+    SOCKET hSocket = accept(hListenSocket, (struct sockaddr*)&sockaddr, &len);
+    CAddress addr;
+    int32_t nInbound = 0;
+
+    if (hSocket == INVALID_SOCKET) {
+        int32_t nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK)
+            LogPrint(BCLog::INFO, "socket error accept failed: %s\n", NetworkErrorString(nErr));
+        return false;
+    }
+
+    if (!addr.SetSockAddr((const struct sockaddr*)&sockaddr))
+        LogPrint(BCLog::INFO, "Warning: Unknown socket family\n");
+
+    {
+        LOCK(cs_vNodes);
+        for (auto pNode : vNodes)
+            if (pNode->fInbound)
+                nInbound++;
+    }
+
+    if (nInbound >= nMaxConnections - MAX_OUTBOUND_CONNECTIONS) {
+        closesocket(hSocket);
+    } else if (CNode::IsBanned(addr)) {
+        LogPrint(BCLog::INFO, "connection from %s dropped (banned)\n", addr.ToString());
+        closesocket(hSocket);
+    } else {
+        LogPrint(BCLog::NET, "accepted connection %s\n", addr.ToString());
+        CNode* pNode = new CNode(hSocket, addr, "", true);
+        pNode->AddRef();
+        {
+            LOCK(cs_vNodes);
+            vNodes.push_back(pNode);
+        }
+    }
+    return true;
+}
+
+// Whether the receive buffer of the node has room for more data, requires cs_vRecvMsg
+static bool CanReceiveData(CNode* pNode) {
+    return pNode->vRecvMsg.empty() || !pNode->vRecvMsg.front().complete() ||
+           pNode->GetTotalRecvSize() <= ReceiveFloodSize();
+}
+
+// Read once from the socket of the node, requires cs_vRecvMsg.
+// Returns false when the socket has no more data for now or was closed.
+static bool SocketRecvData(CNode* pNode) {
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    int32_t nBytes = recv(pNode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    if (nBytes > 0) {
+        if (!pNode->ReceiveMsgBytes(pchBuf, nBytes))
+            pNode->CloseSocketDisconnect();
+        pNode->nLastRecv = GetTime();
+        pNode->nRecvBytes += nBytes;
+        pNode->RecordBytesRecv(nBytes);
+
+        if (!pNode->vRecvMsg.empty() && pNode->vRecvMsg.front().complete())
+            WakeMessageHandler();
+
+        return true;
+    } else if (nBytes == 0) {
+        // socket closed gracefully
+        if (!pNode->fDisconnect)
+            LogPrint(BCLog::NET, "socket[%s] closed\n", pNode->addr.ToString());
+        pNode->CloseSocketDisconnect();
+    } else if (nBytes < 0) {
+        // error
+        int32_t nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
+            if (!pNode->fDisconnect)
+                LogPrint(BCLog::INFO, "socket[%s] recv error %s\n", pNode->addr.ToString(), NetworkErrorString(nErr));
+            pNode->CloseSocketDisconnect();
+        }
+    }
+    return false;
+}
+
+static void InactivityCheck(CNode* pNode) {
+    if (pNode->vSendMsg.empty())
+        pNode->nLastSendEmpty = GetTime();
+
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime - pNode->nTimeConnected > DEFAULT_PEER_CONNECT_TIMEOUT)
+    {
+        if (pNode->nLastRecv == 0 || pNode->nLastSend == 0)
+        {
+            LogPrint(BCLog::NET, "socket no message in first %i seconds, %d %d from %d\n", DEFAULT_PEER_CONNECT_TIMEOUT, pNode->nLastRecv != 0, pNode->nLastSend != 0, pNode->GetId());
+            pNode->fDisconnect = true;
+        }
+        else if (nTime - pNode->nLastSend > TIMEOUT_INTERVAL)
+        {
+            LogPrint(BCLog::NET, "socket sending timeout: %is\n", nTime - pNode->nLastSend);
+            pNode->fDisconnect = true;
+        }
+        else if (nTime - pNode->nLastRecv > TIMEOUT_INTERVAL )
+        {
+            LogPrint(BCLog::NET, "socket receive timeout: %is\n", nTime - pNode->nLastRecv);
+            pNode->fDisconnect = true;
+        }
+        else if (pNode->nPingNonceSent && pNode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
+        {
+            LogPrint(BCLog::NET, "ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pNode->nPingUsecStart));
+            pNode->fDisconnect = true;
+        }
+        else if (!pNode->fSuccessfullyConnected)
+        {
+            LogPrint(BCLog::NET, "version handshake timeout from %d\n", pNode->GetId());
+            pNode->fDisconnect = true;
+        }
+    }
+}
+
+static vector<CNode*> CopyNodes() {
+    LOCK(cs_vNodes);
+    vector<CNode*> vNodesCopy = vNodes;
+    for (auto pNode : vNodesCopy)
+        pNode->AddRef();
+
+    return vNodesCopy;
+}
+
+static void ReleaseNodes(const vector<CNode*>& vNodesCopy) {
+    LOCK(cs_vNodes);
+    for (auto pNode : vNodesCopy)
+        pNode->Release();
+}
+
+#ifdef USE_EPOLL
+static bool InitSocketEvents() {
+    hEpoll = epoll_create1(EPOLL_CLOEXEC);
+    if (hEpoll == -1)
+        return ERRORMSG("InitSocketEvents() : epoll_create1 failed: %s", NetworkErrorString(errno));
+
+    hWakeupEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (hWakeupEvent == -1)
+        return ERRORMSG("InitSocketEvents() : eventfd failed: %s", NetworkErrorString(errno));
+
+    struct epoll_event event;
+    event.events  = EPOLLIN;
+    event.data.fd = hWakeupEvent;
+    if (epoll_ctl(hEpoll, EPOLL_CTL_ADD, hWakeupEvent, &event) == -1)
+        return ERRORMSG("InitSocketEvents() : register wakeup event failed: %s", NetworkErrorString(errno));
+
+    // listen sockets are edge-triggered as well, every readiness event is drained by accepting until EWOULDBLOCK
+    for (auto hListenSocket : vhListenSocket) {
+        event.events  = EPOLLIN | EPOLLET;
+        event.data.fd = hListenSocket;
+        if (epoll_ctl(hEpoll, EPOLL_CTL_ADD, hListenSocket, &event) == -1)
+            return ERRORMSG("InitSocketEvents() : register listen socket failed: %s", NetworkErrorString(errno));
+    }
+
+    return true;
+}
+
+// Sockets are registered edge-triggered: epoll only reports transitions to readable or writable, so the
+// node keeps fSocketReadable and fSocketWritable set until recv or send would block. A closed socket
+// is dropped from the epoll set by the kernel.
 void ThreadSocketHandler() {
+    if (hEpoll == -1) {
+        LogPrint(BCLog::ERROR, "socket handler stopped, no socket events\n");
+        return;
+    }
+
     uint32_t nPrevNodeCount = 0;
+    vector<struct epoll_event> vEvents(SOCKET_EVENTS_BATCH_SIZE);
+    int32_t nTimeout = SOCKET_EVENTS_TIMEOUT;
     while (true) {
-        //
-        // Disconnect nodes
-        //
-        {
-            LOCK(cs_vNodes);
-            // Disconnect unused nodes
-            vector<CNode*> vNodesCopy = vNodes;
-            for (auto pNode : vNodesCopy) {
-                if (pNode->fDisconnect || (pNode->GetRefCount() <= 0 && pNode->vRecvMsg.empty() &&
-                                           pNode->nSendSize == 0 && pNode->ssSend.empty())) {
-                    // remove from vNodes
-                    vNodes.erase(remove(vNodes.begin(), vNodes.end(), pNode), vNodes.end());
+        DisconnectNodes(nPrevNodeCount);
 
-                    // release outbound grant (if any)
-                    pNode->grantOutbound.Release();
+        vector<CNode*> vNodesCopy = CopyNodes();
+        unordered_map<SOCKET, CNode*> mapSocketNodes;
+        mapSocketNodes.reserve(vNodesCopy.size());
+        for (auto pNode : vNodesCopy) {
+            if (pNode->hSocket == INVALID_SOCKET)
+                continue;
 
-                    // close socket and cleanup
+            if (!pNode->fSocketRegistered) {
+                struct epoll_event event;
+                event.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                event.data.fd = pNode->hSocket;
+                if (epoll_ctl(hEpoll, EPOLL_CTL_ADD, pNode->hSocket, &event) == -1) {
+                    LogPrint(BCLog::INFO, "socket[%s] register failed: %s\n", pNode->addr.ToString(), NetworkErrorString(errno));
                     pNode->CloseSocketDisconnect();
-                    pNode->Cleanup();
-
-                    // hold in disconnected pool until all refs are released
-                    if (pNode->fNetworkNode || pNode->fInbound)
-                        pNode->Release();
-                    vNodesDisconnected.push_back(pNode);
+                    continue;
                 }
+                // pick up data that arrived before the registration
+                pNode->fSocketRegistered = true;
+                pNode->fSocketReadable   = true;
+                pNode->fSocketWritable   = true;
             }
+            mapSocketNodes[pNode->hSocket] = pNode;
         }
-        {
-            // Delete disconnected nodes
-            list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
-            for (auto pNode : vNodesDisconnectedCopy) {
-                // wait until threads are done using it
-                if (pNode->GetRefCount() <= 0) {
-                    bool fDelete = false;
-                    {
-                        TRY_LOCK(pNode->cs_vSend, lockSend);
-                        if (lockSend) {
-                            TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                            if (lockRecv) {
-                                TRY_LOCK(pNode->cs_inventory, lockInv);
-                                if (lockInv)
-                                    fDelete = true;
-                            }
+
+        int32_t nEvents = epoll_wait(hEpoll, vEvents.data(), vEvents.size(), nTimeout);
+        boost::this_thread::interruption_point();
+
+        if (nEvents == -1) {
+            if (errno != EINTR)
+                LogPrint(BCLog::INFO, "socket epoll_wait error %s\n", NetworkErrorString(errno));
+            nEvents = 0;
+        }
+
+        // reset before servicing, a wakeup requested from now on is seen by the next epoll_wait()
+        fSocketHandlerWakeup = false;
+
+        for (int32_t i = 0; i < nEvents; i++) {
+            const struct epoll_event& event = vEvents[i];
+            if (event.data.fd == hWakeupEvent) {
+                uint64_t nValue;
+                while (read(hWakeupEvent, &nValue, sizeof(nValue)) > 0) {}
+                continue;
+            }
+
+            if (find(vhListenSocket.begin(), vhListenSocket.end(), (SOCKET)event.data.fd) != vhListenSocket.end()) {
+                while (AcceptConnection(event.data.fd)) {}
+                continue;
+            }
+
+            auto it = mapSocketNodes.find(event.data.fd);
+            if (it == mapSocketNodes.end())
+                continue;
+
+            if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                it->second->fSocketReadable = true;
+            if (event.events & EPOLLOUT)
+                it->second->fSocketWritable = true;
+        }
+
+        //
+        // Service each socket
+        //
+        bool fMoreWork  = false;
+        bool fRecvFlood = false;
+        for (auto pNode : vNodesCopy) {
+            boost::this_thread::interruption_point();
+
+            //
+            // Send
+            //
+            bool fSendPending = false;
+            if (pNode->hSocket != INVALID_SOCKET && pNode->fSocketWritable) {
+                TRY_LOCK(pNode->cs_vSend, lockSend);
+                if (lockSend) {
+                    if (!pNode->vSendMsg.empty()) {
+                        pNode->SocketSendData();
+                        // the socket buffer is full, wait for EPOLLOUT
+                        if (!pNode->vSendMsg.empty()) {
+                            pNode->fSocketWritable = false;
+                            fSendPending           = true;
                         }
                     }
-                    if (fDelete) {
-                        vNodesDisconnected.remove(pNode);
-                        delete pNode;
-                    }
+                } else {
+                    fMoreWork = true;
+                }
+            }
+
+            //
+            // Receive
+            //
+            // Like the select() loop, drain the write buffer first before receiving more
+            // so that a peer not reading its own data is throttled by TCP flow control.
+            if (pNode->hSocket != INVALID_SOCKET && pNode->fSocketReadable && !fSendPending) {
+                TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
+                if (!lockRecv) {
+                    fMoreWork = true;
+                } else if (!CanReceiveData(pNode)) {
+                    fRecvFlood = true;
+                } else if (SocketRecvData(pNode)) {
+                    fMoreWork = true;
+                } else {
+                    pNode->fSocketReadable = false;
                 }
             }
-        }
-        if (vNodes.size() != nPrevNodeCount) {
-            nPrevNodeCount = vNodes.size();
 
-            LogPrint(BCLog::INFO, "Connections number changed, %d -> %d\n", nPrevNodeCount, vNodes.size());
+            //
+            // Inactivity checking
+            //
+            InactivityCheck(pNode);
         }
 
+        ReleaseNodes(vNodesCopy);
+
+        // poll again right away while sockets have data left, and retry soon while the message handler
+        // drains full receive buffers; otherwise sleep until a socket event or a wakeup
+        nTimeout = fMoreWork ? 0 : (fRecvFlood ? SOCKET_EVENTS_FLOOD_TIMEOUT : SOCKET_EVENTS_TIMEOUT);
+    }
+}
+#else
+void ThreadSocketHandler() {
+    uint32_t nPrevNodeCount = 0;
+    while (true) {
+        DisconnectNodes(nPrevNodeCount);
+
         //
         // Find which sockets have data to receive
         //
@@ -595,8 +928,7 @@ void ThreadSocketHandler() {
                 }
                 {
                     TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                    if (lockRecv && (pNode->vRecvMsg.empty() || !pNode->vRecvMsg.front().complete() ||
-                                     pNode->GetTotalRecvSize() <= ReceiveFloodSize()))
+                    if (lockRecv && CanReceiveData(pNode))
                         FD_SET(pNode->hSocket, &fdsetRecv);
                 }
             }
@@ -621,54 +953,13 @@ void ThreadSocketHandler() {
         // Accept new connections
         //
         for (auto hListenSocket : vhListenSocket)
-            if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv)) {
-                struct sockaddr_storage sockaddr;
-                socklen_t len  = sizeof(sockaddr);
-                SOCKET hSocket = accept(hListenSocket, (struct sockaddr*)&sockaddr, &len);
-                CAddress addr;
-                int32_t nInbound = 0;
-
-                if (hSocket != INVALID_SOCKET)
-                    if (!addr.SetSockAddr((const struct sockaddr*)&sockaddr))
-                        LogPrint(BCLog::INFO, "Warning: Unknown socket family\n");
-
-                {
-                    LOCK(cs_vNodes);
-                    for (auto pNode : vNodes)
-                        if (pNode->fInbound)
-                            nInbound++;
-                }
-
-                if (hSocket == INVALID_SOCKET) {
-                    int32_t nErr = WSAGetLastError();
-                    if (nErr != WSAEWOULDBLOCK)
-                        LogPrint(BCLog::INFO, "socket[%s] error accept failed: %s\n", addr.ToString(), NetworkErrorString(nErr));
-                } else if (nInbound >= nMaxConnections - MAX_OUTBOUND_CONNECTIONS) {
-                    closesocket(hSocket);
-                } else if (CNode::IsBanned(addr)) {
-                    LogPrint(BCLog::INFO, "connection from %s dropped (banned)\n", addr.ToString());
-                    closesocket(hSocket);
-                } else {
-                    LogPrint(BCLog::NET, "accepted connection %s\n", addr.ToString());
-                    CNode* pNode = new CNode(hSocket, addr, "", true);
-                    pNode->AddRef();
-                    {
-                        LOCK(cs_vNodes);
-                        vNodes.push_back(pNode);
-                    }
-                }
-            }
+            if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv))
+                AcceptConnection(hListenSocket);
 
         //
         // Service each socket
         //
-        vector<CNode*> vNodesCopy;
-        {
-            LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
-            for (auto pNode : vNodesCopy)
-                pNode->AddRef();
-        }
+        vector<CNode*> vNodesCopy = CopyNodes();
         for (auto pNode : vNodesCopy) {
             boost::this_thread::interruption_point();
 
@@ -679,34 +970,8 @@ void ThreadSocketHandler() {
                 continue;
             if (FD_ISSET(pNode->hSocket, &fdsetRecv) || FD_ISSET(pNode->hSocket, &fdsetError)) {
                 TRY_LOCK(pNode->cs_vRecvMsg, lockRecv);
-                if (lockRecv) {
-                    {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int32_t nBytes = recv(pNode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                        if (nBytes > 0) {
-                            if (!pNode->ReceiveMsgBytes(pchBuf, nBytes))
-                                pNode->CloseSocketDisconnect();
-                            pNode->nLastRecv = GetTime();
-                            pNode->nRecvBytes += nBytes;
-                            pNode->RecordBytesRecv(nBytes);
-                        } else if (nBytes == 0) {
-                            // socket closed gracefully
-                            if (!pNode->fDisconnect)
-                                LogPrint(BCLog::NET, "socket[%s] closed\n", pNode->addr.ToString());
-                            pNode->CloseSocketDisconnect();
-                        } else if (nBytes < 0) {
-                            // error
-                            int32_t nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR &&
-                                nErr != WSAEINPROGRESS) {
-                                if (!pNode->fDisconnect)
-                                    LogPrint(BCLog::INFO, "socket[%s] recv error %s\n", pNode->addr.ToString(), NetworkErrorString(nErr));
-                                pNode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
+                if (lockRecv)
+                    SocketRecvData(pNode);
             }
 
             //
@@ -723,62 +988,13 @@ void ThreadSocketHandler() {
             //
             // Inactivity checking
             //
-            if (pNode->vSendMsg.empty())
-                pNode->nLastSendEmpty = GetTime();
-            // p2p_xiaoyu_20191126
-            // if (GetTime() - pNode->nTimeConnected > 60) {
-            //     if (pNode->nLastRecv == 0 || pNode->nLastSend == 0) {
-            //         LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d\n", pNode->nLastRecv != 0,
-            //                  pNode->nLastSend != 0);
-            //         pNode->fDisconnect = true;
-            //     } else if (GetTime() - pNode->nLastSend > 90 * 60 && GetTime() - pNode->nLastSendEmpty > 90 * 60) {
-            //         LogPrint(BCLog::INFO, "socket not sending\n");
-            //         pNode->fDisconnect = true;
-            //     } else if (GetTime() - pNode->nLastRecv > 90 * 60) {
-            //         LogPrint(BCLog::INFO, "socket inactivity timeout\n");
-            //         pNode->fDisconnect = true;
-            //     }
-            // }
-            int64_t nTime = GetSystemTimeInSeconds();
-            if (nTime - pNode->nTimeConnected > DEFAULT_PEER_CONNECT_TIMEOUT)
-            {
-                if (pNode->nLastRecv == 0 || pNode->nLastSend == 0)
-                {
-                    LogPrint(BCLog::NET, "socket no message in first %i seconds, %d %d from %d\n", DEFAULT_PEER_CONNECT_TIMEOUT, pNode->nLastRecv != 0, pNode->nLastSend != 0, pNode->GetId());
-                    pNode->fDisconnect = true;
-                }
-                else if (nTime - pNode->nLastSend > TIMEOUT_INTERVAL)
-                {
-                    LogPrint(BCLog::NET, "socket sending timeout: %is\n", nTime - pNode->nLastSend);
-                    pNode->fDisconnect = true;
-                }
-                else if (nTime - pNode->nLastRecv > TIMEOUT_INTERVAL )
-                {
-                    LogPrint(BCLog::NET, "socket receive timeout: %is\n", nTime - pNode->nLastRecv);
-                    pNode->fDisconnect = true;
-                }
-                else if (pNode->nPingNonceSent && pNode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
-                {
-                    LogPrint(BCLog::NET, "ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pNode->nPingUsecStart));
-                    pNode->fDisconnect = true;
-                }
-                else if (!pNode->fSuccessfullyConnected)
-                {
-                    LogPrint(BCLog::NET, "version handshake timeout from %d\n", pNode->GetId());
-                    pNode->fDisconnect = true;
-                }
-            }
-
-
+            InactivityCheck(pNode);
         }
 
-        {
-            LOCK(cs_vNodes);
-            for (auto pNode : vNodesCopy)
-                pNode->Release();
-        }
+        ReleaseNodes(vNodesCopy);
     }
 }
+#endif
 
 #ifdef USE_UPNP
 void ThreadMapPort() {
@@ -1228,14 +1444,14 @@ void ThreadMessageHandler() {
             boost::this_thread::interruption_point();
         }
 
-        {
-            LOCK(cs_vNodes);
-            for (auto pNode : vNodesCopy)
-                pNode->Release();
-        }
+        ReleaseNodes(vNodesCopy);
 
+        // sleep until the socket handler received a complete message, the timeout keeps SendMessages() ticking
+        boost::unique_lock<boost::mutex> lock(csMessageHandlerWakeup);
         if (fSleep)
-            MilliSleep(100);
+            condMessageHandlerWakeup.timed_wait(lock, boost::posix_time::milliseconds(100),
+                                                [] { return fMessageHandlerWakeup; });
+        fMessageHandlerWakeup = false;
     }
 }
 
@@ -1380,7 +1596,13 @@ void static Discover(boost::thread_group& threadGroup) {
         threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "ext-ip", &ThreadGetMyPublicIP));
 }
 
-void StartNode(boost::thread_group& threadGroup) {
+bool StartNode(boost::thread_group& threadGroup) {
+#ifdef USE_EPOLL
+    // the connections are not capped by FD_SETSIZE with epoll, so there is no select() loop to fall back to
+    if (!InitSocketEvents())
+        return false;
+#endif
+
     if (semOutbound == nullptr) {
         // initialize semaphore
         int32_t nMaxOutbound = min(MAX_OUTBOUND_CONNECTIONS, nMaxConnections);
@@ -1423,6 +1645,8 @@ void StartNode(boost::thread_group& threadGroup) {
     threadGroup.create_thread(boost::bind(&LoopForever<void (*)()>, "dumpaddr", &DumpAddresses, DUMP_ADDRESSES_INTERVAL * 1000));
 
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "post-ip", &ThreadPostNodeInfo));
+
+    return true;
 }
 
 bool StopNode() {
@@ -1450,6 +1674,12 @@ public:
                 if (closesocket(hListenSocket) == SOCKET_ERROR)
                     LogPrint(BCLog::INFO, "closesocket(hListenSocket) failed with error %s\n",
                              NetworkErrorString(WSAGetLastError()));
+#ifdef USE_EPOLL
+        if (hWakeupEvent != -1)
+            close(hWakeupEvent);
+        if (hEpoll != -1)
+            close(hEpoll);
+#endif
 
         // clean up some globals (to help leak detection)
         for (auto pNode : vNodes)
@@ -1511,6 +1741,43 @@ void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash, const CDataStream&
     }
 }
 
+void RelayTransactions(const vector<std::shared_ptr<CBaseTx>>& vptx) {
+    vector<CInv> vInv;
+    vInv.reserve(vptx.size());
+    {
+        LOCK(cs_mapRelay);
+        // Expire old relay messages
+        while (!vRelayExpiration.empty() && vRelayExpiration.front().first < GetTime()) {
+            mapRelay.erase(vRelayExpiration.front().second);
+            vRelayExpiration.pop_front();
+        }
+
+        for (const auto& pBaseTx : vptx) {
+            CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+            ss.reserve(1000);
+            ss << pBaseTx->GetNewInstance();
+
+            CInv inv(MSG_TX, pBaseTx->GetHash());
+            mapRelay.insert(make_pair(inv, ss));
+            vRelayExpiration.push_back(make_pair(GetTime() + 15 * 60, inv));
+            vInv.push_back(inv);
+        }
+    }
+
+    // the invs are sent out together by the next SendMessages() of each peer
+    LOCK(cs_vNodes);
+    for (auto pNode : vNodes) {
+        if (!pNode->fRelayTxes)
+            continue;
+        LOCK(pNode->cs_filter);
+        for (size_t i = 0; i < vptx.size(); i++) {
+            if (!pNode->pFilter || pNode->pFilter->IsRelevantAndUpdate(vptx[i].get(), vInv[i].hash))
+                pNode->PushInventory(vInv[i]);
+        }
+    }
+    LogPrint(BCLog::NET, "relay %u txs time:%ld\n", vInv.size(), GetTime());
+}
+
 //
 // CAddrDB
 //
@@ -38,6 +38,17 @@ static const int TIMEOUT_INTERVAL = 20 * 60;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 
+#if defined(__linux__)
+/** Wait for socket readiness with epoll, which unlike select() is not limited to FD_SETSIZE sockets */
+#define USE_EPOLL
+#endif
+/** Maximum number of socket events handled per epoll_wait() */
+static const int32_t SOCKET_EVENTS_BATCH_SIZE = 256;
+/** Milliseconds the socket handler waits for socket events when idle */
+static const int32_t SOCKET_EVENTS_TIMEOUT = 1000;
+/** Milliseconds the socket handler waits while receive buffers are full */
+static const int32_t SOCKET_EVENTS_FLOOD_TIMEOUT = 50;
+
 inline uint32_t ReceiveFloodSize() { return 1000 * SysCfg().GetArg("-maxreceivebuffer", 5 * 1000); }
 void AddOneShot(string strDest);
 bool RecvLine(SOCKET hSocket, string& strLine);
@@ -49,7 +60,7 @@ CNode* ConnectNode(CAddress addrConnect, const char* strDest = nullptr);
 void MapPort(bool fUseUPnP);
 uint16_t GetListenPort();
 bool BindListenPort(const CService& bindAddr, string& strError = REF(string()));
-void StartNode(boost::thread_group& threadGroup);
+bool StartNode(boost::thread_group& threadGroup);
 bool StopNode();
 
 enum {
@@ -89,6 +100,8 @@ extern map<CNetAddr, LocalServiceInfo> mapLocalHost;
 
 void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash);
 void RelayTransaction(CBaseTx* pBaseTx, const uint256& hash, const CDataStream& ss);
+// Relay the txs accepted together, e.g. by submittxbatch, with one pass over the peers
+void RelayTransactions(const vector<std::shared_ptr<CBaseTx>>& vptx);
 
 /** Access to the (IP) address database (peers.dat) */
 class CAddrDB {
@@ -12,6 +12,7 @@
 
 #ifndef WIN32
 #include <fcntl.h>
+#include <poll.h>
 #endif
 
 #include <boost/algorithm/string/case_conv.hpp>  // for to_lower()
@@ -341,6 +342,7 @@ bool static ConnectSocketDirectly(const CService& addrConnect, SOCKET& hSocketRe
         // WSAEINVAL is here because some legacy version of winsock uses it
         if (WSAGetLastError() == WSAEINPROGRESS || WSAGetLastError() == WSAEWOULDBLOCK ||
             WSAGetLastError() == WSAEINVAL) {
+#ifdef WIN32
             struct timeval timeout;
             timeout.tv_sec  = nTimeout / 1000;
             timeout.tv_usec = (nTimeout % 1000) * 1000;
@@ -349,13 +351,21 @@ bool static ConnectSocketDirectly(const CService& addrConnect, SOCKET& hSocketRe
             FD_ZERO(&fdset);
             FD_SET(hSocket, &fdset);
             int nRet = select(hSocket + 1, nullptr, &fdset, nullptr, &timeout);
+#else
+            // poll() rather than select(), the socket may be above FD_SETSIZE when the connections are not
+            // capped by it
+            struct pollfd pollFd;
+            pollFd.fd     = hSocket;
+            pollFd.events = POLLOUT;
+            int nRet      = poll(&pollFd, 1, nTimeout);
+#endif
             if (nRet == 0) {
                 LogPrint(BCLog::NET, "connection to %s timeout\n", addrConnect.ToString());
                 closesocket(hSocket);
                 return false;
             }
             if (nRet == SOCKET_ERROR) {
-                LogPrint(BCLog::NET, "select() for %s failed: %s\n", addrConnect.ToString(),
+                LogPrint(BCLog::NET, "wait for connect() to %s failed: %s\n", addrConnect.ToString(),
                          NetworkErrorString(WSAGetLastError()));
                 closesocket(hSocket);
                 return false;
@@ -373,7 +383,7 @@ bool static ConnectSocketDirectly(const CService& addrConnect, SOCKET& hSocketRe
                 return false;
             }
             if (nRet != 0) {
-                LogPrint(BCLog::NET, "connect() to %s failed after select(): %s\n", addrConnect.ToString(),
+                LogPrint(BCLog::NET, "connect() to %s failed after wait: %s\n", addrConnect.ToString(),
                          NetworkErrorString(nRet));
                 closesocket(hSocket);
                 return false;
@@ -0,0 +1,127 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockencodings.h"
+
+#include "commons/random.h"
+#include "crypto/hash.h"
+#include "crypto/siphash.h"
+#include "tx/txmempool.h"
+#include "tx/txserializer.h"
+
+#include <unordered_map>
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock &block)
+    : header(block.GetBlockHeader()), nonce(GetRand(std::numeric_limits<uint64_t>::max())) {
+    FillShortTxIDSelector();
+
+    // the block reward and median price txs are made by the miner and never relayed, send them in full
+    for (uint32_t i = 0; i < block.vptx.size(); i++) {
+        const auto &pTx = block.vptx[i];
+        if (i == 0 || pTx->IsBlockRewardTx() || pTx->IsPriceMedianTx())
+            prefilledTxs.push_back({i, pTx});
+        else
+            shortTxIds.push_back(GetShortID(pTx->GetHash()));
+    }
+}
+
+void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
+    CHashWriter hasher(SER_GETHASH, 0);
+    hasher << header << nonce;
+    uint256 selector = hasher.GetHash();
+    shortTxIdK0      = selector.GetUint64(0);
+    shortTxIdK1      = selector.GetUint64(1);
+}
+
+uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256 &txid) const {
+    return SipHashUint256(shortTxIdK0, shortTxIdK1, txid) & 0xffffffffffffL;
+}
+
+CompactReadStatus CPartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, CTxMemPool &pool) {
+    if (cmpctBlock.BlockTxCount() == 0 ||
+        cmpctBlock.BlockTxCount() > MAX_BLOCK_SIZE / CBlockHeaderAndShortTxIDs::SHORTTXIDS_LENGTH)
+        return READ_STATUS_INVALID;
+
+    assert(txsAvailable.empty());
+    header = cmpctBlock.header;
+    txsAvailable.resize(cmpctBlock.BlockTxCount());
+
+    int32_t lastIndex = -1;
+    for (const auto &prefilledTx : cmpctBlock.prefilledTxs) {
+        if (!prefilledTx.pTx || (int32_t)prefilledTx.index <= lastIndex || prefilledTx.index >= txsAvailable.size())
+            return READ_STATUS_INVALID;
+
+        txsAvailable[prefilledTx.index] = prefilledTx.pTx;
+        lastIndex                      = prefilledTx.index;
+    }
+    prefilledCount = cmpctBlock.prefilledTxs.size();
+
+    // position of every short id in the block, skipping the prefilled slots
+    std::unordered_map<uint64_t, uint32_t> shortIdIndexes;
+    shortIdIndexes.reserve(cmpctBlock.shortTxIds.size());
+    uint32_t index = 0;
+    for (const auto shortTxId : cmpctBlock.shortTxIds) {
+        while (txsAvailable[index])
+            index++;
+
+        if (!shortIdIndexes.emplace(shortTxId, index).second)
+            return READ_STATUS_FAILED;  // two txs of the block share a short id, ask for the full block
+        index++;
+    }
+
+    vector<bool> haveTxs(txsAvailable.size(), false);
+    vector<uint256> txids;
+    pool.QueryHash(txids);
+    for (const auto &txid : txids) {
+        auto it = shortIdIndexes.find(cmpctBlock.GetShortID(txid));
+        if (it == shortIdIndexes.end())
+            continue;
+
+        if (!haveTxs[it->second]) {
+            txsAvailable[it->second] = pool.Lookup(txid);
+            if (txsAvailable[it->second]) {
+                haveTxs[it->second] = true;
+                mempoolCount++;
+            }
+        } else if (txsAvailable[it->second]) {
+            // two mempool txs match the short id, request the tx from the peer instead of guessing
+            txsAvailable[it->second] = nullptr;
+            mempoolCount--;
+        }
+    }
+
+    return READ_STATUS_OK;
+}
+
+bool CPartiallyDownloadedBlock::IsTxAvailable(size_t index) const {
+    assert(!txsAvailable.empty());
+    assert(index < txsAvailable.size());
+    return txsAvailable[index] != nullptr;
+}
+
+CompactReadStatus CPartiallyDownloadedBlock::FillBlock(CBlock &block,
+                                                       const vector<std::shared_ptr<CBaseTx>> &missingTxs) const {
+    assert(!txsAvailable.empty());
+    block = CBlock(header);
+    block.vptx.resize(txsAvailable.size());
+
+    size_t missingIndex = 0;
+    for (size_t i = 0; i < txsAvailable.size(); i++) {
+        if (txsAvailable[i]) {
+            block.vptx[i] = txsAvailable[i];
+        } else {
+            if (missingIndex >= missingTxs.size() || !missingTxs[missingIndex])
+                return READ_STATUS_INVALID;
+            block.vptx[i] = missingTxs[missingIndex++];
+        }
+    }
+    if (missingIndex != missingTxs.size())
+        return READ_STATUS_INVALID;
+
+    // a short id collision with a mempool tx ends up in a wrong merkle root
+    if (block.BuildMerkleTree() != header.GetMerkleRootHash())
+        return READ_STATUS_FAILED;
+
+    return READ_STATUS_OK;
+}
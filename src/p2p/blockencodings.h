@@ -0,0 +1,138 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_BLOCKENCODINGS_H
+#define P2P_BLOCKENCODINGS_H
+
+#include "commons/serialize.h"
+#include "commons/uint256.h"
+#include "config/const.h"
+#include "persistence/block.h"
+#include "tx/tx.h"
+
+#include <memory>
+#include <vector>
+
+class CTxMemPool;
+
+/** Version of the compact block encoding, announced by the "sendcmpct" message */
+static const uint64_t COMPACT_BLOCKS_VERSION = 1;
+
+/** A transaction sent in full in a compact block, e.g. the block reward tx which no mempool has */
+class CPrefilledTx {
+public:
+    uint32_t index;  // position of the tx in the block
+    std::shared_ptr<CBaseTx> pTx;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(VARINT(index));
+        READWRITE(pTx);
+    )
+};
+
+/**
+ * A block announced by its header and the 6-byte short ids of its transactions. The receiver rebuilds the
+ * block from its own mempool and asks only for the transactions it misses (getblocktxn/blocktxn).
+ */
+class CBlockHeaderAndShortTxIDs {
+public:
+    static const uint32_t SHORTTXIDS_LENGTH = 6;
+
+    CBlockHeader header;
+    uint64_t nonce = 0;
+    vector<uint64_t> shortTxIds;
+    vector<CPrefilledTx> prefilledTxs;
+
+public:
+    CBlockHeaderAndShortTxIDs() {}
+    explicit CBlockHeaderAndShortTxIDs(const CBlock &block);
+
+    // SipHash-2-4 of the txid, keyed by the hash of the header and the nonce, truncated to 48 bits
+    uint64_t GetShortID(const uint256 &txid) const;
+    size_t BlockTxCount() const { return shortTxIds.size() + prefilledTxs.size(); }
+
+    IMPLEMENT_SERIALIZE(
+        CBlockHeaderAndShortTxIDs *pThis = const_cast<CBlockHeaderAndShortTxIDs *>(this);
+        READWRITE(header);
+        READWRITE(nonce);
+
+        uint32_t shortTxIdCount = shortTxIds.size();
+        READWRITE(VARINT(shortTxIdCount));
+        if (fRead) {
+            if (shortTxIdCount > MAX_BLOCK_SIZE / SHORTTXIDS_LENGTH)
+                throw std::ios_base::failure("CBlockHeaderAndShortTxIDs : too many short txids");
+            pThis->shortTxIds.resize(shortTxIdCount);
+        }
+        for (uint32_t i = 0; i < shortTxIdCount; i++) {
+            uint32_t lsb = shortTxIds[i] & 0xffffffff;
+            uint16_t msb = (shortTxIds[i] >> 32) & 0xffff;
+            READWRITE(lsb);
+            READWRITE(msb);
+            if (fRead)
+                pThis->shortTxIds[i] = ((uint64_t)msb << 32) | lsb;
+        }
+
+        READWRITE(prefilledTxs);
+        if (fRead)
+            pThis->FillShortTxIDSelector();
+    )
+
+private:
+    void FillShortTxIDSelector() const;
+
+    mutable uint64_t shortTxIdK0 = 0;
+    mutable uint64_t shortTxIdK1 = 0;
+};
+
+/** The "getblocktxn" message: the positions of the transactions of a compact block the sender misses */
+class CBlockTxRequest {
+public:
+    uint256 blockHash;
+    vector<uint32_t> indexes;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(indexes);
+    )
+};
+
+/** The "blocktxn" message: the transactions asked for by a "getblocktxn", in the requested order */
+class CBlockTxs {
+public:
+    uint256 blockHash;
+    vector<std::shared_ptr<CBaseTx>> txs;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(txs);
+    )
+};
+
+enum CompactReadStatus {
+    READ_STATUS_OK,
+    READ_STATUS_INVALID,  // the peer sent malformed data
+    READ_STATUS_FAILED,   // short id collision or wrong reconstruction, fall back to the full block
+};
+
+/** A compact block being rebuilt from the mempool and the transactions fetched from the peer */
+class CPartiallyDownloadedBlock {
+public:
+    CBlockHeader header;
+
+public:
+    CompactReadStatus InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, CTxMemPool &pool);
+    bool IsTxAvailable(size_t index) const;
+    // the missing transactions must be given in the order of their positions in the block
+    CompactReadStatus FillBlock(CBlock &block, const vector<std::shared_ptr<CBaseTx>> &missingTxs) const;
+
+    size_t GetPrefilledCount() const { return prefilledCount; }
+    size_t GetMempoolCount() const { return mempoolCount; }
+
+private:
+    vector<std::shared_ptr<CBaseTx>> txsAvailable;
+    size_t prefilledCount = 0;
+    size_t mempoolCount   = 0;
+};
+
+#endif  // P2P_BLOCKENCODINGS_H
@@ -0,0 +1,44 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockmessagecache.h"
+
+#include "config/const.h"
+
+CBlockMessageCache blockMessageCache(MAX_BLOCK_MESSAGE_CACHE_SIZE);
+
+CSerializeDataPtr CBlockMessageCache::Get(const uint256 &blockHash) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = messageIndex.find(blockHash);
+    if (it == messageIndex.end()) {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    messages.splice(messages.begin(), messages, it->second);
+    return it->second->second;
+}
+
+void CBlockMessageCache::Put(const uint256 &blockHash, const CSerializeDataPtr &pMessage) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (pMessage->size() > maxSize || messageIndex.count(blockHash))
+        return;
+
+    messages.emplace_front(blockHash, pMessage);
+    messageIndex[blockHash] = messages.begin();
+    totalSize += pMessage->size();
+    while (totalSize > maxSize) {
+        // the peers still sending an evicted message keep its bytes alive
+        totalSize -= messages.back().second->size();
+        messageIndex.erase(messages.back().first);
+        messages.pop_back();
+        ++evictions;
+    }
+}
+
+CBlockMessageCacheStats CBlockMessageCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return {(uint64_t)messages.size(), totalSize, hits, misses, evictions};
+}
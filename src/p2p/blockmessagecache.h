@@ -0,0 +1,52 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_BLOCKMESSAGECACHE_H
+#define P2P_BLOCKMESSAGECACHE_H
+
+#include "commons/uint256.h"
+#include "p2p/node.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+struct CBlockMessageCacheStats {
+    uint64_t count;
+    uint64_t size;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+/**
+ * Bounded LRU cache of the serialized "block" messages of recent blocks, keyed by the block hash.
+ * When a new block is announced most peers ask for the same few blocks, and every hit is pushed to
+ * the peer as is, without reading the block file, serializing the block or holding cs_main.
+ */
+class CBlockMessageCache {
+public:
+    explicit CBlockMessageCache(const uint64_t maxSizeIn) : maxSize(maxSizeIn) {}
+
+    // nullptr if the block message is not cached
+    CSerializeDataPtr Get(const uint256 &blockHash);
+    void Put(const uint256 &blockHash, const CSerializeDataPtr &pMessage);
+
+    CBlockMessageCacheStats GetStats();
+
+private:
+    typedef std::pair<uint256, CSerializeDataPtr> MessageItem;
+    std::list<MessageItem> messages;  // most recently used first
+    std::unordered_map<uint256, std::list<MessageItem>::iterator, CUint256Hasher> messageIndex;
+    uint64_t maxSize;
+    uint64_t totalSize = 0;
+    uint64_t hits      = 0;
+    uint64_t misses    = 0;
+    uint64_t evictions = 0;
+    std::mutex mtx;
+};
+
+extern CBlockMessageCache blockMessageCache;
+
+#endif  // P2P_BLOCKMESSAGECACHE_H
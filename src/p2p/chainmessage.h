@@ -7,10 +7,15 @@
 #define CHAINMESSAGE_H
 
 #include "alert.h"
+#include "chain/blockdelegates.h"
 #include "commons/uint256.h"
 #include "commons/util/util.h"
 #include "main.h"
 #include "net.h"
+#include "p2p/blockencodings.h"
+#include "p2p/blockmessagecache.h"
+#include "p2p/txvalidationqueue.h"
+#include "miner/miner.h"
 #include "miner/pbftcontext.h"
 #include "miner/pbftmanager.h"
 #include "tx/einvalidtxtype.h"
@@ -64,8 +69,10 @@ void MarkBlockAsReceived(const uint256 &hash, NodeId nodeFrom = -1) {
         CNodeState *state = State(std::get<0>(itInFlight->second));
         state->vBlocksInFlight.erase(std::get<1>(itInFlight->second));
         state->nBlocksInFlight--;
-        if (std::get<0>(itInFlight->second) == nodeFrom)
+        if (std::get<0>(itInFlight->second) == nodeFrom) {
             state->nLastBlockReceive = GetTimeMicros();
+            state->nStallingSince    = 0;
+        }
 
         mapBlocksInFlight.erase(itInFlight);
     }
@@ -87,8 +94,6 @@ inline void ProcessGetData(CNode *pFrom) {
 
     vector<CInv> vNotFound;
 
-    LOCK(cs_main);
-
     while (it != pFrom->vRecvGetData.end()) {
         // Don't bother if send buffer is too full to respond anyway
         if (pFrom->nSendSize >= SendBufferSize()) {
@@ -101,57 +106,78 @@ inline void ProcessGetData(CNode *pFrom) {
             boost::this_thread::interruption_point();
             it++;
 
-            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK) {
-                bool send                                = false;
-                map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
-                if (mi != mapBlockIndex.end()) {
+            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK) {
+                // a recently requested block is pushed as is, without cs_main or disk reads
+                CSerializeDataPtr pBlockMessage;
+                if (inv.type == MSG_BLOCK)
+                    pBlockMessage = blockMessageCache.Get(inv.hash);
+
+                bool send = false;
+                if (pBlockMessage) {
+                    LogPrint(BCLog::NET, "send cached block: %s to peer %s\n", inv.hash.GetHex(), pFrom->addr.ToString());
+                    pFrom->PushSerializedMessage(pBlockMessage);
                     send = true;
                 } else {
-                    LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
-                }
-
-                if (send) {
-                    // Send block from disk
-                    CBlock block;
-                    ReadBlockFromDisk((*mi).second, block);
-                    if (inv.type == MSG_BLOCK) {
-                        LogPrint(BCLog::NET, "send block[%u]: %s to peer %s\n", block.GetHeight(), block.GetHash().GetHex(),
-                                 pFrom->addr.ToString());
-                        pFrom->PushMessage(NetMsgType::BLOCK, block);
+                    LOCK(cs_main);
+                    map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
+                    if (mi != mapBlockIndex.end()) {
+                        send = true;
+                    } else {
+                        LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
                     }
-                    else  // MSG_FILTERED_BLOCK)
-                    {
-                        LOCK(pFrom->cs_filter);
-                        if (pFrom->pFilter) {
-                            CMerkleBlock merkleBlock(block, *pFrom->pFilter);
-                            pFrom->PushMessage("merkleblock", merkleBlock);
-                            // CMerkleBlock just contains hashes, so also push any transactions in the block the client
-                            // did not see This avoids hurting performance by pointlessly requiring a round-trip Note
-                            // that there is currently no way for a node to request any single transactions we didnt
-                            // send here - they must either disconnect and retry or request the full block. Thus, the
-                            // protocol spec specified allows for us to provide duplicate txn here, however we MUST
-                            // always provide at least what the remote peer needs
-                            for (auto &pair : merkleBlock.vMatchedTxn)
-                                if (!pFrom->setInventoryKnown.count(CInv(MSG_TX, pair.second)))
-                                    pFrom->PushMessage(NetMsgType::TX, block.vptx[pair.first]);
+
+                    if (send) {
+                        // Send block from disk
+                        CBlock block;
+                        bool fRead = ReadBlockFromDisk((*mi).second, block);
+                        if (inv.type == MSG_BLOCK) {
+                            LogPrint(BCLog::NET, "send block[%u]: %s to peer %s\n", block.GetHeight(), block.GetHash().GetHex(),
+                                     pFrom->addr.ToString());
+                            pBlockMessage = CNode::MakeMessage(NetMsgType::BLOCK, block);
+                            if (fRead)
+                                blockMessageCache.Put(inv.hash, pBlockMessage);
+                            pFrom->PushSerializedMessage(pBlockMessage);
+                        } else if (inv.type == MSG_CMPCT_BLOCK) {
+                            LogPrint(BCLog::NET, "send cmpct block[%u]: %s to peer %s\n", block.GetHeight(),
+                                     block.GetHash().GetHex(), pFrom->addr.ToString());
+                            pFrom->PushMessage(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(block));
+                        }
+                        else  // MSG_FILTERED_BLOCK)
+                        {
+                            LOCK(pFrom->cs_filter);
+                            if (pFrom->pFilter) {
+                                CMerkleBlock merkleBlock(block, *pFrom->pFilter);
+                                pFrom->PushMessage("merkleblock", merkleBlock);
+                                // CMerkleBlock just contains hashes, so also push any transactions in the block the client
+                                // did not see This avoids hurting performance by pointlessly requiring a round-trip Note
+                                // that there is currently no way for a node to request any single transactions we didnt
+                                // send here - they must either disconnect and retry or request the full block. Thus, the
+                                // protocol spec specified allows for us to provide duplicate txn here, however we MUST
+                                // always provide at least what the remote peer needs
+                                for (auto &pair : merkleBlock.vMatchedTxn)
+                                    if (!pFrom->setInventoryKnown.count(CInv(MSG_TX, pair.second)))
+                                        pFrom->PushMessage(NetMsgType::TX, block.vptx[pair.first]);
+                            }
+                            // else
+                            // no response
                         }
-                        // else
-                        // no response
                     }
+                }
 
-                    // Trigger them to send a getblocks request for the next batch of inventory
-                    if (inv.hash == pFrom->hashContinue) {
-                        // Bypass PushInventory, this must send even if redundant,
-                        // and we want it right after the last block so they don't
-                        // wait for other stuff first.
-                        vector<CInv> vInv;
-                        vInv.push_back(CInv(MSG_BLOCK, chainActive.Tip()->GetBlockHash()));
-                        pFrom->PushMessage(NetMsgType::INV, vInv);
-                        pFrom->hashContinue.SetNull();
-                        LogPrint(BCLog::NET, "reset node hashcontinue\n");
-                    }
+                // Trigger them to send a getblocks request for the next batch of inventory
+                if (send && inv.hash == pFrom->hashContinue) {
+                    // Bypass PushInventory, this must send even if redundant,
+                    // and we want it right after the last block so they don't
+                    // wait for other stuff first.
+                    LOCK(cs_main);
+                    vector<CInv> vInv;
+                    vInv.push_back(CInv(MSG_BLOCK, chainActive.Tip()->GetBlockHash()));
+                    pFrom->PushMessage(NetMsgType::INV, vInv);
+                    pFrom->hashContinue.SetNull();
+                    LogPrint(BCLog::NET, "reset node hashcontinue\n");
                 }
             } else if (inv.IsKnownType()) {
+                LOCK(cs_main);
                 // Send stream from relay memory
                 bool pushed = false;
                 {
@@ -180,7 +206,7 @@ inline void ProcessGetData(CNode *pFrom) {
             // Track requests for our stuff.
             // g_signals.Inventory(inv.hash);
 
-            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK)
+            if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK)
                 break;
         }
     }
@@ -216,6 +242,10 @@ bool AlreadyHave(const CInv &inv) {
 
 // Requires cs_main.
 inline bool AddBlockToQueue(const uint256 &hash, NodeId nodeId) {
+    // Blocks along the headers chain are spread over all peers by the download window
+    if (headersChain.Contains(hash))
+        return false;
+
     int64_t now  = GetTimeMicros();
     bool isMiner = SysCfg().GetBoolArg("-genblock", false);
 
@@ -501,30 +531,10 @@ inline bool ProcessTxMessage(CNode *pFrom, string strCommand, CDataStream &vRecv
         return true ;
     }
 
-
-
-    LOCK(cs_main);
-    CValidationState state;
-    if (AcceptToMemoryPool(mempool, state, pBaseTx.get(), true)) {
-        RelayTransaction(pBaseTx.get(), inv.hash);
-        mapAlreadyAskedFor.erase(inv);
-
-        LogPrint(BCLog::INFO, "AcceptToMemoryPool: %s %s : accepted %s (poolsz %u)\n", pFrom->addr.ToString(),
-                 pFrom->cleanSubVer, pBaseTx->GetHash().ToString(), mempool.memPoolTxs.size());
-    }
-
-    int32_t nDoS = 0;
-    if (state.IsInvalid(nDoS)) {
-        LogPrint(BCLog::INFO, "%s [%d] from %s %s was not accepted into the memory pool: %s\n",
-                pBaseTx->GetHash().ToString(), pBaseTx->valid_height,
-                pFrom->addr.ToString(), pFrom->cleanSubVer, state.GetRejectReason());
-
-        pFrom->PushMessage(NetMsgType::REJECT, strCommand, state.GetRejectCode(), state.GetRejectReason(), inv.hash);
-        // if (nDoS > 0) {
-        //     LogPrint(BCLog::INFO, "Misebehaving, add to tx hash %s mempool error, Misbehavior add %d",
-        //     pBaseTx->GetHash().GetHex(), nDoS); Misbehaving(pFrom->GetId(), nDoS);
-        // }
-    }
+    // accepted to the mempool by the tx validation thread
+    if (!txValidationQueue.Push(pFrom, pBaseTx))
+        LogPrint(BCLog::NET, "tx validation queue is full for peer %s, drop tx %s\n", pFrom->addr.ToString(),
+                 inv.hash.ToString());
 
     return true;
 }
@@ -553,7 +563,7 @@ inline bool ProcessGetHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
 
     // We must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
     vector<CBlock> vHeaders;
-    int32_t nLimit = 2000;
+    int32_t nLimit = MAX_HEADERS_RESULTS;
     LogPrint(BCLog::NET, "getheaders %d to %s from peer %s\n", (pIndex ? pIndex->height : -1), hashStop.ToString(),
              pFrom->addr.ToString());
     for (; pIndex; pIndex = chainActive.Next(pIndex)) {
@@ -561,11 +571,115 @@ inline bool ProcessGetHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
         if (--nLimit <= 0 || pIndex->GetBlockHash() == hashStop)
             break;
     }
-    pFrom->PushMessage("headers", vHeaders);
+    pFrom->PushMessage(NetMsgType::HEADERS, vHeaders);
 
     return false;
 }
 
+inline bool ProcessHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
+    vector<CBlock> vHeaders;
+    vRecv >> vHeaders;
+    if (vHeaders.size() > MAX_HEADERS_RESULTS) {
+        Misbehaving(pFrom->GetId(), 20);
+        return ERRORMSG("message headers size() = %u from peer %s", vHeaders.size(), pFrom->addrName);
+    }
+
+    if (vHeaders.empty())
+        return true;
+
+    // Make sure the headers form a chain, they are checked against the delegates below where these are known
+    for (uint32_t i = 0; i < vHeaders.size(); i++) {
+        const CBlock &header = vHeaders[i];
+        bool linked = (i == 0) || (header.GetPrevBlockHash() == vHeaders[i - 1].GetHash() &&
+                                   header.GetHeight() == vHeaders[i - 1].GetHeight() + 1);
+        if (!linked || !header.vptx.empty() ||
+            header.GetBlockTime() > GetAdjustedTime() + ::GetBlockInterval(header.GetHeight()) + 2) {
+            Misbehaving(pFrom->GetId(), 20);
+            return ERRORMSG("invalid header [%u]: %s from peer %s", header.GetHeight(), header.GetHash().ToString(),
+                            pFrom->addrName);
+        }
+    }
+
+    LOCK(cs_main);
+
+    // The active delegates of the tip produce the blocks up to a few count vote intervals ahead, the signature
+    // of the headers beyond can't be checked before the blocks in between are connected
+    vector<bool> vChecked(vHeaders.size(), false);
+    int32_t tipHeight        = chainActive.Height();
+    int32_t checkedEndHeight = chain::GetActiveDelegatesLastHeight(tipHeight, *pCdMan->pDelegateCache);
+    VoteDelegateVector activeDelegates;
+    if (pCdMan->pDelegateCache->GetActiveDelegates(activeDelegates)) {
+        for (uint32_t i = 0; i < vHeaders.size(); i++) {
+            int32_t height = vHeaders[i].GetHeight();
+            if (height > tipHeight && height <= checkedEndHeight)
+                vChecked[i] = VerifyHeaderSignature(vHeaders[i], activeDelegates, *pCdMan->pAccountCache);
+        }
+    }
+
+    if (!headersChain.Connect(mapBlockIndex, vHeaders, vChecked)) {
+        LogPrint(BCLog::NET, "recv unconnected headers! start_height=%d, prev_hash=%s, peer=%s\n",
+                 vHeaders.front().GetHeight(), vHeaders.front().GetPrevBlockHash().GetHex(), pFrom->addrName);
+        PushGetHeaders(pFrom, uint256());
+        return true;
+    }
+
+    // The peer is asked for the blocks of the headers it sent only if these made it into the headers chain
+    int32_t lastHeight = vHeaders.back().GetHeight();
+    if (!headersChain.Contains(vHeaders.back().GetHash()) && !mapBlockIndex.count(vHeaders.back().GetHash())) {
+        LogPrint(BCLog::NET, "ignore headers of a lower or unchecked branch! count=%u, last_height=%d, "
+                 "header_height=%d, peer=%s\n", vHeaders.size(), lastHeight, headersChain.Height(), pFrom->addrName);
+        return true;
+    }
+    {
+        LOCK(cs_mapNodeState);
+        CNodeState *state       = State(pFrom->GetId());
+        state->nBestKnownHeight = max(state->nBestKnownHeight, lastHeight);
+    }
+    if (lastHeight > nSyncTipHeight)
+        nSyncTipHeight = lastHeight;
+
+    LogPrint(BCLog::NET, "recv headers! count=%u, last_height=%d, header_height=%d, tip_height=%d, peer=%s\n",
+             vHeaders.size(), lastHeight, headersChain.Height(), chainActive.Height(), pFrom->addrName);
+
+    // A full reply means the peer has more headers to send
+    if (vHeaders.size() == MAX_HEADERS_RESULTS)
+        PushGetHeaders(pFrom, uint256());
+
+    return true;
+}
+
+// Requires cs_main and cs_mapNodeState.
+// Collects the lowest blocks of the download window that are neither received nor requested yet and
+// that the peer has. Once the window is exhausted, nodeStaller is set to the peer holding its first block,
+// if that block is known to exist: its header is signed by its delegate or was sent by the peer itself.
+inline void FindNextBlocksToDownload(CNode *pTo, const CNodeState &state, int32_t count, vector<uint256> &vBlocks,
+                                     NodeId &nodeStaller) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_mapNodeState);
+
+    int32_t windowEnd = chainActive.Height() + BLOCK_DOWNLOAD_WINDOW;
+    int32_t maxHeight = min(min(headersChain.Height(), windowEnd), max(state.nBestKnownHeight, pTo->nStartingHeight));
+    for (int32_t height = chainActive.Height() + 1; height <= maxHeight && (int32_t)vBlocks.size() < count; height++) {
+        uint256 hash = headersChain[height];
+        if (hash.IsNull() || mapBlockIndex.count(hash) || mapOrphanBlocks.count(hash) ||
+            mapBlocksInFlight.count(hash) || mapBlocksToDownload.count(hash))
+            continue;
+
+        vBlocks.push_back(hash);
+    }
+
+    if (vBlocks.empty() && maxHeight == windowEnd) {
+        uint256 hash = headersChain[chainActive.Height() + 1];
+        auto it      = mapBlocksInFlight.find(hash);
+        if (it != mapBlocksInFlight.end() && std::get<0>(it->second) != pTo->GetId()) {
+            CNodeState *pStallerState = State(std::get<0>(it->second));
+            if (headersChain.IsChecked(hash) ||
+                (pStallerState != nullptr && pStallerState->nBestKnownHeight > chainActive.Height()))
+                nodeStaller = std::get<0>(it->second);
+        }
+    }
+}
+
 inline void ProcessGetBlocksMessage(CNode *pFrom, CDataStream &vRecv) {
     CBlockLocator locator;
     uint256 hashStop;
@@ -705,10 +819,8 @@ inline bool ProcessGetDataMessage(CNode *pFrom, CDataStream &vRecv) {
     return true;
 }
 
-inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
-    CBlock block;
-    vRecv >> block;
-
+// Requires the block to be complete, whether it came in full or was rebuilt from a compact block.
+inline void HandleReceivedBlock(CNode *pFrom, CBlock &block) {
     LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
         block.GetHash().ToString(), pFrom->addr.ToString());
     // block.Print();
@@ -737,6 +849,146 @@ inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
 
 }
 
+inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlock block;
+    vRecv >> block;
+
+    HandleReceivedBlock(pFrom, block);
+}
+
+inline void ProcessSendCmpctMessage(CNode *pFrom, CDataStream &vRecv) {
+    bool fAnnounce;
+    uint64_t version;
+    vRecv >> fAnnounce >> version;
+
+    if (version == COMPACT_BLOCKS_VERSION)
+        pFrom->fSupportsCompactBlocks = true;
+}
+
+// Ask the peer for the full block when a compact block can not be rebuilt.
+inline void RequestFullBlock(CNode *pFrom, const uint256 &blockHash) {
+    LogPrint(BCLog::NET, "request full block %s from peer %s\n", blockHash.GetHex(), pFrom->addr.ToString());
+    vector<CInv> vGetData;
+    vGetData.push_back(CInv(MSG_BLOCK, blockHash));
+    pFrom->PushMessage(NetMsgType::GETDATA, vGetData);
+}
+
+inline void ProcessCmpctBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockHeaderAndShortTxIDs cmpctBlock;
+    vRecv >> cmpctBlock;
+
+    const uint256 blockHash = cmpctBlock.header.GetHash();
+    pFrom->AddInventoryKnown(CInv(MSG_BLOCK, blockHash));
+    {
+        LOCK(cs_main);
+        if (mapBlockIndex.count(blockHash) || mapOrphanBlocks.count(blockHash)) {
+            LogPrint(BCLog::NET, "recv cmpct block of known block %s from peer %s\n", blockHash.GetHex(),
+                     pFrom->addr.ToString());
+            return;
+        }
+    }
+
+    auto pPartialBlock        = std::make_shared<CPartiallyDownloadedBlock>();
+    CompactReadStatus status = pPartialBlock->InitData(cmpctBlock, mempool);
+    if (status == READ_STATUS_INVALID) {
+        LogPrint(BCLog::INFO, "Misbehaving: invalid cmpct block %s, nMisbehavior add 100\n", blockHash.GetHex());
+        Misbehaving(pFrom->GetId(), 100);
+        return;
+    } else if (status == READ_STATUS_FAILED) {
+        RequestFullBlock(pFrom, blockHash);
+        return;
+    }
+
+    CBlockTxRequest req;
+    req.blockHash = blockHash;
+    for (uint32_t i = 0; i < cmpctBlock.BlockTxCount(); i++) {
+        if (!pPartialBlock->IsTxAvailable(i))
+            req.indexes.push_back(i);
+    }
+
+    LogPrint(BCLog::NET, "recv cmpct block! time_ms=%lld, hash=%s, txs=%u, prefilled=%u, mempool=%u, missing=%u, peer=%s\n",
+             GetTimeMillis(), blockHash.GetHex(), cmpctBlock.BlockTxCount(), pPartialBlock->GetPrefilledCount(),
+             pPartialBlock->GetMempoolCount(), req.indexes.size(), pFrom->addr.ToString());
+
+    if (!req.indexes.empty()) {
+        {
+            LOCK(cs_mapNodeState);
+            CNodeState *state       = State(pFrom->GetId());
+            state->partialBlockHash = blockHash;
+            state->pPartialBlock    = pPartialBlock;
+        }
+        pFrom->PushMessage(NetMsgType::GETBLOCKTXN, req);
+        return;
+    }
+
+    CBlock block;
+    if (pPartialBlock->FillBlock(block, {}) != READ_STATUS_OK) {
+        RequestFullBlock(pFrom, blockHash);
+        return;
+    }
+    HandleReceivedBlock(pFrom, block);
+}
+
+inline void ProcessGetBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTxRequest req;
+    vRecv >> req;
+
+    CBlock block;
+    {
+        LOCK(cs_main);
+        auto mi = mapBlockIndex.find(req.blockHash);
+        if (mi == mapBlockIndex.end() || !(mi->second->nStatus & BLOCK_HAVE_DATA)) {
+            LogPrint(BCLog::NET, "getblocktxn of unknown block %s from peer %s\n", req.blockHash.GetHex(),
+                     pFrom->addr.ToString());
+            return;
+        }
+        if (!ReadBlockFromDisk(mi->second, block))
+            return;
+    }
+
+    CBlockTxs resp;
+    resp.blockHash = req.blockHash;
+    for (const auto index : req.indexes) {
+        if (index >= block.vptx.size()) {
+            LogPrint(BCLog::INFO, "Misbehaving: getblocktxn index out of range, nMisbehavior add 100\n");
+            Misbehaving(pFrom->GetId(), 100);
+            return;
+        }
+        resp.txs.push_back(block.vptx[index]);
+    }
+    pFrom->PushMessage(NetMsgType::BLOCKTXN, resp);
+}
+
+inline void ProcessBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTxs resp;
+    vRecv >> resp;
+
+    std::shared_ptr<CPartiallyDownloadedBlock> pPartialBlock;
+    {
+        LOCK(cs_mapNodeState);
+        CNodeState *state = State(pFrom->GetId());
+        if (state->pPartialBlock == nullptr || state->partialBlockHash != resp.blockHash) {
+            LogPrint(BCLog::NET, "unexpected blocktxn of block %s from peer %s\n", resp.blockHash.GetHex(),
+                     pFrom->addr.ToString());
+            return;
+        }
+        pPartialBlock = std::move(state->pPartialBlock);
+        state->partialBlockHash.SetNull();
+    }
+
+    CBlock block;
+    CompactReadStatus status = pPartialBlock->FillBlock(block, resp.txs);
+    if (status == READ_STATUS_INVALID) {
+        LogPrint(BCLog::INFO, "Misbehaving: invalid blocktxn of block %s, nMisbehavior add 100\n", resp.blockHash.GetHex());
+        Misbehaving(pFrom->GetId(), 100);
+        return;
+    } else if (status == READ_STATUS_FAILED) {
+        RequestFullBlock(pFrom, resp.blockHash);
+        return;
+    }
+    HandleReceivedBlock(pFrom, block);
+}
+
 inline void ProcessMempoolMessage(CNode *pFrom, CDataStream &vRecv) {
     LOCK2(cs_main, pFrom->cs_filter);
 
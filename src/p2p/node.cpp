@@ -38,10 +38,10 @@ CNodeState *State(NodeId pNode) {
 
 // requires LOCK(cs_vSend)
 void CNode::SocketSendData() {
-    deque<CSerializeData>::iterator it = vSendMsg.begin();
+    deque<CSerializeDataPtr>::iterator it = vSendMsg.begin();
 
     while (it != vSendMsg.end()) {
-        const CSerializeData& data = *it;
+        const CSerializeData& data = **it;
         assert(data.size() > nSendOffset);
         int32_t nBytes = send(hSocket, &data[nSendOffset], data.size() - nSendOffset,
                               MSG_NOSIGNAL | MSG_DONTWAIT);
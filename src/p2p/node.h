@@ -18,11 +18,16 @@
 #include "commons/random.h"
 #include "p2p/netmessage.h"
 
+#include <memory>
+
 class CNode ;
+class CPartiallyDownloadedBlock;
 struct CNodeSignals;
 struct CNodeState ;
 
 typedef int32_t NodeId;
+// a complete serialized message (header and payload), shared by the send queues of the peers it is pushed to
+typedef std::shared_ptr<const CSerializeData> CSerializeDataPtr;
 extern CCriticalSection cs_nLastNodeId;
 extern NodeId nLastNodeId;
 extern uint64_t nLocalServices;
@@ -31,6 +36,10 @@ extern CCriticalSection cs_mapLocalHost;
 extern map<NodeId, CNodeState> mapNodeState;
 extern CCriticalSection cs_mapNodeState;
 extern CNodeSignals& GetNodeSignals();
+/** Wake the socket handler, e.g. when outbound data could not be sent optimistically */
+void WakeSocketHandler();
+/** Wake the message handler when a complete message has been received */
+void WakeMessageHandler();
 
 /** The maximum number of entries in an 'inv' protocol message */
 static const uint32_t MAX_INV_SZ = 50000;
@@ -115,6 +124,10 @@ struct CNodeState {
     int32_t nBlocksToDownload;        // blocks number to be downloaded
     int64_t nLastBlockReceive;        // the latest receiving blocks time
     int64_t nLastBlockProcess;        // the latest processing blocks time
+    int64_t nStallingSince;           // since when this peer holds back the download window
+    int32_t nBestKnownHeight;         // the highest header this peer has sent us
+    uint256 partialBlockHash;         // the compact block waiting for the "blocktxn" of this peer
+    std::shared_ptr<CPartiallyDownloadedBlock> pPartialBlock;
 
     CNodeState() {
         nMisbehavior      = 0;
@@ -123,6 +136,8 @@ struct CNodeState {
         nBlocksInFlight   = 0;
         nLastBlockReceive = 0;
         nLastBlockProcess = 0;
+        nStallingSince    = 0;
+        nBestKnownHeight  = -1;
     }
 };
 
@@ -139,7 +154,7 @@ public:
     size_t nSendSize;    // total size of all vSendMsg entries
     size_t nSendOffset;  // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
-    deque<CSerializeData> vSendMsg;
+    deque<CSerializeDataPtr> vSendMsg;
     CCriticalSection cs_vSend;
 
     deque<CInv> vRecvGetData;  // strCommand == "getdata 保存的inv
@@ -172,6 +187,12 @@ public:
     // b) the peer may tell us in their version message that we should not relay tx invs
     //    until they have initialized their bloom filter.
     bool fRelayTxes;
+    // the peer announced by "sendcmpct" that it can rebuild blocks from "cmpctblock" messages
+    bool fSupportsCompactBlocks;
+    // socket readiness tracked by the epoll socket handler, only accessed from its thread
+    bool fSocketRegistered;
+    bool fSocketReadable;
+    bool fSocketWritable;
     CSemaphoreGrant grantOutbound;
     CCriticalSection cs_filter;
     CBloomFilter* pFilter;
@@ -191,6 +212,9 @@ public:
     uint256 hashContinue;                   // getblocks the next batch of inventory下一次 盘点的块
     CBlockIndex* pIndexLastGetBlocksBegin;  //上次开始的块  本地节点有的块chainActive.Tip()
     uint256 hashLastGetBlocksEnd;           // 本地节点保存的孤儿块的根块 hash GetOrphanRoot(hash)
+    uint256 hashLastGetHeadersBegin;        // best header of the last getheaders locator
+    uint256 hashLastGetHeadersEnd;
+    int64_t nLastGetHeadersTime;            // time of the last getheaders request in milliseconds
     int32_t nStartingHeight;                // Start block sync, current height
     bool fStartSync;
 
@@ -248,10 +272,17 @@ public:
         hashContinue             = uint256();
         pIndexLastGetBlocksBegin = 0;
         hashLastGetBlocksEnd     = uint256();
+        hashLastGetHeadersBegin  = uint256();
+        hashLastGetHeadersEnd    = uint256();
+        nLastGetHeadersTime      = 0;
         nStartingHeight          = -1;
         fStartSync               = false;
         fGetAddr                 = false;
         fRelayTxes               = false;
+        fSupportsCompactBlocks   = false;
+        fSocketRegistered        = false;
+        fSocketReadable          = false;
+        fSocketWritable          = false;
         setInventoryKnown.max_size(SendBufferSize() / 1000);
         setBlockConfirmMsgKnown.max_size(200);
         pFilter        = new CBloomFilter();
@@ -465,16 +496,52 @@ public:
 
             LogPrint(BCLog::NET, "(%d bytes)\n", nSize);
 
-            deque<CSerializeData>::iterator it = vSendMsg.insert(vSendMsg.end(), CSerializeData());
-            ssSend.GetAndClear(*it);
-            nSendSize += (*it).size();
+            auto pData = std::make_shared<CSerializeData>();
+            ssSend.GetAndClear(*pData);
+            nSendSize += pData->size();
+            vSendMsg.push_back(pData);
 
-            // If write queue empty, attempt "optimistic write"
-            if (it == vSendMsg.begin()) SocketSendData();
+            // If write queue empty, attempt "optimistic write", the socket handler sends the rest
+            if (vSendMsg.size() == 1) {
+                SocketSendData();
+                if (!vSendMsg.empty()) WakeSocketHandler();
+            }
 
             LEAVE_CRITICAL_SECTION(cs_vSend);
     }
 
+    // Queue a message serialized beforehand, e.g. by MakeMessage(). The bytes are shared, not copied.
+    void PushSerializedMessage(const CSerializeDataPtr &pData) {
+            LOCK(cs_vSend);
+            nSendSize += pData->size();
+            vSendMsg.push_back(pData);
+
+            // If write queue empty, attempt "optimistic write", the socket handler sends the rest
+            if (vSendMsg.size() == 1) {
+                SocketSendData();
+                if (!vSendMsg.empty()) WakeSocketHandler();
+            }
+    }
+
+    // Serialize a complete message once so that it can be pushed to many peers by PushSerializedMessage()
+    template <typename T1>
+    static CSerializeDataPtr MakeMessage(const char* pszCommand, const T1& a1) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << CMessageHeader(pszCommand, 0) << a1;
+
+        uint32_t nSize = ss.size() - CMessageHeader::HEADER_SIZE;
+        memcpy((char*)&ss[CMessageHeader::MESSAGE_SIZE_OFFSET], &nSize, sizeof(nSize));
+
+        uint256 hash       = Hash(ss.begin() + CMessageHeader::HEADER_SIZE, ss.end());
+        uint32_t nChecksum = 0;
+        memcpy(&nChecksum, &hash, sizeof(nChecksum));
+        memcpy((char*)&ss[CMessageHeader::CHECKSUM_OFFSET], &nChecksum, sizeof(nChecksum));
+
+        auto pData = std::make_shared<CSerializeData>();
+        ss.GetAndClear(*pData);
+        return pData;
+    }
+
     void PushVersion();
 
     void PushMessage(const char* pszCommand) {
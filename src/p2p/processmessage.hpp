@@ -35,6 +35,8 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
 
     else if (strCommand == NetMsgType::VERACK) {
         pFrom->SetRecvVersion(min(pFrom->nVersion, PROTOCOL_VERSION));
+        // Tell the peer we can rebuild blocks from "cmpctblock", older peers ignore the unknown command
+        pFrom->PushMessage(NetMsgType::SENDCMPCT, true, COMPACT_BLOCKS_VERSION);
     }
 
     else if (strCommand == NetMsgType::ADDR) {
@@ -61,6 +63,11 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
             return true;
     }
 
+    else if (strCommand == NetMsgType::HEADERS && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
+        if (!ProcessHeadersMessage(pFrom, vRecv))
+            return false;
+    }
+
     else if (strCommand == NetMsgType::TX) {
         if (!ProcessTxMessage(pFrom, strCommand, vRecv))
             return false;
@@ -72,6 +79,22 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
         ProcessBlockMessage(pFrom, vRecv);
     }
 
+    else if (strCommand == NetMsgType::SENDCMPCT) {
+        ProcessSendCmpctMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::CMPCTBLOCK && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
+        ProcessCmpctBlockMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::GETBLOCKTXN) {
+        ProcessGetBlockTxnMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::BLOCKTXN && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
+        ProcessBlockTxnMessage(pFrom, vRecv);
+    }
+
     else if (strCommand == NetMsgType::GETADDR) {
         pFrom->vAddrToSend.clear();
         vector<CAddress> vAddr = addrman.GetAddr();
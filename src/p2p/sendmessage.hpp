@@ -28,6 +28,7 @@ void MarkBlockAsInFlight(const uint256 &hash, NodeId nodeId) {
 
 bool SendMessages(CNode *pTo, bool fSendTrickle) {
     {
+        vector<CInv> vGetData;
         // Don't send anything until we get their version message
         if (pTo->nVersion == 0)
             return true;
@@ -120,8 +121,44 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             if (pTo->fStartSync && !SysCfg().IsImporting() && !SysCfg().IsReindex()) {
                 pTo->fStartSync = false;
                 nSyncTipHeight  = pTo->nStartingHeight;
-                LogPrint(BCLog::NET, "start block sync lead to getblocks\n");
-                PushGetBlocks(pTo, chainActive.Tip(), uint256());
+                if (pTo->nVersion >= HEADERS_FIRST_VERSION) {
+                    LogPrint(BCLog::NET, "start block sync lead to getheaders\n");
+                    PushGetHeaders(pTo, uint256());
+                } else {
+                    LogPrint(BCLog::NET, "start block sync lead to getblocks\n");
+                    PushGetBlocks(pTo, chainActive.Tip(), uint256());
+                }
+            }
+
+            //
+            // Message: getdata (blocks along the headers chain)
+            //
+            if (!pTo->fDisconnect && pTo->nVersion >= HEADERS_FIRST_VERSION && !SysCfg().IsImporting() &&
+                !SysCfg().IsReindex()) {
+                headersChain.Prune(chainActive);
+
+                LOCK(cs_mapNodeState);
+                CNodeState &state = *State(pTo->GetId());
+                if (state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+                    vector<uint256> vToDownload;
+                    NodeId nodeStaller = -1;
+                    FindNextBlocksToDownload(pTo, state, MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.nBlocksInFlight,
+                                             vToDownload, nodeStaller);
+                    for (const auto &hash : vToDownload) {
+                        vGetData.push_back(CInv(MSG_BLOCK, hash));
+                        MarkBlockAsInFlight(hash, pTo->GetId());
+                    }
+                    if (!vToDownload.empty())
+                        LogPrint(BCLog::NET, "send MSG_BLOCK msg along headers! count=%u, first_hash=%s, peer=%s, "
+                                 "FlightBlocks=%d\n", vToDownload.size(), vToDownload.front().ToString(), state.name,
+                                 state.nBlocksInFlight);
+
+                    CNodeState *pStallerState = State(nodeStaller);
+                    if (pStallerState != nullptr && pStallerState->nStallingSince == 0) {
+                        pStallerState->nStallingSince = GetTimeMicros();
+                        LogPrint(BCLog::NET, "peer %s is stalling the download window\n", pStallerState->name);
+                    }
+                }
             }
 
             // Resend wallet transactions that haven't gotten in a block yet
@@ -213,14 +250,21 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             pTo->fDisconnect = true;
         }
 
+        if (!pTo->fDisconnect && state.nStallingSince &&
+            state.nStallingSince < nNow - BLOCK_STALLING_TIMEOUT * 1000000) {
+            LogPrint(BCLog::INFO, "Peer %s is stalling the block download window, disconnecting\n", state.name.c_str());
+            pTo->fDisconnect = true;
+        }
+
         //
         // Message: getdata (blocks)
         //
-        vector<CInv> vGetData;
         int32_t index = 0;
+        // new blocks mostly hold txs of our mempool, fetch them as compact blocks once synced
+        const int32_t blockInvType = (pTo->fSupportsCompactBlocks && !IsInitialBlockDownload()) ? MSG_CMPCT_BLOCK : MSG_BLOCK;
         while (!pTo->fDisconnect && state.nBlocksToDownload && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
             uint256 hash = state.vBlocksToDownload.front();
-            vGetData.push_back(CInv(MSG_BLOCK, hash));
+            vGetData.push_back(CInv(blockInvType, hash));
             MarkBlockAsInFlight(hash, pTo->GetId());
             LogPrint(BCLog::NET, "send MSG_BLOCK msg! time_ms=%lld, hash=%s, peer=%s, FlightBlocks=%d, index=%d\n",
                 GetTimeMillis(), hash.ToString(), state.name, state.nBlocksInFlight, index++);
@@ -0,0 +1,148 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "txvalidationqueue.h"
+
+#include "config/const.h"
+#include "main.h"
+#include "net.h"
+#include "tx/txmempool.h"
+
+CTxValidationQueue txValidationQueue;
+
+void ThreadTxValidation() {
+    RenameThread("coin-txvalid");
+    txValidationQueue.Thread();
+}
+
+bool CTxValidationQueue::Push(CNode *pFrom, const std::shared_ptr<CBaseTx> &pBaseTx) {
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        auto &txs = mapPeerTxs[pFrom->GetId()];
+        if (txs.size() >= MAX_PEER_TX_VALIDATION_QUEUE)
+            return false;
+
+        if (nSize >= MAX_TX_VALIDATION_QUEUE) {
+            // make room by evicting the newest tx of the peer with the most queued txs
+            auto itMost = mapPeerTxs.begin();
+            for (auto it = mapPeerTxs.begin(); it != mapPeerTxs.end(); ++it) {
+                if (it->second.size() > itMost->second.size())
+                    itMost = it;
+            }
+            if (itMost->second.size() <= txs.size() + 1) {
+                if (txs.empty())
+                    mapPeerTxs.erase(pFrom->GetId());
+                return false;
+            }
+
+            CNode *pEvicted = itMost->second.back().pFrom;
+            LogPrint(BCLog::NET, "tx validation queue is full, evict tx %s of peer=%s\n",
+                     itMost->second.back().pBaseTx->GetHash().ToString(), pEvicted->addrName);
+            itMost->second.pop_back();
+            nSize--;
+            LOCK(cs_vNodes);
+            pEvicted->Release();
+        }
+
+        {
+            LOCK(cs_vNodes);
+            pFrom->AddRef();
+        }
+        txs.push_back({pFrom, pBaseTx});
+        nSize++;
+    }
+    cond.notify_one();
+    return true;
+}
+
+void CTxValidationQueue::PopBatch(std::vector<CQueuedTx> &vBatch, std::vector<CQueuedTx> &vDropped) {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while (nSize == 0)
+        cond.wait(lock);
+
+    // take one tx of each peer in turn
+    while (vBatch.size() < TX_VALIDATION_BATCH_SIZE && nSize > 0) {
+        auto it = mapPeerTxs.upper_bound(lastPeer);
+        if (it == mapPeerTxs.end())
+            it = mapPeerTxs.begin();
+        lastPeer = it->first;
+
+        if (it->second.front().pFrom->fDisconnect) {
+            LogPrint(BCLog::NET, "drop %u queued txs of disconnected peer=%s\n", it->second.size(),
+                     it->second.front().pFrom->addrName);
+            vDropped.insert(vDropped.end(), it->second.begin(), it->second.end());
+            nSize -= it->second.size();
+            mapPeerTxs.erase(it);
+            continue;
+        }
+
+        vBatch.push_back(it->second.front());
+        it->second.pop_front();
+        nSize--;
+        if (it->second.empty())
+            mapPeerTxs.erase(it);
+    }
+}
+
+void CTxValidationQueue::Release(const std::vector<CQueuedTx> &vTxs) {
+    LOCK(cs_vNodes);
+    for (const auto &queuedTx : vTxs)
+        queuedTx.pFrom->Release();
+}
+
+void CTxValidationQueue::Validate(const CQueuedTx &queuedTx) {
+    CNode *pFrom     = queuedTx.pFrom;
+    CBaseTx *pBaseTx = queuedTx.pBaseTx.get();
+    CInv inv(MSG_TX, pBaseTx->GetHash());
+
+    // the peer disconnected after the batch was taken, its txs are dropped as the queued ones
+    if (pFrom->fDisconnect) {
+        LogPrint(BCLog::NET, "drop tx %s of disconnected peer=%s\n", inv.hash.ToString(), pFrom->addrName);
+        return;
+    }
+
+    LOCK(cs_main);
+    CValidationState state;
+    if (AcceptToMemoryPool(mempool, state, pBaseTx, true)) {
+        RelayTransaction(pBaseTx, inv.hash);
+        mapAlreadyAskedFor.erase(inv);
+
+        LogPrint(BCLog::INFO, "AcceptToMemoryPool: %s %s : accepted %s (poolsz %u)\n", pFrom->addr.ToString(),
+                 pFrom->cleanSubVer, inv.hash.ToString(), mempool.memPoolTxs.size());
+    }
+
+    int32_t nDoS = 0;
+    if (state.IsInvalid(nDoS)) {
+        LogPrint(BCLog::INFO, "%s [%d] from %s %s was not accepted into the memory pool: %s\n",
+                 inv.hash.ToString(), pBaseTx->valid_height, pFrom->addr.ToString(), pFrom->cleanSubVer,
+                 state.GetRejectReason());
+
+        pFrom->PushMessage(NetMsgType::REJECT, string(NetMsgType::TX), state.GetRejectCode(),
+                           state.GetRejectReason(), inv.hash);
+    }
+}
+
+void CTxValidationQueue::Thread() {
+    std::vector<CQueuedTx> vBatch, vDropped;
+    std::vector<std::shared_ptr<CBaseTx>> vptx;
+    while (true) {
+        vBatch.clear();
+        vDropped.clear();
+        vptx.clear();
+        PopBatch(vBatch, vDropped);
+        Release(vDropped);
+
+        // verify the signatures of the whole batch on the script check threads, cs_main is only held
+        // per tx while it is accepted to the mempool so that block processing can interleave
+        for (const auto &queuedTx : vBatch)
+            vptx.push_back(queuedTx.pBaseTx);
+        PreVerifyTxSignatures(vptx);
+
+        for (const auto &queuedTx : vBatch)
+            Validate(queuedTx);
+
+        Release(vBatch);
+        boost::this_thread::interruption_point();
+    }
+}
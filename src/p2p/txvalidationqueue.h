@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_TXVALIDATIONQUEUE_H
+#define P2P_TXVALIDATIONQUEUE_H
+
+#include "p2p/node.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+class CBaseTx;
+
+/**
+ * Txs received from the network, waiting to be accepted to the mempool by the tx validation thread.
+ * The message handler only deserializes and queues a tx, so a burst of txs never holds cs_main on the
+ * thread which also processes the block messages of all peers. The txs of a peer are validated in
+ * arrival order, and the peers take turns within a batch so that a flooding peer can not delay the
+ * txs of the others. The txs of a disconnected peer are dropped without being validated.
+ */
+class CTxValidationQueue {
+public:
+    // false if the queue of the peer is full, or the queue of all peers is full and the peer has the most txs
+    bool Push(CNode *pFrom, const std::shared_ptr<CBaseTx> &pBaseTx);
+
+    // run by the tx validation thread, never returns
+    void Thread();
+
+private:
+    struct CQueuedTx {
+        CNode *pFrom;  // referenced while the tx is queued
+        std::shared_ptr<CBaseTx> pBaseTx;
+    };
+
+    // vDropped: the txs of the disconnected peers, to be released without validation
+    void PopBatch(std::vector<CQueuedTx> &vBatch, std::vector<CQueuedTx> &vDropped);
+    void Release(const std::vector<CQueuedTx> &vTxs);
+    void Validate(const CQueuedTx &queuedTx);
+
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    std::map<NodeId, std::deque<CQueuedTx>> mapPeerTxs;
+    NodeId lastPeer = -1;  // the peer served last, the next turn starts after it
+    size_t nSize    = 0;
+};
+
+extern CTxValidationQueue txValidationQueue;
+
+void ThreadTxValidation();
+
+#endif  // P2P_TXVALIDATIONQUEUE_H
@@ -5,6 +5,7 @@
 
 #include "block.h"
 
+#include "crypto/sha256.h"
 #include "entities/account.h"
 #include "tx/blockpricemediantx.h"
 #include "main.h"
@@ -25,16 +26,25 @@ uint256 CBlockHeader::ComputeSignatureHash() const {
 }
 
 uint256 CBlock::BuildMerkleTree() const {
+    size_t nNodes = vptx.size();
+    for (size_t nSize = vptx.size(); nSize > 1; nSize = (nSize + 1) / 2)
+        nNodes += (nSize + 1) / 2;
+
     vMerkleTree.clear();
+    vMerkleTree.reserve(nNodes);
     for (const auto& ptx : vptx) {
         vMerkleTree.push_back(ptx->GetHash());
     }
-    int32_t j = 0;
-    for (int32_t nSize = vptx.size(); nSize > 1; nSize = (nSize + 1) / 2) {
-        for (int32_t i = 0; i < nSize; i += 2) {
-            int32_t i2 = min(i + 1, nSize - 1);
-            vMerkleTree.push_back(Hash(BEGIN(vMerkleTree[j + i]), END(vMerkleTree[j + i]),
-                                       BEGIN(vMerkleTree[j + i2]), END(vMerkleTree[j + i2])));
+    size_t j = 0;
+    for (size_t nSize = vptx.size(); nSize > 1; nSize = (nSize + 1) / 2) {
+        // the pairs of a level are contiguous 64-byte blobs, hashed in multi-lane batches by SHA256D64()
+        size_t nPairs = nSize / 2;
+        vMerkleTree.resize(j + nSize + (nSize + 1) / 2);
+        SHA256D64(vMerkleTree[j + nSize].begin(), vMerkleTree[j].begin(), nPairs);
+        if (nSize & 1) {
+            // the last node of an odd level is paired with itself
+            const uint256 &last = vMerkleTree[j + nSize - 1];
+            vMerkleTree[j + nSize + nPairs] = Hash(BEGIN(last), END(last), BEGIN(last), END(last));
         }
         j += nSize;
     }
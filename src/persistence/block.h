@@ -325,6 +325,8 @@ public:
         block.SetTime(nTime);
         block.SetNonce(nNonce);
         block.SetHeight(height);
+        block.SetFuel(nFuel);
+        block.SetFuelRate(nFuelRate);
         block.SetSignature(vSignature);
 
         return block;
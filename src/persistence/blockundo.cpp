@@ -110,7 +110,7 @@ bool CBlockUndoExecutor::Execute() {
                 return ERRORMSG("%s(), unfound prefix in db! prefix_type=%s", __FUNCTION__,
                                 opLogPair.first);
             }
-            funcMapIt->second(opLogPair.second);
+            funcMapIt->second.undo(opLogPair.second);
         }
     }
     return true;
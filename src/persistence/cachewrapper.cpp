@@ -7,6 +7,8 @@
 #include "main.h"
 #include "logging.h"
 
+#include <algorithm>
+
 ////////////////////////////////////////////////////////////////////////////////
 // class CCacheWrapper
 
@@ -144,50 +146,65 @@ UndoDataFuncMap CCacheWrapper::GetUndoDataFuncMap() {
     return undoDataFuncMap;
 }
 
+bool CCacheWrapper::DropData(const CDBKeySet &keySet) {
+    const UndoDataFuncMap &undoDataFuncMap = GetUndoDataFuncMap();
+
+    for (const auto &keysPair : keySet.GetMap()) {
+        dbk::PrefixType prefixType = dbk::ParseKeyPrefixType(keysPair.first);
+        auto funcMapIt = undoDataFuncMap.find(prefixType);
+        if (funcMapIt == undoDataFuncMap.end())
+            return ERRORMSG("%s(), unfound prefix in cache! prefix_type=%s", __FUNCTION__, keysPair.first);
+
+        funcMapIt->second.drop(keysPair.second);
+    }
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // class CCacheDBManager
 
 CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
     const boost::filesystem::path& dbDir = GetDataDir() / "blocks";
-    pSysParamDb     = new CDBAccess(dbDir, DBNameType::SYSPARAM, false, fReIndex);
+    pSysParamDb     = new CDBAccess(dbDir, DBNameType::SYSPARAM, fMemory, fReIndex);
     pSysParamCache  = new CSysParamDBCache(pSysParamDb);
 
-    pAccountDb      = new CDBAccess(dbDir, DBNameType::ACCOUNT, false, fReIndex);
+    pAccountDb      = new CDBAccess(dbDir, DBNameType::ACCOUNT, fMemory, fReIndex);
     pAccountCache   = new CAccountDBCache(pAccountDb);
 
-    pAssetDb        = new CDBAccess(dbDir, DBNameType::ASSET, false, fReIndex);
+    pAssetDb        = new CDBAccess(dbDir, DBNameType::ASSET, fMemory, fReIndex);
     pAssetCache     = new CAssetDBCache(pAssetDb);
 
-    pContractDb     = new CDBAccess(dbDir, DBNameType::CONTRACT, false, fReIndex);
+    pContractDb     = new CDBAccess(dbDir, DBNameType::CONTRACT, fMemory, fReIndex);
     pContractCache  = new CContractDBCache(pContractDb);
 
-    pDelegateDb     = new CDBAccess(dbDir, DBNameType::DELEGATE, false, fReIndex);
+    pDelegateDb     = new CDBAccess(dbDir, DBNameType::DELEGATE, fMemory, fReIndex);
     pDelegateCache  = new CDelegateDBCache(pDelegateDb);
+    pDelegateCache->InitVoteIndex();
 
-    pCdpDb          = new CDBAccess(dbDir, DBNameType::CDP, false, fReIndex);
+    pCdpDb          = new CDBAccess(dbDir, DBNameType::CDP, fMemory, fReIndex);
     pCdpCache       = new CCdpDBCache(pCdpDb);
 
-    pClosedCdpDb    = new CDBAccess(dbDir, DBNameType::CLOSEDCDP, false, fReIndex);
+    pClosedCdpDb    = new CDBAccess(dbDir, DBNameType::CLOSEDCDP, fMemory, fReIndex);
     pClosedCdpCache = new CClosedCdpDBCache(pClosedCdpDb);
 
-    pDexDb          = new CDBAccess(dbDir, DBNameType::DEX, false, fReIndex);
+    pDexDb          = new CDBAccess(dbDir, DBNameType::DEX, fMemory, fReIndex);
     pDexCache       = new CDexDBCache(pDexDb);
 
-    pBlockIndexDb   = new CBlockIndexDB(false, fReIndex);
+    pBlockIndexDb   = new CBlockIndexDB(fMemory, fReIndex);
 
-    pBlockDb        = new CDBAccess(dbDir, DBNameType::BLOCK, false, fReIndex);
+    pBlockDb        = new CDBAccess(dbDir, DBNameType::BLOCK, fMemory, fReIndex);
     pBlockCache     = new CBlockDBCache(pBlockDb);
 
-    pLogDb          = new CDBAccess(dbDir, DBNameType::LOG, false, fReIndex);
+    pLogDb          = new CDBAccess(dbDir, DBNameType::LOG, fMemory, fReIndex);
     pLogCache       = new CLogDBCache(pLogDb);
 
-    pReceiptDb      = new CDBAccess(dbDir, DBNameType::RECEIPT, false, fReIndex);
+    pReceiptDb      = new CDBAccess(dbDir, DBNameType::RECEIPT, fMemory, fReIndex);
     pReceiptCache   = new CTxReceiptDBCache(pReceiptDb);
 
-    pUtxoDb         = new CDBAccess(dbDir, DBNameType::UTXO, false, fReIndex);
+    pUtxoDb         = new CDBAccess(dbDir, DBNameType::UTXO, fMemory, fReIndex);
     pUtxoCache      = new CTxUTXODBCache(pUtxoDb);
 
-    pSysGovernDb    = new CDBAccess(dbDir, DBNameType::SYSGOVERN, false, fReIndex);
+    pSysGovernDb    = new CDBAccess(dbDir, DBNameType::SYSGOVERN, fMemory, fReIndex);
     pSysGovernCache = new CSysGovernDBCache(pSysGovernDb);
 
     // memory-only cache
@@ -195,6 +212,57 @@ CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
     pPpCache        = new CPricePointMemCache();
 }
 
+CCacheDBManager::CCacheDBManager(const std::shared_ptr<CDBSnapshot> &pSnapshotIn) {
+    pSnapshot       = pSnapshotIn;
+    fSnapshotView   = true;
+
+    pSysParamDb     = pSnapshot->pSysParamDb.get();
+    pSysParamCache  = new CSysParamDBCache(pSysParamDb);
+
+    pAccountDb      = pSnapshot->pAccountDb.get();
+    pAccountCache   = new CAccountDBCache(pAccountDb);
+
+    pAssetDb        = pSnapshot->pAssetDb.get();
+    pAssetCache     = new CAssetDBCache(pAssetDb);
+
+    pContractDb     = pSnapshot->pContractDb.get();
+    pContractCache  = new CContractDBCache(pContractDb);
+
+    pDelegateDb     = pSnapshot->pDelegateDb.get();
+    pDelegateCache  = new CDelegateDBCache(pDelegateDb);
+
+    pCdpDb          = pSnapshot->pCdpDb.get();
+    pCdpCache       = new CCdpDBCache(pCdpDb);
+
+    pClosedCdpDb    = pSnapshot->pClosedCdpDb.get();
+    pClosedCdpCache = new CClosedCdpDBCache(pClosedCdpDb);
+
+    pDexDb          = pSnapshot->pDexDb.get();
+    pDexCache       = new CDexDBCache(pDexDb);
+
+    // the block index is kept in memory, guarded by cs_main
+    pBlockIndexDb   = nullptr;
+
+    pBlockDb        = pSnapshot->pBlockDb.get();
+    pBlockCache     = new CBlockDBCache(pBlockDb);
+
+    pLogDb          = pSnapshot->pLogDb.get();
+    pLogCache       = new CLogDBCache(pLogDb);
+
+    pReceiptDb      = pSnapshot->pReceiptDb.get();
+    pReceiptCache   = new CTxReceiptDBCache(pReceiptDb);
+
+    pUtxoDb         = pSnapshot->pUtxoDb.get();
+    pUtxoCache      = new CTxUTXODBCache(pUtxoDb);
+
+    pSysGovernDb    = pSnapshot->pSysGovernDb.get();
+    pSysGovernCache = new CSysGovernDBCache(pSysGovernDb);
+
+    // memory-only cache, not covered by the snapshot
+    pTxCache        = new CTxMemCache();
+    pPpCache        = new CPricePointMemCache();
+}
+
 CCacheDBManager::~CCacheDBManager() {
     delete pSysParamCache;  pSysParamCache = nullptr;
     delete pAccountCache;   pAccountCache = nullptr;
@@ -210,6 +278,17 @@ CCacheDBManager::~CCacheDBManager() {
     delete pSysGovernCache; pSysGovernCache = nullptr;
     delete pUtxoCache;      pUtxoCache = nullptr;
 
+    // memory-only cache
+    delete pTxCache;        pTxCache = nullptr;
+    delete pPpCache;        pPpCache = nullptr;
+
+    // the dbs of a view are owned by its snapshot
+    if (fSnapshotView)
+        return;
+
+    // release the leveldb snapshots before their dbs
+    pSnapshot.reset();
+
     delete pSysParamDb;     pSysParamDb = nullptr;
     delete pAccountDb;      pAccountDb = nullptr;
     delete pAssetDb;        pAssetDb = nullptr;
@@ -224,13 +303,18 @@ CCacheDBManager::~CCacheDBManager() {
     delete pReceiptDb;      pReceiptDb = nullptr;
     delete pSysGovernDb;    pSysGovernDb = nullptr;
     delete pUtxoDb;         pUtxoDb = nullptr;
-
-    // memory-only cache
-    delete pTxCache;        pTxCache = nullptr;
-    delete pPpCache;        pPpCache = nullptr;
 }
 
-bool CCacheDBManager::Flush() {
+bool CCacheDBManager::Flush(bool fSync) {
+    // Collect the dirty caches of every db into one pending batch per db, so a flush costs one
+    // write per db instead of one per prefix cache.
+    vector<CDBAccess *> stateDbs = GetStateDbs();
+    for (auto pDb : stateDbs)
+        pDb->BeginBatch();
+    pBlockDb->BeginBatch();
+
+    uint256 bestBlockHash = pBlockCache->GetBestBlockHash();
+
     if (pSysParamCache) pSysParamCache->Flush();
 
     if (pAccountCache) pAccountCache->Flush();
@@ -265,5 +349,165 @@ bool CCacheDBManager::Flush() {
     // if (pPpCache)
     //     pPpCache->Flush();
 
+    // Every state db records the block it is flushed at in the batch of its changes, so a crash in the
+    // middle of the flush leaves dbs that disagree on it, which RecoverFlushedState() detects at startup.
+    if (bestBlockHash != flushedBlockHash) {
+        for (auto pDb : stateDbs)
+            pDb->BatchWrite(dbk::FLUSHED_BLOCKHASH, bestBlockHash);
+    }
+
+    // The dbs are separate leveldb instances, so a synced flush is made atomic by a redo record: the
+    // batches of all the dbs are written to the block db first, in one synced write, and a crash after
+    // it is finished by RecoverFlushedState() writing them again. Each batch is still synced, it must be
+    // durable before the record is erased. The unsynced flushes of the initial block download have no
+    // redo record, a crash in the middle of one is only detected.
+    bool fRedo = fSync && WriteFlushRedo();
+
+    // The block db goes first: a crash before the state dbs are written leaves them behind the best
+    // block, and connecting the blocks after their flushed block again rewrites the same block db data.
+    pBlockDb->CommitBatch(fSync);
+
+    for (auto pDb : stateDbs)
+        pDb->CommitBatch(fSync);
+
+    if (fRedo)
+        EraseFlushRedo(false);
+
+    flushedBlockHash = bestBlockHash;
+
     return true;
 }
+
+bool CCacheDBManager::WriteFlushRedo() {
+    CLevelDBBatch redoBatch;
+    for (auto pDb : GetFlushDbs()) {
+        string redo = pDb->GetPendingRedo();
+        if (!redo.empty())
+            redoBatch.Write(dbk::GenDbKey(dbk::FLUSH_REDO, GetDbName(pDb->GetDbNameType())), redo);
+    }
+    if (redoBatch.IsEmpty())
+        return false;
+
+    pBlockDb->WriteBatch(redoBatch, true);
+    return true;
+}
+
+void CCacheDBManager::EraseFlushRedo(bool fSync) {
+    CLevelDBBatch redoBatch;
+    for (auto pDb : GetFlushDbs())
+        redoBatch.Erase(dbk::GenDbKey(dbk::FLUSH_REDO, GetDbName(pDb->GetDbNameType())));
+    pBlockDb->WriteBatch(redoBatch, fSync);
+}
+
+bool CCacheDBManager::RecoverFlushedState() {
+    // a synced flush interrupted after its redo record was written is finished here. The batches of the
+    // dbs already written are written again with the same data.
+    bool fRedo = false;
+    for (auto pDb : GetFlushDbs()) {
+        string redo;
+        if (!pBlockDb->GetData(dbk::FLUSH_REDO, GetDbName(pDb->GetDbNameType()), redo))
+            continue;
+
+        CLevelDBBatch batch;
+        if (!batch.LoadRedo(redo))
+            return ERRORMSG("RecoverFlushedState() : corrupted flush redo record of db %s",
+                            GetDbName(pDb->GetDbNameType()));
+        pDb->WriteBatch(batch, true);
+        fRedo = true;
+    }
+    if (fRedo) {
+        LogPrint(BCLog::INFO, "RecoverFlushedState() : finished the flush interrupted by the last shutdown\n");
+        EraseFlushRedo(true);
+    }
+
+    uint256 stateBlockHash;
+    int32_t nMarked = 0;
+    vector<CDBAccess *> stateDbs = GetStateDbs();
+    for (auto pDb : stateDbs) {
+        uint256 blockHash;
+        if (!pDb->GetData(dbk::FLUSHED_BLOCKHASH, blockHash))
+            continue;
+        if (nMarked++ > 0 && blockHash != stateBlockHash)
+            return ERRORMSG("RecoverFlushedState() : state dbs flushed at different blocks %s and %s",
+                            stateBlockHash.GetHex(), blockHash.GetHex());
+        stateBlockHash = blockHash;
+    }
+
+    if (nMarked == 0) // dbs written before the flushed block was recorded
+        return true;
+    if (nMarked != (int32_t)stateDbs.size())
+        return ERRORMSG("RecoverFlushedState() : only %d of %u state dbs record the flushed block", nMarked,
+                        stateDbs.size());
+
+    // Flush() writes the block db before the state dbs, so after a crash between the two the best block
+    // is ahead of the state dbs. The state of the blocks after the flushed one was never written, those
+    // blocks are still in the block files and index, and ActivateBestChain() connects them again at
+    // startup, which rewrites their tx positions and the other block db data of the lost flush.
+    if (stateBlockHash != pBlockCache->GetBestBlockHash()) {
+        LogPrint(BCLog::INFO, "RecoverFlushedState() : state dbs are behind the best block %s, connect the blocks "
+                 "after block %s again\n", pBlockCache->GetBestBlockHash().GetHex(), stateBlockHash.GetHex());
+        pBlockCache->SetBestBlock(stateBlockHash);
+        pBlockCache->Flush();
+    }
+    flushedBlockHash = stateBlockHash;
+
+    return true;
+}
+
+vector<CDBAccess *> CCacheDBManager::GetStateDbs() const {
+    return {pSysParamDb, pAccountDb, pAssetDb,     pContractDb, pDelegateDb, pCdpDb,
+            pClosedCdpDb, pDexDb,    pLogDb,       pReceiptDb,  pSysGovernDb, pUtxoDb};
+}
+
+vector<CDBAccess *> CCacheDBManager::GetFlushDbs() const {
+    vector<CDBAccess *> flushDbs = GetStateDbs();
+    flushDbs.push_back(pBlockDb);
+    return flushDbs;
+}
+
+void CCacheDBManager::UpdateSnapshot(int32_t height) {
+    assert(!fSnapshotView);
+    auto pNewSnapshot = std::make_shared<CDBSnapshot>(*this, height);
+
+    std::lock_guard<std::mutex> lock(csSnapshot);
+    // the previous snapshot is released when the last view of it is done
+    pSnapshot = pNewSnapshot;
+}
+
+std::unique_ptr<CCacheDBManager> CCacheDBManager::NewSnapshotView() {
+    std::shared_ptr<CDBSnapshot> pLatestSnapshot;
+    {
+        std::lock_guard<std::mutex> lock(csSnapshot);
+        pLatestSnapshot = pSnapshot;
+    }
+    if (!pLatestSnapshot)
+        return nullptr;
+
+    return std::make_unique<CCacheDBManager>(pLatestSnapshot);
+}
+
+CDBSnapshot::CDBSnapshot(CCacheDBManager &cdMan, int32_t heightIn) : height(heightIn) {
+    auto newSnapshotDb = [](CDBAccess *pDb) { return std::make_shared<CDBAccess>(*pDb, pDb->NewSnapshot()); };
+
+    pSysParamDb  = newSnapshotDb(cdMan.pSysParamDb);
+    pAccountDb   = newSnapshotDb(cdMan.pAccountDb);
+    pAssetDb     = newSnapshotDb(cdMan.pAssetDb);
+    pContractDb  = newSnapshotDb(cdMan.pContractDb);
+    pDelegateDb  = newSnapshotDb(cdMan.pDelegateDb);
+    pCdpDb       = newSnapshotDb(cdMan.pCdpDb);
+    pClosedCdpDb = newSnapshotDb(cdMan.pClosedCdpDb);
+    pDexDb       = newSnapshotDb(cdMan.pDexDb);
+    pBlockDb     = newSnapshotDb(cdMan.pBlockDb);
+    pLogDb       = newSnapshotDb(cdMan.pLogDb);
+    pReceiptDb   = newSnapshotDb(cdMan.pReceiptDb);
+    pUtxoDb      = newSnapshotDb(cdMan.pUtxoDb);
+    pSysGovernDb = newSnapshotDb(cdMan.pSysGovernDb);
+
+    blockHash = cdMan.pBlockCache->GetBestBlockHash();
+}
+
+void CCacheDBManager::InitBloomFilters() {
+    pAccountCache->regId2KeyIdCache.InitBloomFilter();
+    pAccountCache->accountCache.InitBloomFilter();
+    pDexCache->activeOrderCache.InitBloomFilter();
+}
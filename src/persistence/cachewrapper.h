@@ -22,6 +22,9 @@
 #include "sysgoverndb.h"
 #include "logdb.h"
 
+#include <memory>
+#include <mutex>
+
 class CCacheDBManager;
 
 class CCacheWrapper {
@@ -57,6 +60,9 @@ public:
 
     UndoDataFuncMap GetUndoDataFuncMap();
 
+    // drop the keys from this cache level, so that they are read from base again
+    bool DropData(const CDBKeySet &keySet);
+
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap);
 private:
     CCacheWrapper(const CCacheWrapper&) = delete;
@@ -64,6 +70,34 @@ private:
 
 };
 
+/**
+ * Read-only state dbs pinned at the leveldb snapshots taken right after a flush, which is consistent across
+ * the dbs. It is shared by the query views running without cs_main.
+ */
+class CDBSnapshot {
+public:
+    int32_t height;
+    uint256 blockHash;
+
+    std::shared_ptr<CDBAccess> pSysParamDb;
+    std::shared_ptr<CDBAccess> pAccountDb;
+    std::shared_ptr<CDBAccess> pAssetDb;
+    std::shared_ptr<CDBAccess> pContractDb;
+    std::shared_ptr<CDBAccess> pDelegateDb;
+    std::shared_ptr<CDBAccess> pCdpDb;
+    std::shared_ptr<CDBAccess> pClosedCdpDb;
+    std::shared_ptr<CDBAccess> pDexDb;
+    std::shared_ptr<CDBAccess> pBlockDb;
+    std::shared_ptr<CDBAccess> pLogDb;
+    std::shared_ptr<CDBAccess> pReceiptDb;
+    std::shared_ptr<CDBAccess> pUtxoDb;
+    std::shared_ptr<CDBAccess> pSysGovernDb;
+
+public:
+    // must be taken when all caches of pCdMan are flushed, and no flush is running
+    CDBSnapshot(CCacheDBManager &cdMan, int32_t heightIn);
+};
+
 class CCacheDBManager {
 public:
     CDBAccess           *pSysParamDb;
@@ -112,11 +146,45 @@ public:
     CPricePointMemCache *pPpCache;
 
 public:
+    // fMemory keeps all the dbs in memory, for the tests and benchmarks
     CCacheDBManager(bool fReIndex, bool fMemory);
+    // read-only view over the snapshot, with caches of its own, used by one query at a time
+    CCacheDBManager(const std::shared_ptr<CDBSnapshot> &pSnapshotIn);
 
     ~CCacheDBManager();
 
-    bool Flush();
+    // pin the state dbs just flushed for the tip of the height, as the snapshot of the following queries
+    void UpdateSnapshot(int32_t height);
+    // a view of the latest snapshot for a query running without cs_main, nullptr before the first snapshot
+    std::unique_ptr<CCacheDBManager> NewSnapshotView();
+    // the height of the tip the view was taken at
+    int32_t GetSnapshotHeight() const { return pSnapshot ? pSnapshot->height : -1; }
+
+    // fSync=false leaves the writes in the OS buffers, as the many flushes of the initial block download do
+    bool Flush(bool fSync = true);
+
+    // Finish the synced flush interrupted by a crash, then make the best block the one all the state dbs
+    // were last flushed at, so the blocks after it are connected again. Returns false if the previous
+    // unsynced Flush() left the state dbs at different blocks.
+    bool RecoverFlushedState();
+
+    // build the bloom filters of the db keys frequently looked up for non-existent keys
+    void InitBloomFilters();
+
+private:
+    vector<CDBAccess *> GetStateDbs() const;
+    // the state dbs and the block db, all the dbs written by Flush()
+    vector<CDBAccess *> GetFlushDbs() const;
+    // write the redo record of the pending batches to the block db, false if they are all empty
+    bool WriteFlushRedo();
+    void EraseFlushRedo(bool fSync);
+
+    // the block the state dbs were last flushed at
+    uint256 flushedBlockHash;
+    // the latest snapshot of the base manager, or the pinned snapshot of a view
+    std::shared_ptr<CDBSnapshot> pSnapshot;
+    bool fSnapshotView = false;
+    std::mutex csSnapshot;
 };  // CCacheDBManager
 
 #endif //PERSIST_CACHEWRAPPER_H
\ No newline at end of file
@@ -6,13 +6,18 @@
 #ifndef PERSIST_DB_ACCESS_H
 #define PERSIST_DB_ACCESS_H
 
+#include "commons/bloom.h"
+#include "commons/random.h"
 #include "commons/uint256.h"
+#include "config/const.h"
 #include "dbconf.h"
 #include "leveldbwrapper.h"
 
+#include <functional>
 #include <string>
 #include <tuple>
 #include <vector>
+#include <memory>
 #include <optional>
 
 using namespace std;
@@ -262,7 +267,13 @@ namespace db_util {
 };
 
 typedef void(UndoDataFunc)(const CDbOpLogs &pDbOpLogs);
-typedef std::map<dbk::PrefixType, std::function<UndoDataFunc>> UndoDataFuncMap;
+typedef void(DropDataFunc)(const set<string> &keys);
+
+struct UndoDataFuncs {
+    std::function<UndoDataFunc> undo;   // restore the old values of the op logs
+    std::function<DropDataFunc> drop;   // drop the serialized keys from the cache level
+};
+typedef std::map<dbk::PrefixType, UndoDataFuncs> UndoDataFuncMap;
 
 class CDBAccess {
 public:
@@ -270,11 +281,18 @@ public:
               dbNameType(dbNameTypeIn),
               db( dir / ::GetDbName(dbNameTypeIn), DBCacheSize[dbNameTypeIn], fMemory, fWipe ) {}
 
+    // read-only access to the base db at the snapshot, see CLevelDBWrapper
+    CDBAccess(CDBAccess &baseDb, const leveldb::Snapshot *pSnapshot) :
+              dbNameType(baseDb.dbNameType),
+              db(baseDb.db, pSnapshot) {}
+
+    const leveldb::Snapshot *NewSnapshot() { return db.NewSnapshot(); }
+
     int64_t GetDbCount() const { return db.GetDbCount(); }
     template<typename KeyType, typename ValueType>
     bool GetData(const dbk::PrefixType prefixType, const KeyType &key, ValueType &value) const {
-        string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Read(keyStr, value);
+        dbk::CDbKey dbKey(prefixType, key);
+        return db.Read(dbKey.GetSlice(), value);
     }
 
     template<typename ValueType>
@@ -290,10 +308,8 @@ public:
         uint32_t count             = 0;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
 
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; (count < maxNum) && pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -331,10 +347,8 @@ public:
         ValueType value;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
 
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -347,7 +361,7 @@ public:
 
                 // Got an valid element.
                 const auto &slValue = pCursor->value();
-                CDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
+                CReadOnlyDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
                 ds >> value;
                 auto ret = elements.emplace(key, value);
                 if (!ret.second)
@@ -388,7 +402,7 @@ public:
 
                 // Got an valid element.
                 leveldb::Slice slValue = pCursor->value();
-                CDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
+                CReadOnlyDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
                 ds >> value;
                 auto ret = elements.emplace(key, value);
                 if (!ret.second)
@@ -408,10 +422,8 @@ public:
         KeyType key;
         ValueType value;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -430,7 +442,7 @@ public:
                 } else {
                     // Got an valid element.
                     leveldb::Slice slValue = pCursor->value();
-                    CDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
+                    CReadOnlyDataStream ds(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
                     ds >> value;
                     auto ret = elements.emplace(key, value);
                     if (!ret.second)
@@ -446,35 +458,93 @@ public:
 
     template<typename KeyType, typename ValueType>
     bool HaveData(const dbk::PrefixType prefixType, const KeyType &key) const {
-        string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Exists(keyStr);
+        dbk::CDbKey dbKey(prefixType, key);
+        return db.Exists(dbKey.GetSlice());
     }
 
     template<typename KeyType, typename ValueType>
     void BatchWrite(const dbk::PrefixType prefixType, const map<KeyType, ValueType> &mapData) {
         CLevelDBBatch batch;
-        for (auto item : mapData) {
-            string key = dbk::GenDbKey(prefixType, item.first);
+        CLevelDBBatch &target = pPendingBatch ? *pPendingBatch : batch;
+        for (const auto &item : mapData) {
+            dbk::CDbKey dbKey(prefixType, item.first);
             if (db_util::IsEmpty(item.second)) {
-                batch.Erase(key);
+                target.Erase(dbKey.GetSlice());
             } else {
-                batch.Write(key, item.second);
+                target.Write(dbKey.GetSlice(), item.second);
             }
         }
-        db.WriteBatch(batch, true);
+        if (!pPendingBatch)
+            db.WriteBatch(batch, true);
     }
 
     template<typename ValueType>
     void BatchWrite(const dbk::PrefixType prefixType, ValueType &value) {
         CLevelDBBatch batch;
+        CLevelDBBatch &target = pPendingBatch ? *pPendingBatch : batch;
         const string prefix = dbk::GetKeyPrefix(prefixType);
 
         if (db_util::IsEmpty(value)) {
-            batch.Erase(prefix);
+            target.Erase(prefix);
         } else {
-            batch.Write(prefix, value);
+            target.Write(prefix, value);
         }
-        db.WriteBatch(batch, true);
+        if (!pPendingBatch)
+            db.WriteBatch(batch, true);
+    }
+
+    // write single value directly to db, bypass the pending batch
+    template<typename ValueType>
+    void WriteData(const dbk::PrefixType prefixType, const ValueType &value, bool fSync) {
+        db.Write(dbk::GetKeyPrefix(prefixType), value, fSync);
+    }
+
+    /**
+     * Begin collecting all following BatchWrite() calls into one pending batch, instead of
+     * writing every prefix cache to db with its own sync write. Must be ended by CommitBatch().
+     */
+    void BeginBatch() {
+        pPendingBatch = std::make_unique<CLevelDBBatch>();
+    }
+
+    bool HasPendingWrites() const {
+        return pPendingBatch && !pPendingBatch->IsEmpty();
+    }
+
+    // the puts and deletes of the pending batch, see CLevelDBBatch::GetRedo()
+    std::string GetPendingRedo() const {
+        return pPendingBatch ? pPendingBatch->GetRedo() : std::string();
+    }
+
+    // write the batch to db at once, bypass the pending batch
+    void WriteBatch(CLevelDBBatch &batch, bool fSync) {
+        db.WriteBatch(batch, fSync);
+    }
+
+    // write the pending batch to db in one atomic leveldb write
+    void CommitBatch(bool fSync) {
+        assert(pPendingBatch);
+        auto pBatch = std::move(pPendingBatch);
+        if (!pBatch->IsEmpty())
+            db.WriteBatch(*pBatch, fSync);
+    }
+
+    // call func for each raw db key of the prefix type, return the key count
+    uint64_t TraverseKeys(const dbk::PrefixType prefixType, const std::function<void(const leveldb::Slice&)> &func) {
+        uint64_t count = 0;
+        shared_ptr<leveldb::Iterator> pCursor = NewIterator();
+        const string &prefix = dbk::GetKeyPrefix(prefixType);
+
+        for (pCursor->Seek(prefix); pCursor->Valid(); pCursor->Next()) {
+            boost::this_thread::interruption_point();
+
+            leveldb::Slice slKey = pCursor->key();
+            if (!slKey.starts_with(prefix))  // the rest key is other prefix type
+                break;
+            func(slKey);
+            ++count;
+        }
+        return count;
     }
 
     DBNameType GetDbNameType() const { return dbNameType; }
@@ -485,6 +555,7 @@ public:
 private:
     DBNameType dbNameType;
     mutable CLevelDBWrapper db; // // TODO: remove the mutable declare
+    std::unique_ptr<CLevelDBBatch> pPendingBatch = nullptr;
 };
 
 template<int32_t PREFIX_TYPE_VALUE, typename __KeyType, typename __ValueType>
@@ -531,6 +602,7 @@ public:
     }
 
     bool GetTopNElements(const uint32_t maxNum, set<KeyType> &keys) {
+        AddReadAllKeys();
         // 1. Get all candidate elements.
         set<KeyType> expiredKeys;
         set<KeyType> candidateKeys;
@@ -553,6 +625,7 @@ public:
 
     // map<string, ValueType>
     bool GetAllElements(const KeyType &endKey, Map &elements) {
+        AddReadAllKeys();
         set<KeyType> expiredKeys;
         if (!GetAllElements(endKey, elements, expiredKeys)) {
             // TODO: log
@@ -563,6 +636,7 @@ public:
     }
 
     bool GetAllElements(map<KeyType, ValueType> &elements) {
+        AddReadAllKeys();
         set<KeyType> expiredKeys;
         if (!GetAllElements(expiredKeys, elements)) {
             // TODO: log
@@ -576,9 +650,10 @@ public:
         if (db_util::IsEmpty(key)) {
             return false;
         }
-        auto it = GetDataIt(key);
-        if (it != mapData.end() && !db_util::IsEmpty(it->second)) {
-            value = it->second;
+        AddReadKey(key);
+        const ValueType *pValue = FindData(key);
+        if (pValue != nullptr && !db_util::IsEmpty(*pValue)) {
+            value = *pValue;
             return true;
         }
         return false;
@@ -590,8 +665,14 @@ public:
         }
         auto it = GetDataIt(key);
         if (it == mapData.end()) {
-            auto pEmptyValue = db_util::MakeEmptyValue<ValueType>();
-            AddOpLog(key, *pEmptyValue, &value);
+            // copy on write: only the new value is materialized at this level
+            const ValueType *pOldValue = (pBase != nullptr) ? pBase->FindData(key) : nullptr;
+            if (pOldValue != nullptr) {
+                AddOpLog(key, *pOldValue, &value);
+            } else {
+                auto pEmptyValue = db_util::MakeEmptyValue<ValueType>();
+                AddOpLog(key, *pEmptyValue, &value);
+            }
             AddDataToMap(key, value);
         } else {
             AddOpLog(key, it->second, &value);
@@ -605,8 +686,9 @@ public:
         if (db_util::IsEmpty(key)) {
             return false;
         }
-        auto it = GetDataIt(key);
-        return it != mapData.end() && !db_util::IsEmpty(it->second);
+        AddReadKey(key);
+        const ValueType *pValue = FindData(key);
+        return pValue != nullptr && !db_util::IsEmpty(*pValue);
     }
 
     bool EraseData(const KeyType &key) {
@@ -619,6 +701,13 @@ public:
             AddOpLog(key, it->second, nullptr);
             db_util::SetEmpty(it->second);
             IncDataSize(it->second);
+        } else if (it == mapData.end() && pBase != nullptr) {
+            const ValueType *pOldValue = pBase->FindData(key);
+            if (pOldValue != nullptr && !db_util::IsEmpty(*pOldValue)) {
+                AddOpLog(key, *pOldValue, nullptr);
+                auto pEmptyValue = db_util::MakeEmptyValue<ValueType>();
+                AddDataToMap(key, *pEmptyValue);
+            }
         }
         return true;
     }
@@ -638,6 +727,12 @@ public:
         } else if (pDbAccess != nullptr) {
             assert(pBase == nullptr);
             pDbAccess->BatchWrite<KeyType, ValueType>(PREFIX_TYPE, mapData);
+            for (const auto &item : mapData) {
+                if (!db_util::IsEmpty(item.second))
+                    AddDbKey(item.first);
+                else if (pKeyIndex)
+                    pKeyIndex->erase(item.first);
+            }
         }
 
         Clear();
@@ -662,8 +757,29 @@ public:
         }
     }
 
+    // drop the keys from this level, so that they are read through from base cache again,
+    // an empty key drops all of them
+    void DropDataList(const set<string> &keys) {
+        for (const auto &keyStr : keys) {
+            if (keyStr.empty()) {
+                Clear();
+                return;
+            }
+            KeyType key;
+            CReadOnlyDataStream ssKey(keyStr.data(), keyStr.data() + keyStr.size(), SER_DISK, CLIENT_VERSION);
+            ssKey >> key;
+            auto it = mapData.find(key);
+            if (it != mapData.end()) {
+                DecDataSize(it->first, it->second);
+                mapData.erase(it);
+            }
+        }
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
-        undoDataFuncMap[GetPrefixType()] = std::bind(&CCompositeKVCache::UndoDataList, this, std::placeholders::_1);
+        auto &funcs = undoDataFuncMap[GetPrefixType()];
+        funcs.undo  = std::bind(&CCompositeKVCache::UndoDataList, this, std::placeholders::_1);
+        funcs.drop  = std::bind(&CCompositeKVCache::DropDataList, this, std::placeholders::_1);
     }
 
     dbk::PrefixType GetPrefixType() const { return PREFIX_TYPE; }
@@ -678,30 +794,109 @@ public:
 
     CCompositeKVCache<PREFIX_TYPE, KeyType, ValueType>* GetBasePtr() { return pBase; }
 
+    /**
+     * Build the bloom filter of all the keys of this prefix type in db, so that the lookup of a
+     * key which does not exist in db is answered without reading db. Only for db level cache.
+     */
+    void InitBloomFilter() {
+        assert(pDbAccess != nullptr);
+        uint64_t count = pDbAccess->TraverseKeys(PREFIX_TYPE, [](const leveldb::Slice &) {});
+        // leave room for the keys added later, the filter is dropped when it is overfilled
+        bloomCapacity = std::max<uint64_t>(std::min<uint64_t>(count * 2, UINT32_MAX), DB_BLOOM_FILTER_MIN_ELEMENTS);
+        pBloomFilter  = std::make_shared<CBloomFilter>(bloomCapacity, DB_BLOOM_FILTER_FP_RATE, GetRand(UINT32_MAX),
+                                                     BLOOM_UPDATE_NONE, MAX_DB_BLOOM_FILTER_SIZE);
+        bloomCount = pDbAccess->TraverseKeys(PREFIX_TYPE, [&](const leveldb::Slice &slKey) {
+            pBloomFilter->insert((const uint8_t *)slKey.data(), slKey.size());
+        });
+
+        LogPrint(BCLog::LDB, "init bloom filter of %s, keys=%llu, capacity=%llu\n", dbk::GetKeyPrefix(PREFIX_TYPE),
+                 bloomCount, bloomCapacity);
+    }
+
+    /**
+     * Keep all the keys of this prefix type in db in an ordered set, updated by Flush(), so that
+     * GetTopNElements() walks memory instead of a db iterator. Only for db level cache.
+     */
+    void InitKeyIndex() {
+        assert(pDbAccess != nullptr);
+        pKeyIndex = std::make_shared<set<KeyType>>();
+        pDbAccess->TraverseKeys(PREFIX_TYPE, [&](const leveldb::Slice &slKey) {
+            KeyType key;
+            if (dbk::ParseDbKey(slKey, PREFIX_TYPE, key))
+                pKeyIndex->insert(key);
+        });
+
+        LogPrint(BCLog::LDB, "init key index of %s, keys=%llu\n", dbk::GetKeyPrefix(PREFIX_TYPE),
+                 pKeyIndex->size());
+    }
+
     map<KeyType, ValueType>& GetMapData() { return mapData; };
 private:
+    /**
+     * Find the key at this level only. The db level cache loads the missing key from db into
+     * mapData, the upper level caches never copy the data of base cache.
+     */
     Iterator GetDataIt(const KeyType &key) const {
         Iterator it = mapData.find(key);
         if (it != mapData.end()) {
             return it;
-        } else if (pBase != nullptr) {
-            // find key-value at base cache
-            auto baseIt = pBase->GetDataIt(key);
-            if (baseIt != pBase->mapData.end()) {
-                // the found key-value add to current mapData
-                return AddDataToMap(key, baseIt->second);
-            }
         } else if (pDbAccess != NULL) {
-            // TODO: need to save the empty value to mapData for search performance?
+            if (missingKeys.count(key) || !MayExistInDb(key))
+                return mapData.end();
+
             auto pDbValue = db_util::MakeEmptyValue<ValueType>();
             if (pDbAccess->GetData(PREFIX_TYPE, key, *pDbValue)) {
                 return AddDataToMap(key, *pDbValue);
             }
+            // remember the missing key instead of saving the empty value to mapData, which would
+            // be written to db as an erase on flush
+            if (missingKeys.size() >= MAX_DB_MISSING_KEYS)
+                missingKeys.clear();
+            missingKeys.insert(key);
         }
 
         return mapData.end();
     }
 
+    /**
+     * Find the key through all the levels, read falls through to base cache without copying.
+     * The returned pointer is valid until the owner level is flushed or cleared.
+     */
+    const ValueType* FindData(const KeyType &key) const {
+        Iterator it = GetDataIt(key);
+        if (it != mapData.end()) {
+            return &it->second;
+        } else if (pBase != nullptr) {
+            return pBase->FindData(key);
+        }
+        return nullptr;
+    }
+
+    // check the bloom filter, false means the key definitely does not exist in db
+    bool MayExistInDb(const KeyType &key) const {
+        if (!pBloomFilter)
+            return true;
+        dbk::CDbKey dbKey(PREFIX_TYPE, key);
+        return pBloomFilter->contains((const uint8_t *)dbKey.data(), dbKey.size());
+    }
+
+    // the key has been written to db
+    void AddDbKey(const KeyType &key) {
+        missingKeys.erase(key);
+        if (pKeyIndex)
+            pKeyIndex->insert(key);
+        if (!pBloomFilter)
+            return;
+        if (++bloomCount > bloomCapacity) {
+            LogPrint(BCLog::LDB, "bloom filter of %s is overfilled, keys=%llu, drop it\n",
+                     dbk::GetKeyPrefix(PREFIX_TYPE), bloomCount);
+            pBloomFilter = nullptr;
+            return;
+        }
+        dbk::CDbKey dbKey(PREFIX_TYPE, key);
+        pBloomFilter->insert((const uint8_t *)dbKey.data(), dbKey.size());
+    }
+
     inline Iterator AddDataToMap(const KeyType &keyIn, const ValueType &valueIn) const {
         auto newRet = mapData.emplace(keyIn, valueIn);
         if (!newRet.second)
@@ -729,6 +924,13 @@ private:
         }
     }
 
+    inline void DecDataSize(const KeyType &keyIn, const ValueType &valueIn) const {
+        if (is_calc_size) {
+            uint32_t sz = CalcDataSize(keyIn) + CalcDataSize(valueIn);
+            size = size > sz ? size - sz : 0;
+        }
+    }
+
     inline void UpdateDataSize(const ValueType &oldValue, const ValueType &newVvalue) const {
         if (is_calc_size) {
             size += CalcDataSize(newVvalue);
@@ -764,6 +966,15 @@ private:
 
         if (pBase != nullptr) {
             return pBase->GetTopNElements(maxNum, expiredKeys, keys);
+        } else if (pKeyIndex) {
+            uint32_t count = 0;
+            for (auto iter = pKeyIndex->begin(); (count < maxNum) && iter != pKeyIndex->end(); ++iter) {
+                if (expiredKeys.count(*iter) || keys.count(*iter))
+                    continue;
+
+                keys.insert(*iter);
+                ++count;
+            }
         } else if (pDbAccess != nullptr) {
             return pDbAccess->GetTopNElements(maxNum, PREFIX_TYPE, expiredKeys, keys);
         }
@@ -833,6 +1044,16 @@ private:
         }
 
     }
+
+    inline void AddReadKey(const KeyType &key) const {
+        if (pDbOpLogMap != nullptr && pDbOpLogMap->GetReadKeys() != nullptr)
+            pDbOpLogMap->GetReadKeys()->AddKey(PREFIX_TYPE, key);
+    }
+
+    inline void AddReadAllKeys() const {
+        if (pDbOpLogMap != nullptr && pDbOpLogMap->GetReadKeys() != nullptr)
+            pDbOpLogMap->GetReadKeys()->AddAllKeys(PREFIX_TYPE);
+    }
 private:
     mutable CCompositeKVCache<PREFIX_TYPE, KeyType, ValueType> *pBase = nullptr;
     CDBAccess *pDbAccess = nullptr;
@@ -840,6 +1061,13 @@ private:
     CDBOpLogMap *pDbOpLogMap = nullptr;
     bool is_calc_size = false;
     mutable uint32_t size = 0;
+    // negative lookup cache and bloom filter of db keys, only for db level cache
+    mutable set<KeyType> missingKeys;
+    std::shared_ptr<CBloomFilter> pBloomFilter = nullptr;
+    // ordered keys of db, only for db level cache
+    std::shared_ptr<set<KeyType>> pKeyIndex = nullptr;
+    uint64_t bloomCount = 0;
+    uint64_t bloomCapacity = 0;
 };
 
 
@@ -900,6 +1128,7 @@ public:
     }
 
     bool GetData(ValueType &value) const {
+        AddReadKey();
         auto ptr = GetDataPtr();
         if (ptr && !db_util::IsEmpty(*ptr)) {
             value = *ptr;
@@ -909,15 +1138,23 @@ public:
     }
 
     bool SetData(const ValueType &value) {
-        if (!ptrData) {
-            ptrData = db_util::MakeEmptyValue<ValueType>();
+        auto ptr = GetDataPtr();
+        if (ptr) {
+            AddOpLog(*ptr);
+        } else {
+            AddOpLog(*db_util::MakeEmptyValue<ValueType>());
+        }
+        // copy on write: the data of base cache is never modified in place
+        if (ptrData) {
+            *ptrData = value;
+        } else {
+            ptrData = std::make_shared<ValueType>(value);
         }
-        AddOpLog(*ptrData);
-        *ptrData = value;
         return true;
     }
 
     bool HaveData() const {
+        AddReadKey();
         auto ptr = GetDataPtr();
         return ptr && !db_util::IsEmpty(*ptr);
     }
@@ -926,7 +1163,11 @@ public:
         auto ptr = GetDataPtr();
         if (ptr && !db_util::IsEmpty(*ptr)) {
             AddOpLog(*ptr);
-            db_util::SetEmpty(*ptr);
+            if (ptrData) {
+                db_util::SetEmpty(*ptrData);
+            } else {
+                ptrData = db_util::MakeEmptyValue<ValueType>();
+            }
         }
         return true;
     }
@@ -962,22 +1203,25 @@ public:
         }
     }
 
+    void DropDataList(const set<string> &keys) {
+        ptrData = nullptr;
+    }
+
     void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
-        undoDataFuncMap[GetPrefixType()] = std::bind(&CSimpleKVCache::UndoDataList, this, std::placeholders::_1);
+        auto &funcs = undoDataFuncMap[GetPrefixType()];
+        funcs.undo  = std::bind(&CSimpleKVCache::UndoDataList, this, std::placeholders::_1);
+        funcs.drop  = std::bind(&CSimpleKVCache::DropDataList, this, std::placeholders::_1);
     }
 
     dbk::PrefixType GetPrefixType() const { return PREFIX_TYPE; }
 
-    std::shared_ptr<ValueType> GetDataPtr() const {
+    // read falls through to base cache without copying, so the data must not be modified
+    std::shared_ptr<const ValueType> GetDataPtr() const {
 
         if (ptrData) {
             return ptrData;
         } else if (pBase != nullptr){
-            auto ptr = pBase->GetDataPtr();
-            if (ptr) {
-                ptrData = std::make_shared<ValueType>(*ptr);
-                return ptrData;
-            }
+            return pBase->GetDataPtr();
         } else if (pDbAccess != NULL) {
             auto ptrDbData = db_util::MakeEmptyValue<ValueType>();
 
@@ -999,6 +1243,12 @@ private:
         }
 
     }
+
+    // the single value has no key, it is recorded as all the keys of the prefix
+    inline void AddReadKey() const {
+        if (pDbOpLogMap != nullptr && pDbOpLogMap->GetReadKeys() != nullptr)
+            pDbOpLogMap->GetReadKeys()->AddAllKeys(PREFIX_TYPE);
+    }
 private:
     mutable CSimpleKVCache<PREFIX_TYPE, ValueType> *pBase;
     CDBAccess *pDbAccess;
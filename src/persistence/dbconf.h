@@ -89,6 +89,8 @@ namespace dbk {
         DEFINE( FLAG,                 "flag",   BLOCK )         /* [prefix] --> $Flag = 1 | 0 */ \
         DEFINE( BEST_BLOCKHASH,       "bbkh",   BLOCK )         /* [prefix] --> $BestBlockHash */ \
         DEFINE( TXID_DISKINDEX,       "tidx",   BLOCK )         /* tidx{$txid} --> $DiskTxPos */ \
+        DEFINE( FLUSH_REDO,           "flrd",   BLOCK )         /* flrd{$DbName} --> $Redo of the db batch in the synced flush in progress */ \
+        DEFINE( FLUSHED_BLOCKHASH,    "flbh",   DB_NAME_NONE )  /* [prefix] --> $BestBlockHash of the last flush, in every state db */ \
         /**** account db                                                                      */ \
         DEFINE( REGID_KEYID,          "rkey",   ACCOUNT )       /* rkey{$RegID} --> $KeyId */ \
         DEFINE( NICKID_KEYID,         "nkey",   ACCOUNT )       /* nkey{$NickID} --> $KeyId */ \
@@ -180,14 +182,66 @@ namespace dbk {
         return EMPTY;
     };
 
+    /**
+     * Db key of an element: the prefix followed by the serialized element. It is encoded in a stack
+     * buffer so that the lookups of fixed-size keys do not allocate, a longer key spills to the heap.
+     */
+    class CDbKey {
+    public:
+        enum { STACK_SIZE = 128 };
+
+        int nType    = SER_DISK;
+        int nVersion = CLIENT_VERSION;
+
+        template<typename KeyElement>
+        CDbKey(PrefixType keyPrefixType, const KeyElement &keyElement) {
+            assert(keyPrefixType != EMPTY);
+            const string &prefix = GetKeyPrefix(keyPrefixType);
+            write(prefix.c_str(), prefix.size()); // write buffer only, exclude size prefix
+            *this << keyElement;
+        }
+
+        CDbKey(const CDbKey &) = delete;
+        CDbKey &operator=(const CDbKey &) = delete;
+
+        CDbKey &write(const char *pch, int nSize) {
+            assert(nSize >= 0);
+            if (!fHeap && keySize + nSize > STACK_SIZE) {
+                heapKey.assign(stackKey, keySize);
+                fHeap = true;
+            }
+            if (fHeap)
+                heapKey.append(pch, nSize);
+            else
+                memcpy(stackKey + keySize, pch, nSize);
+            keySize += nSize;
+            return *this;
+        }
+
+        template<typename T>
+        CDbKey &operator<<(const T &obj) {
+            ::Serialize(*this, obj, nType, nVersion);
+            return *this;
+        }
+
+        int GetType() const { return nType; }
+        int GetVersion() const { return nVersion; }
+
+        const char *data() const { return fHeap ? heapKey.data() : stackKey; }
+        size_t size() const { return keySize; }
+        Slice GetSlice() const { return Slice(data(), keySize); }
+        std::string ToString() const { return std::string(data(), keySize); }
+
+    private:
+        char stackKey[STACK_SIZE];
+        size_t keySize = 0;
+        bool fHeap     = false;
+        std::string heapKey;
+    };
+
     template<typename KeyElement>
     std::string GenDbKey(PrefixType keyPrefixType, const KeyElement &keyElement) {
-        CDataStream ssKeyTemp(SER_DISK, CLIENT_VERSION);
-        assert(keyPrefixType != EMPTY);
-        const string &prefix = GetKeyPrefix(keyPrefixType);
-        ssKeyTemp.write(prefix.c_str(), prefix.size()); // write buffer only, exclude size prefix
-        ssKeyTemp << keyElement;
-        return std::string(ssKeyTemp.begin(), ssKeyTemp.end());
+        return CDbKey(keyPrefixType, keyElement).ToString();
     }
 
     template<typename KeyElement>
@@ -198,9 +252,10 @@ namespace dbk {
             return false;
         }
 
-        CDataStream ssKeyTemp(slice.data(), slice.data() + slice.size(), SER_DISK, CLIENT_VERSION);
-        ssKeyTemp.ignore(prefix.size());
-        ssKeyTemp >> keyElement;
+        // unserialize in place, the slice is not copied
+        CReadOnlyDataStream ssKey(slice.data() + prefix.size(), slice.data() + slice.size(), SER_DISK,
+                                  CLIENT_VERSION);
+        ssKey >> keyElement;
 
         return true;
     }
@@ -237,11 +292,13 @@ namespace dbk {
             return key.size();
         }
 
-        void Serialize(CDataStream &s, int nType, int nVersion) const {
+        template<typename Stream>
+        void Serialize(Stream &s, int nType, int nVersion) const {
             s.write(key.data(), key.size());
         }
 
-        void Unserialize(CDataStream &s, int nType, int nVersion) {
+        template<typename Stream>
+        void Unserialize(Stream &s, int nType, int nVersion) {
             if (s.size() > MAX_KEY_SIZE) {
                 throw ios_base::failure("CDBTailKey::Unserialize size excceded max size");
             }
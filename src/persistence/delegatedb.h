@@ -37,6 +37,8 @@ public:
         active_delegates_cache(pBaseIn->active_delegates_cache) {}
 
     bool GetTopVoteDelegates(uint32_t delegateNum, VoteDelegateVector &topVotedDelegates);
+    // rank the candidates by votes in memory instead of walking the votes in db, only for db level cache
+    void InitVoteIndex() { voteRegIdCache.InitKeyIndex(); }
 
     bool SetDelegateVotes(const CRegID &regid, const uint64_t votes);
     bool EraseDelegateVotes(const CRegID &regid, const uint64_t votes);
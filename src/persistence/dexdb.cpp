@@ -33,12 +33,30 @@ void DEX_DB::BlockOrdersToJson(const BlockOrders &orders, Object &obj) {
     obj.push_back(Pair("orders", array));
 }
 
+void DEX_DB::OrderToJson(const uint256 &orderId, const CDEXOrderDetail &order, CJsonWriter &writer) {
+    writer.Pair("order_id", orderId.ToString());
+    order.ToJson(writer);
+}
+
+void DEX_DB::BlockOrdersToJson(const BlockOrders &orders, CJsonWriter &writer) {
+    writer.Pair("count", (int64_t)orders.size());
+    writer.Key("orders").BeginArray();
+    for (auto &item : orders) {
+        writer.BeginObject();
+        OrderToJson(GetOrderId(item.first), item.second, writer);
+        writer.EndObject();
+    }
+    writer.EndArray();
+}
+
 shared_ptr<string> DEX_DB::ParseLastPos(const string &lastPosInfo, DEXBlockOrdersCache::KeyType &lastKey) {
 
     CDataStream ds(lastPosInfo, SER_DISK, CLIENT_VERSION);
     uint256 lastBlockHash;
     ds >> lastBlockHash >> lastKey;
     uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
+    // the dex order RPCs run without cs_main, lock it only for the lookup of the active chain
+    LOCK(cs_main);
     CBlockIndex *pBlockIndex = chainActive[lastHeight];
     if (pBlockIndex == nullptr)
         return make_shared<string>(strprintf("The last_pos_info is not contained in active chains,"
@@ -52,13 +70,18 @@ shared_ptr<string> DEX_DB::ParseLastPos(const string &lastPosInfo, DEXBlockOrder
 
 shared_ptr<string> DEX_DB::MakeLastPos(const DEXBlockOrdersCache::KeyType &lastKey, string &lastPosInfo) {
     uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
-    CBlockIndex *pBlockIndex = chainActive[lastHeight];
-    if (pBlockIndex == nullptr)
-        return make_shared<string>(strprintf("The block of lastKey is not contained in active chains,"
-            " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+    uint256 lastBlockHash;
+    {
+        LOCK(cs_main);
+        CBlockIndex *pBlockIndex = chainActive[lastHeight];
+        if (pBlockIndex == nullptr)
+            return make_shared<string>(strprintf("The block of lastKey is not contained in active chains,"
+                " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+        lastBlockHash = pBlockIndex->GetBlockHash();
+    }
 
     CDataStream ds(SER_DISK, CLIENT_VERSION);
-    ds << pBlockIndex->GetBlockHash() << lastKey;
+    ds << lastBlockHash << lastKey;
     lastPosInfo = ds.str();
     return nullptr;
 }
@@ -241,6 +264,10 @@ void CDEXOrdersGetter::ToJson(Object &obj) {
     DEX_DB::BlockOrdersToJson(orders, obj);
 }
 
+void CDEXOrdersGetter::ToJson(CJsonWriter &writer) {
+    DEX_DB::BlockOrdersToJson(orders, writer);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class CDEXSysOrdersGetter
 
@@ -377,6 +404,10 @@ void CDEXSysOrdersGetter::ToJson(Object &obj) {
     DEX_DB::BlockOrdersToJson(orders, obj);
 }
 
+void CDEXSysOrdersGetter::ToJson(CJsonWriter &writer) {
+    DEX_DB::BlockOrdersToJson(orders, writer);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class CDexDBCache
 
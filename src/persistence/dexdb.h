@@ -51,6 +51,11 @@ namespace DEX_DB {
     void OrderToJson(const uint256 &orderId, const dex::CDEXOrderDetail &order, Object &obj);
 
     void BlockOrdersToJson(const BlockOrders &orderList, Object &obj);
+
+    // streaming variants, writing the same fields into the opened object of writer
+    void OrderToJson(const uint256 &orderId, const dex::CDEXOrderDetail &order, CJsonWriter &writer);
+
+    void BlockOrdersToJson(const BlockOrders &orderList, CJsonWriter &writer);
 };
 
 class CDEXOrdersGetter {
@@ -70,6 +75,7 @@ public:
 
     bool Execute(uint32_t fromHeight, uint32_t toHeight, uint32_t maxCount, const DEXBlockOrdersCache::KeyType &lastPosInfo);
     void ToJson(Object &obj);
+    void ToJson(CJsonWriter &writer);
 };
 
 
@@ -86,6 +92,7 @@ public:
     bool Execute(uint32_t height);
 
     void ToJson(Object &obj);
+    void ToJson(CJsonWriter &writer);
 };
 
 class CDexDBCache {
@@ -74,7 +74,23 @@ CLevelDBWrapper::CLevelDBWrapper(const boost::filesystem::path &path, size_t nCa
     LogPrint(BCLog::INFO, "Opened LevelDB successfully\n");
 }
 
+CLevelDBWrapper::CLevelDBWrapper(CLevelDBWrapper &base, const leveldb::Snapshot *pSnapshotIn) {
+    penv                         = nullptr;
+    readoptions                  = base.readoptions;
+    iteroptions                  = base.iteroptions;
+    readoptions.snapshot         = pSnapshotIn;
+    iteroptions.snapshot         = pSnapshotIn;
+    pdb                          = base.pdb;
+    pSnapshot                    = pSnapshotIn;
+}
+
 CLevelDBWrapper::~CLevelDBWrapper() {
+    if (pSnapshot != nullptr) {
+        pdb->ReleaseSnapshot(pSnapshot);
+        pSnapshot = nullptr;
+        return;
+    }
+
     delete pdb;
     pdb = nullptr;
     delete options.filter_policy;
@@ -85,7 +101,56 @@ CLevelDBWrapper::~CLevelDBWrapper() {
     options.env = nullptr;
 }
 
+enum RedoOpType : uint8_t { REDO_PUT = 1, REDO_DELETE = 2 };
+
+// appends the puts and deletes of a batch to the redo data, in batch order
+class CRedoWriter : public leveldb::WriteBatch::Handler {
+public:
+    explicit CRedoWriter(CDataStream &ssIn) : ss(ssIn) {}
+
+    void Put(const leveldb::Slice &key, const leveldb::Slice &value) override {
+        ss << (uint8_t)REDO_PUT << key.ToString() << value.ToString();
+    }
+    void Delete(const leveldb::Slice &key) override { ss << (uint8_t)REDO_DELETE << key.ToString(); }
+
+private:
+    CDataStream &ss;
+};
+
+std::string CLevelDBBatch::GetRedo() const {
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    CRedoWriter writer(ss);
+    ThrowError(batch.Iterate(&writer));
+    return ss.str();
+}
+
+bool CLevelDBBatch::LoadRedo(const std::string &redo) {
+    Clear();
+    try {
+        CDataStream ss(redo.data(), redo.data() + redo.size(), SER_DISK, CLIENT_VERSION);
+        while (!ss.empty()) {
+            uint8_t opType;
+            std::string key;
+            ss >> opType >> key;
+            if (opType == REDO_PUT) {
+                std::string value;
+                ss >> value;
+                batch.Put(key, value);
+            } else if (opType == REDO_DELETE) {
+                batch.Delete(key);
+            } else {
+                return false;
+            }
+            ++count;
+        }
+    } catch (const std::exception &e) {
+        return ERRORMSG("%s : Deserialize redo data error - %s", __func__, e.what());
+    }
+    return true;
+}
+
 bool CLevelDBWrapper::WriteBatch(CLevelDBBatch &batch, bool fSync) {
+    assert(pSnapshot == nullptr && "write to a read-only snapshot view");
     leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
     ThrowError(status);
     return true;
@@ -16,6 +16,8 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <set>
+
 using namespace json_spirit;
 
 class CDbOpLog {
@@ -49,17 +51,17 @@ public:
     // for key-value
     template<typename K, typename V>
     void Get(K& keyOut, V& valueOut) const {
-        CDataStream ssKey(key, SER_DISK, CLIENT_VERSION);
+        CReadOnlyDataStream ssKey(key.data(), key.data() + key.size(), SER_DISK, CLIENT_VERSION);
         ssKey >> keyOut;
 
-        CDataStream ssValue(value, SER_DISK, CLIENT_VERSION);
+        CReadOnlyDataStream ssValue(value.data(), value.data() + value.size(), SER_DISK, CLIENT_VERSION);
         ssValue >> valueOut;
     }
 
     // for single value
     template<typename V>
     void Get(V& valueOut) const {
-        CDataStream ssValue(value, SER_DISK, CLIENT_VERSION);
+        CReadOnlyDataStream ssValue(value.data(), value.data() + value.size(), SER_DISK, CLIENT_VERSION);
         ssValue >> valueOut;
     }
 
@@ -84,9 +86,42 @@ public:
 
 typedef vector<CDbOpLog> CDbOpLogs;
 
+class CDBOpLogMap;
+
+// The keys of the data read or written through the caches, by prefix. Only the serialized keys are
+// kept, without values. An empty key stands for all the keys of the prefix, e.g. a range read.
+class CDBKeySet {
+public:
+    const map<string, set<string>>& GetMap() const { return mapKeys; }
+
+    template<typename K>
+    void AddKey(dbk::PrefixType prefixType, const K& keyIn) {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey << keyIn;
+        mapKeys[dbk::GetKeyPrefix(prefixType)].insert(ssKey.str());
+    }
+
+    void AddAllKeys(dbk::PrefixType prefixType) { mapKeys[dbk::GetKeyPrefix(prefixType)].insert(string()); }
+
+    void AddKeys(const CDBKeySet &other) {
+        for (const auto &item : other.mapKeys)
+            mapKeys[item.first].insert(item.second.begin(), item.second.end());
+    }
+
+    // the keys of the op logs
+    void AddKeys(const CDBOpLogMap &dbOpLogMap);
+
+    bool IsEmpty() const { return mapKeys.empty(); }
+    void Clear() { mapKeys.clear(); }
+
+private:
+    map<string, set<string>> mapKeys; // prefix -> keys
+};
+
 class CDBOpLogMap {
 public:
     map<string, CDbOpLogs>& GetMap() { return mapDbOpLogs; }
+    const map<string, CDbOpLogs>& GetMap() const { return mapDbOpLogs; }
 
     const CDbOpLogs* GetDbOpLogsPtr(dbk::PrefixType prefixType) const {
         assert(prefixType != dbk::EMPTY);
@@ -106,6 +141,10 @@ public:
 
     void Clear() { mapDbOpLogs.clear(); }
 
+    // the caches recording op logs to this map also record the keys they read to pReadKeys if set
+    void SetReadKeys(CDBKeySet *pReadKeysIn) { pReadKeys = pReadKeysIn; }
+    CDBKeySet* GetReadKeys() const { return pReadKeys; }
+
     std::string ToString() const;
 public:
     IMPLEMENT_SERIALIZE(
@@ -113,8 +152,17 @@ public:
 	)
 private:
     mutable map<string, CDbOpLogs> mapDbOpLogs; // dbName -> dbOpLogs
+    CDBKeySet *pReadKeys = nullptr;
 };
 
+inline void CDBKeySet::AddKeys(const CDBOpLogMap &dbOpLogMap) {
+    for (const auto &opLogPair : dbOpLogMap.GetMap()) {
+        auto &keys = mapKeys[opLogPair.first];
+        for (const auto &dbOpLog : opLogPair.second)
+            keys.insert(dbOpLog.GetKey());
+    }
+}
+
 class leveldb_error : public runtime_error
 {
 public:
@@ -129,22 +177,37 @@ class CLevelDBBatch {
 
 private:
     leveldb::WriteBatch batch;
+    uint32_t count = 0;
 
 public:
     template<typename V>
-    void Write(const std::string &key, const V& value) {
-    	leveldb::Slice slKey(key);
+    void Write(const leveldb::Slice &slKey, const V& value) {
         CDataStream ssValue(SER_DISK, CLIENT_VERSION);
         ssValue.reserve(ssValue.GetSerializeSize(value));
         ssValue << value;
         leveldb::Slice slValue(&ssValue[0], ssValue.size());
         batch.Put(slKey, slValue);
+        ++count;
     }
 
-    void Erase(const std::string &key) {
-        batch.Delete(key);
+    void Erase(const leveldb::Slice &slKey) {
+        batch.Delete(slKey);
+        ++count;
     }
 
+    uint32_t Count() const { return count; }
+
+    bool IsEmpty() const { return count == 0; }
+
+    void Clear() {
+        batch.Clear();
+        count = 0;
+    }
+
+    // the puts and deletes of the batch, to be written again by a batch of LoadRedo() after a crash
+    std::string GetRedo() const;
+    // replace the batch by the redo data of GetRedo(), false if it is corrupted
+    bool LoadRedo(const std::string &redo);
  };
 
 class CLevelDBWrapper {
@@ -170,14 +233,19 @@ private:
     // the database itself
     leveldb::DB *pdb;
 
+    // the snapshot read by a read-only view of another wrapper, the db is not owned then
+    const leveldb::Snapshot *pSnapshot = nullptr;
+
 public:
     CLevelDBWrapper(const boost::filesystem::path &path, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    // read-only view of the base db at the snapshot, which is released with the view; the base must outlive it
+    CLevelDBWrapper(CLevelDBWrapper &base, const leveldb::Snapshot *pSnapshotIn);
     ~CLevelDBWrapper();
 
-    template<typename V>
-    bool Read(std::string key, V &value) {
-    	leveldb::Slice slKey(key);
+    const leveldb::Snapshot *NewSnapshot() { return pdb->GetSnapshot(); }
 
+    template<typename V>
+    bool Read(const leveldb::Slice &slKey, V &value) {
         string strValue;
         leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
         if (!status.ok()) {
@@ -187,7 +255,7 @@ public:
             ThrowError(status);
         }
         try {
-            CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+            CReadOnlyDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
             ssValue >> value;
         } catch(std::exception &e) {
             return false;
@@ -196,14 +264,13 @@ public:
     }
 
     template<typename V>
-    bool Write(const std::string &key, const V &value, bool fSync = false) {
+    bool Write(const leveldb::Slice &slKey, const V &value, bool fSync = false) {
         CLevelDBBatch batch;
-        batch.Write(key, value);
+        batch.Write(slKey, value);
         return WriteBatch(batch, fSync);
     }
 
-    bool Exists(const std::string &key) {
-    	leveldb::Slice slKey(key);
+    bool Exists(const leveldb::Slice &slKey) {
         string strValue;
         leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
         if (!status.ok()) {
@@ -215,9 +282,9 @@ public:
         return true;
     }
 
-    bool Erase(const string& key, bool fSync = false) {
+    bool Erase(const leveldb::Slice &slKey, bool fSync = false) {
         CLevelDBBatch batch;
-        batch.Erase(key);
+        batch.Erase(slKey);
         return WriteBatch(batch, fSync);
     }
 
@@ -25,6 +25,62 @@ bool CConsecutiveBlockPrice::ExistBlockUserPrice(const int32_t blockHeight, cons
     return mapBlockUserPrices[blockHeight].count(regId);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// class CMedianPriceWindow
+
+void CMedianPriceWindow::Add(const uint64_t price) {
+    if (lower.empty() || price <= *lower.begin())
+        lower.insert(price);
+    else
+        upper.insert(price);
+
+    Rebalance();
+}
+
+bool CMedianPriceWindow::Remove(const uint64_t price) {
+    // every price in upper is >= the largest one in lower, so a price not greater than that must be in lower
+    if (!lower.empty() && price <= *lower.begin()) {
+        auto it = lower.find(price);
+        if (it == lower.end())
+            return false;
+        lower.erase(it);
+    } else {
+        auto it = upper.find(price);
+        if (it == upper.end())
+            return false;
+        upper.erase(it);
+    }
+
+    Rebalance();
+    return true;
+}
+
+uint64_t CMedianPriceWindow::GetMedian() const {
+    if (lower.empty())
+        return 0;
+
+    return lower.size() > upper.size() ? *lower.begin() : (*lower.begin() + *upper.begin()) / 2;
+}
+
+void CMedianPriceWindow::Clear() {
+    lower.clear();
+    upper.clear();
+}
+
+void CMedianPriceWindow::Rebalance() {
+    // keep lower.size() == upper.size() or lower.size() == upper.size() + 1
+    if (lower.size() > upper.size() + 1) {
+        upper.insert(*lower.begin());
+        lower.erase(lower.begin());
+    } else if (upper.size() > lower.size()) {
+        lower.insert(*upper.begin());
+        upper.erase(upper.begin());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class CPricePointMemCache
+
 bool CPricePointMemCache::AddPrice(const int32_t blockHeight, const CRegID &regId,
                                                     const vector<CPricePoint> &pps) {
     for (CPricePoint pp : pps) {
@@ -36,8 +92,9 @@ bool CPricePointMemCache::AddPrice(const int32_t blockHeight, const CRegID &regI
             return false;
         }
 
-        CConsecutiveBlockPrice &cbp = mapCoinPricePointCache[pp.GetCoinPricePair()];
-        cbp.AddUserPrice(blockHeight, regId, pp.GetPrice());
+        ModifyBlockUserPrices(pp.GetCoinPricePair(), blockHeight, [&](CConsecutiveBlockPrice &cbp) {
+            cbp.AddUserPrice(blockHeight, regId, pp.GetPrice());
+        });
         LogPrint(BCLog::PRICEFEED,
                  "CPricePointMemCache::AddPrice, add block user price, "
                  "height: %d, redId: %s, pricePoint: %s\n",
@@ -82,13 +139,14 @@ bool CPricePointMemCache::AddPriceByBlock(const CBlock &block) {
 }
 
 bool CPricePointMemCache::DeleteBlockPricePoint(const int32_t blockHeight) {
+    auto deleteFunc = [&](CConsecutiveBlockPrice &cbp) { cbp.DeleteUserPrice(blockHeight); };
     if (mapCoinPricePointCache.empty()) {
         // TODO: multi stable coin
-        mapCoinPricePointCache[CoinPricePair(SYMB::WICC, SYMB::USD)].DeleteUserPrice(blockHeight);
-        mapCoinPricePointCache[CoinPricePair(SYMB::WGRT, SYMB::USD)].DeleteUserPrice(blockHeight);
+        ModifyBlockUserPrices(CoinPricePair(SYMB::WICC, SYMB::USD), blockHeight, deleteFunc);
+        ModifyBlockUserPrices(CoinPricePair(SYMB::WGRT, SYMB::USD), blockHeight, deleteFunc);
     } else {
         for (auto &item : mapCoinPricePointCache) {
-            item.second.DeleteUserPrice(blockHeight);
+            ModifyBlockUserPrices(item.first, blockHeight, deleteFunc);
         }
     }
 
@@ -102,22 +160,25 @@ void CPricePointMemCache::BatchWrite(const CoinPricePointMap &mapCoinPricePointC
         // map<int32_t /* block height */, map<CRegID, uint64_t /* price */>>
         const auto &mapBlockUserPrices = item.second.mapBlockUserPrices;
         for (const auto &userPrice : mapBlockUserPrices) {
-            if (userPrice.second.empty()) {
-                mapCoinPricePointCache[item.first /* CoinPricePair */].mapBlockUserPrices.erase(userPrice.first /* height */);
-            } else {
-                // map<CRegID, uint64_t /* price */>;
-                for (const auto &priceItem : userPrice.second) {
-                    mapCoinPricePointCache[item.first /* CoinPricePair */]
-                        .mapBlockUserPrices[userPrice.first /* height */]
-                        .emplace(priceItem.first /* CRegID */, priceItem.second /* price */);
+            ModifyBlockUserPrices(item.first /* CoinPricePair */, userPrice.first /* height */,
+                                  [&](CConsecutiveBlockPrice &cbp) {
+                if (userPrice.second.empty()) {
+                    cbp.mapBlockUserPrices.erase(userPrice.first /* height */);
+                } else {
+                    // map<CRegID, uint64_t /* price */>;
+                    for (const auto &priceItem : userPrice.second) {
+                        cbp.mapBlockUserPrices[userPrice.first /* height */]
+                            .emplace(priceItem.first /* CRegID */, priceItem.second /* price */);
+                    }
                 }
-            }
+            });
         }
     }
 }
 
 void CPricePointMemCache::SetBaseViewPtr(CPricePointMemCache *pBaseIn) {
     pBase                        = pBaseIn;
+    median_windows.clear();
 }
 
 void CPricePointMemCache::Flush() {
@@ -127,81 +188,126 @@ void CPricePointMemCache::Flush() {
     mapCoinPricePointCache.clear();
 }
 
-bool CPricePointMemCache::GetBlockUserPrices(const CoinPricePair &coinPricePair, set<int32_t> &expired,
-                                             BlockUserPriceMap &blockUserPrices) {
-    const auto &iter = mapCoinPricePointCache.find(coinPricePair);
+const map<CRegID, uint64_t> *CPricePointMemCache::GetBlockUserPrices(const CoinPricePair &coinPricePair,
+                                                                     const int32_t blockHeight) {
+    // the topmost cache holding the block wins, an empty item means the block has been deleted
+    const auto iter = mapCoinPricePointCache.find(coinPricePair);
     if (iter != mapCoinPricePointCache.end()) {
         const auto &mapBlockUserPrices = iter->second.mapBlockUserPrices;
-        for (const auto &item : mapBlockUserPrices) {
-            if (item.second.empty()) {
-                expired.insert(item.first);
-            } else if (expired.count(item.first) || blockUserPrices.count(item.first)) {
-                // TODO: log
-                continue;
-            } else {
-                // Got a valid item.
-                blockUserPrices[item.first] = item.second;
-            }
-        }
-    }
-
-    if (pBase != nullptr) {
-        return pBase->GetBlockUserPrices(coinPricePair, expired, blockUserPrices);
+        const auto blockIter           = mapBlockUserPrices.find(blockHeight);
+        if (blockIter != mapBlockUserPrices.end())
+            return &blockIter->second;
     }
 
-    return true;
+    return pBase != nullptr ? pBase->GetBlockUserPrices(coinPricePair, blockHeight) : nullptr;
 }
 
-bool CPricePointMemCache::GetBlockUserPrices(const CoinPricePair &coinPricePair, BlockUserPriceMap &blockUserPrices) {
-    set<int32_t /* block height */> expired;
-    if (!GetBlockUserPrices(coinPricePair, expired, blockUserPrices)) {
-        // TODO: log
-        return false;
+template <typename ModifyFunc>
+void CPricePointMemCache::ModifyBlockUserPrices(const CoinPricePair &coinPricePair, const int32_t blockHeight,
+                                                ModifyFunc modifyFunc) {
+    CMedianPriceWindow *pWindow = nullptr;
+    auto iter = median_windows.find(coinPricePair);
+    if (iter != median_windows.end() && iter->second.valid) {
+        if (!IsWindowUpToDate(iter->second))
+            iter->second.valid = false;
+        else if (blockHeight > iter->second.begin_height && blockHeight <= iter->second.end_height)
+            pWindow = &iter->second;
     }
 
-    return true;
+    if (pWindow != nullptr)
+        RemoveWindowPrices(*pWindow, coinPricePair, blockHeight - 1, blockHeight);
+
+    modifyFunc(mapCoinPricePointCache[coinPricePair]);
+    ++version;
+
+    if (pWindow != nullptr)
+        AddWindowPrices(*pWindow, coinPricePair, blockHeight - 1, blockHeight);
 }
 
-uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                                      const CoinPricePair &coinPricePair) {
-    // 1. merge block user prices with base cache.
-    BlockUserPriceMap blockUserPrices;
-    if (!GetBlockUserPrices(coinPricePair, blockUserPrices) || blockUserPrices.empty()) {
-        return 0;
+bool CPricePointMemCache::IsWindowUpToDate(const CMedianPriceWindow &window) {
+    return window.base_version == (pBase != nullptr ? pBase->GetViewVersion() : 0);
+}
+
+void CPricePointMemCache::AddWindowPrices(CMedianPriceWindow &window, const CoinPricePair &coinPricePair,
+                                          const int32_t fromHeight, const int32_t toHeight) {
+    for (int32_t height = fromHeight + 1; height <= toHeight; ++height) {
+        const auto *pUserPrices = GetBlockUserPrices(coinPricePair, height);
+        if (pUserPrices != nullptr) {
+            for (const auto &userPrice : *pUserPrices)
+                window.Add(userPrice.second);
+        }
     }
+}
 
-    // 2. compute block median price.
-    return ComputeBlockMedianPrice(blockHeight, slideWindow, blockUserPrices);
+void CPricePointMemCache::RemoveWindowPrices(CMedianPriceWindow &window, const CoinPricePair &coinPricePair,
+                                             const int32_t fromHeight, const int32_t toHeight) {
+    for (int32_t height = fromHeight + 1; height <= toHeight; ++height) {
+        const auto *pUserPrices = GetBlockUserPrices(coinPricePair, height);
+        if (pUserPrices != nullptr) {
+            for (const auto &userPrice : *pUserPrices) {
+                if (!window.Remove(userPrice.second)) {
+                    LogPrint(BCLog::ERROR, "CPricePointMemCache::RemoveWindowPrices, price %llu of block %d not in "
+                             "median window, rebuild it\n", userPrice.second, height);
+                    window.valid = false;
+                }
+            }
+        }
+    }
 }
 
-uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                                      const BlockUserPriceMap &blockUserPrices) {
-    // for (const auto &item : blockUserPrices) {
-    //     string price;
-    //     for (const auto &userPrice : item.second) {
-    //         price += strprintf("{user:%s, price:%lld}", userPrice.first.ToString(), userPrice.second);
-    //     }
-
-    //     LogPrint(BCLog::PRICEFEED, "CPricePointMemCache::ComputeBlockMedianPrice, height: %d, userPrice: %s\n",
-    //              item.first, price);
-    // }
-
-    vector<uint64_t> prices;
-    int32_t beginBlockHeight = std::max<int32_t>((blockHeight - slideWindow), 0);
-    for (int32_t height = blockHeight; height > beginBlockHeight; --height) {
-        const auto &iter = blockUserPrices.find(height);
-        if (iter != blockUserPrices.end()) {
-            for (const auto &userPrice : iter->second) {
-                prices.push_back(userPrice.second);
+CMedianPriceWindow &CPricePointMemCache::GetMedianWindow(const CoinPricePair &coinPricePair,
+                                                         const int32_t blockHeight, const uint64_t slideWindow) {
+    int32_t beginHeight        = std::max<int32_t>((blockHeight - slideWindow), 0);
+    CMedianPriceWindow &window = median_windows[coinPricePair];
+
+    bool slid = false;
+    if (window.valid && window.slide_window == slideWindow && IsWindowUpToDate(window) &&
+        beginHeight < window.end_height && blockHeight > window.begin_height) {
+        // slide the overlapping window: drop the blocks that left it and add the ones that entered it
+        RemoveWindowPrices(window, coinPricePair, window.begin_height, beginHeight);
+        RemoveWindowPrices(window, coinPricePair, blockHeight, window.end_height);
+        AddWindowPrices(window, coinPricePair, beginHeight, window.begin_height);
+        AddWindowPrices(window, coinPricePair, window.end_height, blockHeight);
+        slid = window.valid;
+    }
+
+    if (!slid) {
+        if (pBase != nullptr) {
+            // start from the window of the base cache and override the blocks held by this cache
+            window = pBase->GetMedianWindow(coinPricePair, blockHeight, slideWindow);
+
+            const auto iter = mapCoinPricePointCache.find(coinPricePair);
+            if (iter != mapCoinPricePointCache.end()) {
+                const auto &mapBlockUserPrices = iter->second.mapBlockUserPrices;
+                for (auto blockIter = mapBlockUserPrices.upper_bound(beginHeight);
+                     blockIter != mapBlockUserPrices.end() && blockIter->first <= blockHeight; ++blockIter) {
+                    const auto *pBaseUserPrices = pBase->GetBlockUserPrices(coinPricePair, blockIter->first);
+                    if (pBaseUserPrices != nullptr) {
+                        for (const auto &userPrice : *pBaseUserPrices)
+                            window.Remove(userPrice.second);
+                    }
+                    for (const auto &userPrice : blockIter->second)
+                        window.Add(userPrice.second);
+                }
             }
+        } else {
+            window.Clear();
+            AddWindowPrices(window, coinPricePair, beginHeight, blockHeight);
         }
     }
 
-    // for (const auto &item : prices) {
-    //     LogPrint(BCLog::PRICEFEED, "CPricePointMemCache::ComputeBlockMedianPrice, found a candidate price: %llu\n", item);
-    // }
+    window.valid        = true;
+    window.begin_height = beginHeight;
+    window.end_height   = blockHeight;
+    window.slide_window = slideWindow;
+    window.base_version = pBase != nullptr ? pBase->GetViewVersion() : 0;
 
-    uint64_t medianPrice = ComputeMedianNumber(prices);
+    return window;
+}
+
+uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
+                                                      const CoinPricePair &coinPricePair) {
+    uint64_t medianPrice = GetMedianWindow(coinPricePair, blockHeight, slideWindow).GetMedian();
     LogPrint(BCLog::PRICEFEED,
              "CPricePointMemCache::ComputeBlockMedianPrice, blockHeight: %d, computed median number: %llu\n",
              blockHeight, medianPrice);
@@ -209,15 +315,6 @@ uint64_t CPricePointMemCache::ComputeBlockMedianPrice(const int32_t blockHeight,
     return medianPrice;
 }
 
-uint64_t CPricePointMemCache::ComputeMedianNumber(vector<uint64_t> &numbers) {
-    int32_t size = numbers.size();
-    if (size < 2) {
-        return size == 0 ? 0 : numbers[0];
-    }
-    sort(numbers.begin(), numbers.end());
-    return (size % 2 == 0) ? (numbers[size / 2 - 1] + numbers[size / 2]) / 2 : numbers[size / 2];
-}
-
 uint64_t CPricePointMemCache::GetMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
                                              const CoinPricePair &coinPricePair) {
     uint64_t medianPrice = ComputeBlockMedianPrice(blockHeight, slideWindow, coinPricePair);
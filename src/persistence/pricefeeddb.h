@@ -15,6 +15,7 @@
 #include "tx/tx.h"
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -33,10 +34,38 @@ public:
     void DeleteUserPrice(const int32_t blockHeight);
     bool ExistBlockUserPrice(const int32_t blockHeight, const CRegID &regId);
 
+    IMPLEMENT_SERIALIZE(READWRITE(mapBlockUserPrices);)
+
 public:
     BlockUserPriceMap mapBlockUserPrices;
 };
 
+// All user prices of a coin pair in the block range (begin_height, end_height], split into two
+// balanced halves so that the median is read in O(1) and a price is added or removed in O(log n).
+class CMedianPriceWindow {
+public:
+    void Add(const uint64_t price);
+    // return false if the price is not in the window
+    bool Remove(const uint64_t price);
+    // same as sorting all prices and taking the middle one (or the mean of the middle two)
+    uint64_t GetMedian() const;
+    size_t GetSize() const { return lower.size() + upper.size(); }
+    void Clear();
+
+public:
+    bool valid            = false;
+    int32_t begin_height  = 0;  // exclusive
+    int32_t end_height    = 0;  // inclusive
+    uint64_t slide_window = 0;
+    uint64_t base_version = 0;  // view version of the base cache when the window was built
+
+private:
+    void Rebalance();
+
+    multiset<uint64_t, std::greater<uint64_t>> lower;  // the smaller half, largest first
+    multiset<uint64_t> upper;                           // the larger half, smallest first
+};
+
 class CPricePointMemCache {
 public:
     CPricePointMemCache() : pBase(nullptr) {}
@@ -51,9 +80,23 @@ public:
 
     bool CalcBlockMedianPrices(CCacheWrapper &cw, const int32_t blockHeight, PriceMap &medianPrices);
 
+    // median of all user prices in blocks (blockHeight - slideWindow, blockHeight], 0 if none
+    uint64_t ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
+                                     const CoinPricePair &coinPricePair);
+
     void SetBaseViewPtr(CPricePointMemCache *pBaseIn);
     void Flush();
 
+    // only the prices of this cache, not those of the base
+    IMPLEMENT_SERIALIZE(
+        READWRITE(mapCoinPricePointCache);
+        if (fRead) {
+            CPricePointMemCache *pThis = const_cast<CPricePointMemCache *>(this);
+            pThis->median_windows.clear();
+            ++pThis->version;
+        }
+    )
+
 private:
     uint64_t GetMedianPrice(const int32_t blockHeight, const uint64_t slideWindow, const CoinPricePair &coinPricePair);
 
@@ -63,19 +106,31 @@ private:
 
     void BatchWrite(const CoinPricePointMap &mapCoinPricePointCacheIn);
 
-    bool GetBlockUserPrices(const CoinPricePair &coinPricePair, set<int32_t> &expired, BlockUserPriceMap &blockUserPrices);
-    bool GetBlockUserPrices(const CoinPricePair &coinPricePair, BlockUserPriceMap &blockUserPrices);
+    // user prices of the block in the merged view of this cache and its bases, nullptr if none
+    const map<CRegID, uint64_t> *GetBlockUserPrices(const CoinPricePair &coinPricePair, const int32_t blockHeight);
 
-    uint64_t ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                     const CoinPricePair &coinPricePair);
-    uint64_t ComputeBlockMedianPrice(const int32_t blockHeight, const uint64_t slideWindow,
-                                     const BlockUserPriceMap &blockUserPrices);
-    static uint64_t ComputeMedianNumber(vector<uint64_t> &numbers);
+    // modify the prices of one block in this cache, keeping the median window up to date
+    template <typename ModifyFunc>
+    void ModifyBlockUserPrices(const CoinPricePair &coinPricePair, const int32_t blockHeight, ModifyFunc modifyFunc);
+
+    CMedianPriceWindow &GetMedianWindow(const CoinPricePair &coinPricePair, const int32_t blockHeight,
+                                        const uint64_t slideWindow);
+    bool IsWindowUpToDate(const CMedianPriceWindow &window);
+    // add or remove the prices of blocks (fromHeight, toHeight] to or from the window
+    void AddWindowPrices(CMedianPriceWindow &window, const CoinPricePair &coinPricePair, const int32_t fromHeight,
+                         const int32_t toHeight);
+    void RemoveWindowPrices(CMedianPriceWindow &window, const CoinPricePair &coinPricePair, const int32_t fromHeight,
+                            const int32_t toHeight);
+
+    // increases whenever the prices of this cache or of any base cache change
+    uint64_t GetViewVersion() const { return version + (pBase ? pBase->GetViewVersion() : 0); }
 
 private:
     CoinPricePointMap mapCoinPricePointCache;  // coinPriceType -> consecutiveBlockPrice
     CPricePointMemCache *pBase;
     PriceMap latest_median_prices;
+    map<CoinPricePair, CMedianPriceWindow> median_windows;  // slide window of the last median query
+    uint64_t version = 0;                                   // count of the price changes in this cache
 };
 
 #endif  // PERSIST_PRICEFEED_H
\ No newline at end of file
@@ -38,6 +38,16 @@ public:
     Object ToJsonObj() const;
     uint64_t GetSize();
 
+    // only the txids of this cache, not those of the base
+    IMPLEMENT_SERIALIZE(
+        vector<uint256> txidList;
+        if (!fRead)
+            txidList.assign(txids.begin(), txids.end());
+        READWRITE(txidList);
+        if (fRead)
+            const_cast<CTxMemCache *>(this)->txids = UnorderedHashSet(txidList.begin(), txidList.end());
+    )
+
 private:
     bool HaveBlock(const uint256 &blockHash) const;
     bool HaveBlock(const CBlock &block);
@@ -571,13 +571,31 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
     assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, strReply.data(), strReply.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::string&& strReply) {
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    // the string is owned by the evbuffer from now on and freed once the reply is sent
+    std::string* pReply = new std::string(std::move(strReply));
+    auto cleanup = [](const void*, size_t, void* arg) { delete static_cast<std::string*>(arg); };
+    if (evbuffer_add_reference(evb, pReply->data(), pReply->size(), cleanup, pReply) != 0) {
+        evbuffer_add(evb, pReply->data(), pReply->size());
+        delete pReply;
+    }
+    SendReply(nStatus);
+}
+
+void HTTPRequest::SendReply(int nStatus) {
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
     // Send event to main http thread to send reply message
-    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
-    assert(evb);
-    evbuffer_add(evb, strReply.data(), strReply.size());
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
@@ -114,6 +114,14 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Write HTTP reply, handing the buffer of strReply over to libevent without copying it.
+     */
+    void WriteReply(int nStatus, std::string&& strReply);
+
+private:
+    void SendReply(int nStatus);
 };
 
 /** Event handler closure.
@@ -223,6 +223,14 @@ bool ParseRpcInputMoney(const string &comboMoneyStr, ComboMoney &comboMoney, con
 }
 
 
+std::unique_ptr<CCacheDBManager> GetSnapshotView() {
+    auto pView = pCdMan->NewSnapshotView();
+    if (!pView)
+        throw JSONRPCError(RPC_DATABASE_ERROR, "The db snapshot is not ready");
+
+    return pView;
+}
+
 Object SubmitTx(const CKeyID &keyid, CBaseTx &tx) {
     if (!pWalletMain->HaveKey(keyid)) {
         throw JSONRPCError(RPC_WALLET_ERROR, "Sender address not found in wallet");
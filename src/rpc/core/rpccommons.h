@@ -25,6 +25,10 @@ Array GetTxAddressDetail(std::shared_ptr<CBaseTx> pBaseTx);
 
 Object SubmitTx(const CKeyID &keyid, CBaseTx &tx);
 
+class CCacheDBManager;
+// read-only view of the state at the latest flushed tip, for the query rpcs which run without cs_main
+std::unique_ptr<CCacheDBManager> GetSnapshotView();
+
 namespace JSON {
     const Value& GetObjectFieldValue(const Value &jsonObj, const string &fieldName);
     bool  GetObjectFieldValue(const Value &jsonObj, const string &fieldName,Value& returnValue);
@@ -16,6 +16,7 @@
 #include <memory>
 #include "wallet/wallet.h"
 #include "commons/json/json_spirit_writer_template.h"
+#include "commons/json/json_stream_writer.h"
 #include "httpserver.h"
 
 using namespace std;
@@ -431,8 +432,7 @@ string JSONRPCExecBatch(const Array& vReq) {
     return write_string(Value(ret), false) + "\n";
 }
 
-json_spirit::Value CRPCTable::execute(const string& strMethod,
-                                      const json_spirit::Array& params) const {
+const CRPCCommand* CRPCTable::checkCommand(const string& strMethod) const {
     // Find method
     const CRPCCommand* pcmd = tableRPC[strMethod];
     if (!pcmd)
@@ -466,27 +466,59 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
         }
     }
 
+    return pcmd;
+}
+
+/** run the command body with the locks the command requires */
+static void RunCommand(const CRPCCommand* pcmd, const std::function<void()>& func) {
     try {
-        // Execute
-        Value result;
-        {
-            if (pcmd->threadSafe)
-                result = pcmd->actor(params, false);
-            else if (!pWalletMain) {
-                LOCK(cs_main);
-                result = pcmd->actor(params, false);
-            } else {
-                LOCK2(cs_main, pWalletMain->cs_wallet);
-                result = pcmd->actor(params, false);
-            }
+        if (pcmd->threadSafe)
+            func();
+        else if (!pWalletMain) {
+            LOCK(cs_main);
+            func();
+        } else {
+            LOCK2(cs_main, pWalletMain->cs_wallet);
+            func();
         }
-
-        return result;
     } catch (std::exception& e) {
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
 }
 
+json_spirit::Value CRPCTable::execute(const string& strMethod,
+                                      const json_spirit::Array& params) const {
+    const CRPCCommand* pcmd = checkCommand(strMethod);
+
+    // Execute
+    Value result;
+    RunCommand(pcmd, [&]() { result = pcmd->actor(params, false); });
+
+    return result;
+}
+
+void CRPCTable::executeReply(const string& strMethod, const json_spirit::Array& params,
+                             const json_spirit::Value& id, string& strReply) const {
+    const CRPCCommand* pcmd = checkCommand(strMethod);
+    if (pcmd->streamActor == nullptr) {
+        Value result;
+        RunCommand(pcmd, [&]() { result = pcmd->actor(params, false); });
+        strReply = JSONRPCReply(result, Value::null, id);
+        return;
+    }
+
+    // same layout as JSONRPCReply(), but the result is streamed by the command itself
+    strReply.clear();
+    CJsonWriter writer(strReply);
+    writer.BeginObject().Key("result");
+    RunCommand(pcmd, [&]() { pcmd->streamActor(params, writer); });
+    writer.Key("error").Null();
+    writer.Key("id").Write(id);
+    writer.EndObject();
+    assert(writer.GetDepth() == 0);
+    strReply += "\n";
+}
+
 string HelpExampleCli(string methodname, string args) {
     return "> ./coind " + methodname + " " + args + "\n";
 }
@@ -544,10 +576,7 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         // singleton request
         if (valRequest.type() == obj_type) {
             jreq.parse(valRequest);
-            Value result = tableRPC.execute(jreq.strMethod, jreq.params);
-
-            // Send reply
-            strReply = JSONRPCReply(result, Value::null, jreq.id);
+            tableRPC.executeReply(jreq.strMethod, jreq.params, jreq.id, strReply);
 
             // array of requests
         } else if (valRequest.type() == array_type)
@@ -556,7 +585,7 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strReply);
+        req->WriteReply(HTTP_OK, std::move(strReply));
     } catch (Object& objError) {
         ErrorReply(req, objError, jreq.id);
         return false;
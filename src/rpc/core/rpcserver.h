@@ -21,6 +21,7 @@
 using namespace std;
 using namespace json_spirit ;
 class CBlockIndex;
+class CJsonWriter;
 
 Value help(const Array& params, bool fHelp);
 Value stop(const Array& params, bool fHelp);
@@ -57,6 +58,8 @@ void RPCTypeCheck(const json_spirit::Object& o,
 void RPCRunLater(const std::string& name, std::function<void()> func, int64_t nSeconds);
 
 typedef json_spirit::Value (*rpcfn_type)(const json_spirit::Array& params, bool fHelp);
+/** Streaming variant of an rpc actor: writes the result straight into the reply buffer */
+typedef void (*rpcstreamfn_type)(const json_spirit::Array& params, CJsonWriter& writer);
 
 class CRPCCommand {
 public:
@@ -65,6 +68,7 @@ public:
     bool okSafeMode;
     bool threadSafe;
     bool reqWallet;
+    rpcstreamfn_type streamActor;   // optional, used instead of actor for single http requests
 };
 
 /**
@@ -87,6 +91,17 @@ public:
      * @throws an exception (json_spirit::Value) when an error happens.
      */
     json_spirit::Value execute(const string& method, const json_spirit::Array& params) const;
+
+    /**
+     * Execute a method and write the whole json-rpc reply into strReply.
+     * Methods having a streamActor write their result directly, without building a value tree.
+     * @throws an exception (json_spirit::Value) when an error happens.
+     */
+    void executeReply(const string& method, const json_spirit::Array& params, const json_spirit::Value& id,
+                      string& strReply) const;
+
+private:
+    const CRPCCommand* checkCommand(const string& method) const;
 };
 
 extern const CRPCTable tableRPC;
@@ -8,6 +8,7 @@
 
 #include "commons/json/json_spirit_utils.h"
 #include "commons/json/json_spirit_value.h"
+#include "commons/json/json_stream_writer.h"
 #include "core/rpcserver.h"
 
 using namespace std;
@@ -46,6 +47,7 @@ extern Value getsignature(const Array& params, bool fHelp);
 
 extern Value listaddr(const Array& params, bool fHelp);
 extern Value listtx(const Array& params, bool fHelp);
+extern void listtx_stream(const Array& params, CJsonWriter& writer);
 extern Value listcontractassets(const Array& params, bool fHelp);
 extern Value listcontracts(const Array& params, bool fHelp);
 extern Value listtxcache(const Array& params, bool fHelp);
@@ -166,6 +168,7 @@ extern Value submitutxospendtx(const Array& params, bool fHelp) ;
 extern Value genmulsigtx(const json_spirit::Array& params, bool fHelp);
 
 extern Value submittxraw(const json_spirit::Array& params, bool fHelp);
+extern Value submittxbatch(const json_spirit::Array& params, bool fHelp);
 
 extern Value signtxraw(const json_spirit::Array& params, bool fHelp);
 extern Value decodetxraw(const json_spirit::Array& params, bool fHelp);
@@ -176,6 +179,7 @@ extern Value getblockcount(const json_spirit::Array& params, bool fHelp);
 extern Value getdifficulty(const json_spirit::Array& params, bool fHelp);
 extern Value getrawmempool(const json_spirit::Array& params, bool fHelp);
 extern Value getblock(const json_spirit::Array& params, bool fHelp);
+extern void getblock_stream(const json_spirit::Array& params, CJsonWriter& writer);
 extern Value verifychain(const json_spirit::Array& params, bool fHelp);
 extern Value getcontractregid(const json_spirit::Array& params, bool fHelp);
 extern Value invalidateblock(const json_spirit::Array& params, bool fHelp);
@@ -199,6 +203,9 @@ extern Value submitdexsettletx(const json_spirit::Array& params, bool fHelp);
 extern Value getdexorder(const json_spirit::Array& params, bool fHelp);
 extern Value getdexsysorders(const json_spirit::Array& params, bool fHelp);
 extern Value getdexorders(const json_spirit::Array& params, bool fHelp);
+extern void getdexorder_stream(const json_spirit::Array& params, CJsonWriter& writer);
+extern void getdexsysorders_stream(const json_spirit::Array& params, CJsonWriter& writer);
+extern void getdexorders_stream(const json_spirit::Array& params, CJsonWriter& writer);
 extern Value submitdexoperatorregtx(const json_spirit::Array& params, bool fHelp);
 extern Value submitdexoperatorupdatetx(const json_spirit::Array& params, bool fHelp);
 extern Value getdexoperator(const json_spirit::Array& params, bool fHelp);
@@ -13,8 +13,8 @@
 //
 
 static const CRPCCommand vRPCCommands[] =
-{ //  name                      actor (function)         okSafeMode threadSafe reqWallet
-  //  ------------------------  -----------------------  ---------- ---------- ---------
+{ //  name                      actor (function)         okSafeMode threadSafe reqWallet streamActor (optional)
+  //  ------------------------  -----------------------  ---------- ---------- --------- ----------------------
     /* Overall control/query calls */
     { "help",                           &help,                              true,      true,        false   },
     { "getinfo",                        &getinfo,                           true,      false,       false   }, /* uses wallet if enabled */
@@ -35,7 +35,7 @@ static const CRPCCommand vRPCCommands[] =
     /* Block chain and UTXO */
     { "getfcoingenesistxinfo",          &getfcoingenesistxinfo,             true,      true,        false   },
     { "getblockcount",                  &getblockcount,                     true,      true,        false   },
-    { "getblock",                       &getblock,                          true,      false,       false   },
+    { "getblock",                       &getblock,                          true,      false,       false,   &getblock_stream },
     { "getrawmempool",                  &getrawmempool,                     true,      false,       false   },
     { "verifychain",                    &verifychain,                       true,      false,       false   },
     { "getblockundo",                   &getblockundo,                      true,      false,       false   },
@@ -71,7 +71,7 @@ static const CRPCCommand vRPCCommands[] =
     { "walletpassphrase",               &walletpassphrase,                  false,     false,       true    },
 
     { "listaddr",                       &listaddr,                          true,      false,       true    },
-    { "listtx",                         &listtx,                            true,      false,       true    },
+    { "listtx",                         &listtx,                            true,      false,       true,    &listtx_stream },
     { "setgenerate",                    &setgenerate,                       true,      true,        false   },
     { "listcontracts",                  &listcontracts,                     true,      false,       true    },
     { "getcontractinfo",                &getcontractinfo,                   true,      false,       true    },
@@ -90,6 +90,7 @@ static const CRPCCommand vRPCCommands[] =
     { "decodemulsigscript",             &decodemulsigscript,                true,       false,      false   },
     /* submit raw tx */
     { "submittxraw",                    &submittxraw,                       true,       false,      false   },
+    { "submittxbatch",                  &submittxbatch,                     true,       false,      false   },
     /* basic tx */
     { "submitsendtx",                   &submitsendtx,                      false,      false,      true    },
     { "submitcreateutxotx",             &submitcreateutxotx,                false,      false,      true    },
@@ -118,8 +119,8 @@ static const CRPCCommand vRPCCommands[] =
     { "submitcdpredeemtx",              &submitcdpredeemtx,                 false,      false,      true    },
     { "submitcdpliquidatetx",           &submitcdpliquidatetx,              false,      false,      true    },
     { "getscoininfo",                   &getscoininfo,                      true,       false,      false   },
-    { "getcdp",                         &getcdp,                            true,       false,      false   },
-    { "getusercdp",                     &getusercdp,                        true,       false,      false   },
+    { "getcdp",                         &getcdp,                            true,       true,       false   },
+    { "getusercdp",                     &getusercdp,                        true,       true,       false   },
     { "getcdpcoinpairs",                &getcdpcoinpairs,                   true,       false,      false   },
 
     { "getsysparam",                    &getsysparam,                       true,       false,      false   },
@@ -136,17 +137,17 @@ static const CRPCCommand vRPCCommands[] =
     { "submitdexcancelordertx",         &submitdexcancelordertx,            false,      false,      false   },
     { "submitdexoperatorregtx",         &submitdexoperatorregtx,            false,      false,      false   },
     { "submitdexoperatorupdatetx",      &submitdexoperatorupdatetx,         false,      false,      false   },
-    { "getdexorder",                    &getdexorder,                       true,       false,      false   },
-    { "getdexsysorders",                &getdexsysorders,                   true,       false,      false   },
-    { "getdexorders",                   &getdexorders,                      true,       false,      false   },
+    { "getdexorder",                    &getdexorder,                       true,       true,       false,   &getdexorder_stream },
+    { "getdexsysorders",                &getdexsysorders,                   true,       true,       false,   &getdexsysorders_stream },
+    { "getdexorders",                   &getdexorders,                      true,       true,       false,   &getdexorders_stream },
     { "getdexoperator",                 &getdexoperator,                    true,       false,      false   },
     { "getdexoperatorbyowner",          &getdexoperatorbyowner,             true,       false,      false   },
     { "getdexorderfee",                 &getdexorderfee,                    true,       false,      false   },
     /* for asset */
     { "submitassetissuetx",             &submitassetissuetx,                false,      false,      false   },
     { "submitassetupdatetx",            &submitassetupdatetx,               false,      false,      false   },
-    { "getasset",                       &getasset,                          true,       false,      false   },
-    { "getassets",                      &getassets,                         true,       false,      false   },
+    { "getasset",                       &getasset,                          true,       true,       false   },
+    { "getassets",                      &getassets,                         true,       true,       false   },
     /* for wasm */
     { "submitwasmcontractdeploytx",     &submitwasmcontractdeploytx,        true,       false,      true    },
     { "submitwasmcontractcalltx",       &submitwasmcontractcalltx,          true,       false,      true    },
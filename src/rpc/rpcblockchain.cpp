@@ -69,6 +69,48 @@ Object BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex) {
     return result;
 }
 
+static void BlockToJSON(const CBlock& block, const CBlockIndex* pBlockIndex, CJsonWriter& writer) {
+    writer.BeginObject();
+    writer.Pair("block_hash",       block.GetHash().GetHex());
+    writer.Pair("block_miner",      block.vptx[0]->txUid.ToString());
+
+    CMerkleTx txGen(block.vptx[0]);
+    txGen.SetMerkleBranch(&block);
+    writer.Pair("confirmations",    (int32_t)txGen.GetDepthInMainChain());
+    writer.Pair("size",             (int32_t)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+    writer.Pair("height",           (int32_t)block.GetHeight());
+    writer.Pair("version",          block.GetVersion());
+    writer.Pair("merkle_root",      block.GetMerkleRootHash().GetHex());
+    writer.Pair("tx_count",         (int32_t)block.vptx.size());
+    writer.Key("tx").BeginArray();
+    for (const auto& ptx : block.vptx)
+        writer.Write(ptx->GetHash().GetHex());
+    writer.EndArray();
+    writer.Pair("time",             block.GetBlockTime());
+    writer.Pair("nonce",            (uint64_t)block.GetNonce());
+
+    if (pBlockIndex->pprev)
+        writer.Pair("previous_block_hash", pBlockIndex->pprev->GetBlockHash().GetHex());
+    CBlockIndex* pNext = chainActive.Next(pBlockIndex);
+    if (pNext)
+        writer.Pair("next_block_hash", pNext->GetBlockHash().GetHex());
+
+    writer.Key("median_price").BeginArray();
+    for (auto &item : block.GetBlockMedianPrice()) {
+        if (item.second == 0) {
+            continue;
+        }
+
+        writer.BeginObject();
+        writer.Pair("coin_symbol",  item.first.first);
+        writer.Pair("price_symbol", item.first.second);
+        writer.Pair("price",        (double) item.second / PRICE_BOOST);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
 Value getblockcount(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 0)
         throw runtime_error(
@@ -143,9 +185,8 @@ Value getrawmempool(const Array& params, bool fHelp)
     if (fVerbose) {
         LOCK(mempool.cs);
         Object obj;
-        for (const auto& entry : mempool.memPoolTxs) {
-            const uint256& hash      = entry.first;
-            const CTxMemPoolEntry& e = entry.second;
+        for (const auto& e : mempool.memPoolTxs) {
+            const uint256& hash      = e.GetHash();
             Object info;
             info.push_back(Pair("size",         (int)e.GetTxSize()));
             info.push_back(Pair("fees_type",    std::get<0>(e.GetFees())));
@@ -170,6 +211,43 @@ Value getrawmempool(const Array& params, bool fHelp)
     }
 }
 
+/** read the block selected by the getblock params, returns the verbose flag */
+static bool ReadBlockParams(const Array& params, CBlock& block, CBlockIndex*& pBlockIndex) {
+    // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
+
+    std::string strHash;
+    if (int_type == params[0].type()) {
+        int height = params[0].get_int();
+        if (height < 0 || height > chainActive.Height())
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
+
+        strHash = chainActive[height]->GetBlockHash().GetHex();
+    } else {
+        strHash = params[0].get_str();
+    }
+    uint256 hash(uint256S(strHash));
+
+    bool fVerbose = true;
+    if (params.size() > 1)
+        fVerbose = params[1].get_bool();
+
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    pBlockIndex = mapBlockIndex[hash];
+    if (!ReadBlockFromDisk(pBlockIndex, block)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+    }
+
+    return fVerbose;
+}
+
+static string BlockToHex(const CBlock& block) {
+    CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+    ssBlock << block;
+    return HexStr(ssBlock.begin(), ssBlock.end());
+}
+
 Value getblock(const Array& params, bool fHelp) {
     if (fHelp || params.size() < 1 || params.size() > 2) {
         throw runtime_error(
@@ -207,42 +285,26 @@ Value getblock(const Array& params, bool fHelp) {
             HelpExampleRpc("getblock", "\"d640d051704155b1fd3ec8d0331497448c259b0ab0499e109da7ae2bc7423bc2\""));
     }
 
-    // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
-
-    std::string strHash;
-    if (int_type == params[0].type()) {
-        int height = params[0].get_int();
-        if (height < 0 || height > chainActive.Height())
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
-
-        CBlockIndex* pBlockIndex = chainActive[height];
-        strHash                  = pBlockIndex->GetBlockHash().GetHex();
-    } else {
-        strHash = params[0].get_str();
-    }
-    uint256 hash(uint256S(strHash));
+    CBlock block;
+    CBlockIndex* pBlockIndex = nullptr;
+    if (!ReadBlockParams(params, block, pBlockIndex))
+        return BlockToHex(block);
 
-    bool fVerbose = true;
-    if (params.size() > 1)
-        fVerbose = params[1].get_bool();
+    return BlockToJSON(block, pBlockIndex);
+}
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+void getblock_stream(const Array& params, CJsonWriter& writer) {
+    if (params.size() < 1 || params.size() > 2)
+        getblock(params, true);
 
     CBlock block;
-    CBlockIndex* pBlockIndex = mapBlockIndex[hash];
-    if (!ReadBlockFromDisk(pBlockIndex, block)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
-
-    if (!fVerbose) {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
-        return strHex;
+    CBlockIndex* pBlockIndex = nullptr;
+    if (!ReadBlockParams(params, block, pBlockIndex)) {
+        writer.Write(BlockToHex(block));
+        return;
     }
 
-    return BlockToJSON(block, pBlockIndex);
+    BlockToJSON(block, pBlockIndex, writer);
 }
 
 Value verifychain(const Array& params, bool fHelp) {
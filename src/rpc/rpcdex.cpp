@@ -651,6 +651,82 @@ Value submitdexsettletx(const Array& params, bool fHelp) {
     return SubmitTx(account.keyid, tx);
 }
 
+static void GetActiveOrder(const uint256 &orderId, CDEXOrderDetail &orderDetail) {
+    auto pView = GetSnapshotView();
+    if (!pView->pDexCache->GetActiveOrder(orderId, orderDetail))
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("The order not exists or inactive! order_id=%s", orderId.ToString()));
+}
+
+static shared_ptr<CDEXSysOrdersGetter> QueryDexSysOrders(const Array& params, CCacheDBManager &view, int64_t &height) {
+    int64_t tipHeight = view.GetSnapshotHeight();
+    height            = tipHeight;
+    if (params.size() > 0)
+        height = params[0].get_int64();
+
+    if (height < 0 || height > tipHeight) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("height=%d must >= 0 and <= tip_height=%d", height, tipHeight));
+    }
+
+    auto pGetter = view.pDexCache->CreateSysOrdersGetter();
+    if (!pGetter->Execute(height)) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get system-generated orders error! height=%d", height));
+    }
+    return pGetter;
+}
+
+static shared_ptr<CDEXOrdersGetter> QueryDexOrders(const Array& params, CCacheDBManager &view, string &newLastPosInfo) {
+    int64_t tipHeight = view.GetSnapshotHeight();
+    int64_t beginHeight = 0;
+    if (params.size() > 0)
+        beginHeight = params[0].get_int64();
+    if (beginHeight < 0 || beginHeight > tipHeight) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("begin_height=%d must >= 0 and <= tip_height=%d", beginHeight, tipHeight));
+    }
+
+    int64_t endHeight = tipHeight;
+    if (params.size() > 1)
+        endHeight = params[1].get_int64();
+    if (endHeight < beginHeight || endHeight > tipHeight) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("end_height=%d must >= begin_height=%d and <= tip_height=%d",
+            endHeight, beginHeight, tipHeight));
+    }
+
+
+    int64_t maxCount = 500;
+    if (params.size() > 2) {
+        maxCount = params[2].get_int64();
+        if (maxCount < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_count=%d must >= 0", maxCount));
+    }
+
+    DEXBlockOrdersCache::KeyType lastKey;
+    if (params.size() > 3) {
+        string lastPosInfo = RPC_PARAM::GetBinStrFromHex(params[3], "last_pos_info");
+        auto err = DEX_DB::ParseLastPos(lastPosInfo, lastKey);
+        if (err)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Invalid last_pos_info! %s", *err));
+        uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
+        if (lastHeight < beginHeight || lastHeight > endHeight)
+            throw JSONRPCError(RPC_INVALID_PARAMS,
+                               strprintf("Invalid last_pos_info! height of last_pos_info is not in "
+                                         "range(begin=%d,end=%d) ",
+                                         beginHeight, endHeight));
+    }
+
+    auto pGetter = view.pDexCache->CreateOrdersGetter();
+    if (!pGetter->Execute(beginHeight, endHeight, maxCount, lastKey)) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get all active orders error! begin_height=%d, end_height=%d",
+            beginHeight, endHeight));
+    }
+
+    if (pGetter->has_more) {
+        auto err = DEX_DB::MakeLastPos(pGetter->last_key, newLastPosInfo);
+        if (err)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Make new last_pos_info error! %s", *err));
+    }
+    return pGetter;
+}
+
 Value getdexorder(const Array& params, bool fHelp) {
      if (fHelp || params.size() != 1) {
         throw runtime_error(
@@ -666,17 +742,27 @@ Value getdexorder(const Array& params, bool fHelp) {
         );
     }
     const uint256 &orderId = RPC_PARAM::GetTxid(params[0], "order_id");
-
-    auto pDexCache = pCdMan->pDexCache;
     CDEXOrderDetail orderDetail;
-    if (!pDexCache->GetActiveOrder(orderId, orderDetail))
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("The order not exists or inactive! order_id=%s", orderId.ToString()));
+    GetActiveOrder(orderId, orderDetail);
 
     Object obj;
     DEX_DB::OrderToJson(orderId, orderDetail, obj);
     return obj;
 }
 
+void getdexorder_stream(const Array& params, CJsonWriter& writer) {
+    if (params.size() != 1)
+        getdexorder(params, true);
+
+    const uint256 &orderId = RPC_PARAM::GetTxid(params[0], "order_id");
+    CDEXOrderDetail orderDetail;
+    GetActiveOrder(orderId, orderDetail);
+
+    writer.BeginObject();
+    DEX_DB::OrderToJson(orderId, orderDetail, writer);
+    writer.EndObject();
+}
+
 extern Value getdexsysorders(const Array& params, bool fHelp) {
      if (fHelp || params.size() > 1) {
         throw runtime_error(
@@ -694,19 +780,9 @@ extern Value getdexsysorders(const Array& params, bool fHelp) {
         );
     }
 
-    int64_t tipHeight = chainActive.Height();
-    int64_t height    = tipHeight;
-    if (params.size() > 0)
-        height = params[0].get_int64();
-
-    if (height < 0 || height > tipHeight) {
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("height=%d must >= 0 and <= tip_height=%d", height, tipHeight));
-    }
-
-    auto pGetter = pCdMan->pDexCache->CreateSysOrdersGetter();
-    if (!pGetter->Execute(height)) {
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get system-generated orders error! height=%d", height));
-    }
+    auto pView = GetSnapshotView();
+    int64_t height;
+    auto pGetter = QueryDexSysOrders(params, *pView, height);
 
     Object obj;
     obj.push_back(Pair("height", height));
@@ -715,6 +791,20 @@ extern Value getdexsysorders(const Array& params, bool fHelp) {
     return obj;
 }
 
+void getdexsysorders_stream(const Array& params, CJsonWriter& writer) {
+    if (params.size() > 1)
+        getdexsysorders(params, true);
+
+    auto pView = GetSnapshotView();
+    int64_t height;
+    auto pGetter = QueryDexSysOrders(params, *pView, height);
+
+    writer.BeginObject();
+    writer.Pair("height", height);
+    pGetter->ToJson(writer);
+    writer.EndObject();
+}
+
 extern Value getdexorders(const Array& params, bool fHelp) {
      if (fHelp || params.size() > 4) {
         throw runtime_error(
@@ -739,56 +829,10 @@ extern Value getdexorders(const Array& params, bool fHelp) {
         );
     }
 
-    int64_t tipHeight = chainActive.Height();
-    int64_t beginHeight = 0;
-    if (params.size() > 0)
-        beginHeight = params[0].get_int64();
-    if (beginHeight < 0 || beginHeight > tipHeight) {
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("begin_height=%d must >= 0 and <= tip_height=%d", beginHeight, tipHeight));
-    }
-
-    int64_t endHeight = tipHeight;
-    if (params.size() > 1)
-        endHeight = params[1].get_int64();
-    if (endHeight < beginHeight || endHeight > tipHeight) {
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("end_height=%d must >= begin_height=%d and <= tip_height=%d",
-            endHeight, beginHeight, tipHeight));
-    }
-
-
-    int64_t maxCount = 500;
-    if (params.size() > 2) {
-        maxCount = params[2].get_int64();
-        if (maxCount < 0)
-            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_count=%d must >= 0", maxCount));
-    }
-
-    DEXBlockOrdersCache::KeyType lastKey;
-    if (params.size() > 3) {
-        string lastPosInfo = RPC_PARAM::GetBinStrFromHex(params[3], "last_pos_info");
-        auto err = DEX_DB::ParseLastPos(lastPosInfo, lastKey);
-        if (err)
-            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Invalid last_pos_info! %s", *err));
-        uint32_t lastHeight = DEX_DB::GetHeight(lastKey);
-        if (lastHeight < beginHeight || lastHeight > endHeight)
-            throw JSONRPCError(RPC_INVALID_PARAMS,
-                               strprintf("Invalid last_pos_info! height of last_pos_info is not in "
-                                         "range(begin=%d,end=%d) ",
-                                         beginHeight, endHeight));
-    }
-
-    auto pGetter = pCdMan->pDexCache->CreateOrdersGetter();
-    if (!pGetter->Execute(beginHeight, endHeight, maxCount, lastKey)) {
-        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get all active orders error! begin_height=%d, end_height=%d",
-            beginHeight, endHeight));
-    }
-
+    auto pView = GetSnapshotView();
     string newLastPosInfo;
-    if (pGetter->has_more) {
-        auto err = DEX_DB::MakeLastPos(pGetter->last_key, newLastPosInfo);
-        if (err)
-            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Make new last_pos_info error! %s", *err));
-    }
+    auto pGetter = QueryDexOrders(params, *pView, newLastPosInfo);
+
     Object obj;
     obj.push_back(Pair("begin_height", (int64_t)pGetter->begin_height));
     obj.push_back(Pair("end_height", (int64_t)pGetter->end_height));
@@ -798,6 +842,23 @@ extern Value getdexorders(const Array& params, bool fHelp) {
     return obj;
 }
 
+void getdexorders_stream(const Array& params, CJsonWriter& writer) {
+    if (params.size() > 4)
+        getdexorders(params, true);
+
+    auto pView = GetSnapshotView();
+    string newLastPosInfo;
+    auto pGetter = QueryDexOrders(params, *pView, newLastPosInfo);
+
+    writer.BeginObject();
+    writer.Pair("begin_height", (int64_t)pGetter->begin_height);
+    writer.Pair("end_height", (int64_t)pGetter->end_height);
+    writer.Pair("has_more", pGetter->has_more);
+    writer.Pair("last_pos_info", HexStr(newLastPosInfo));
+    pGetter->ToJson(writer);
+    writer.EndObject();
+}
+
 
 void checkAccountRegId(const CUserID uid , const string field){
 
@@ -12,6 +12,7 @@
 #include "rpc/core/rpccommons.h"
 #include "rpc/core/rpcserver.h"
 #include "commons/util/util.h"
+#include "vm/wasm/wasm_interface.hpp"
 
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
@@ -70,6 +71,7 @@ Value getinfo(const Array& params, bool fHelp) {
             "{\n"
             "  \"version\": \"xxxxx\",          (string) the node program fullversion\n"
             "  \"protocol_version\": xxxxx,     (numeric) the protocol version\n"
+            "  \"sha256_impl\": \"xxxxx\",      (string) the SHA-256 implementation detected for this cpu\n"
             "  \"net_type\": \"xxxxx\",         (string) the blockchain network type (MAIN_NET|TEST_NET|REGTEST_NET)\n"
             "  \"proxy\": \"host:port\",        (string) the proxy server used by the node program\n"
             "  \"public_ip\": \"xxxxx\",        (string) the public IP of this node\n"
@@ -94,6 +96,14 @@ Value getinfo(const Array& params, bool fHelp) {
             "  \"tipblock_height\": xxxxx ,     (numeric) the number of blocks contained the most work in the network\n"
             "  \"synblock_height\": xxxxx ,     (numeric) the block height of the loggest chain found in the network\n"
             "  \"connections\": xxxxx,          (numeric) the number of connections\n"
+            "  \"wasm_cache\": {                (object) cache of the instantiated wasm contract modules\n"
+            "    \"count\": xxx,                (numeric) number of cached modules\n"
+            "    \"size\": xxx,                 (numeric) memory of the cached modules in bytes\n"
+            "    \"max_size\": xxx,             (numeric) memory bound of the cache in bytes (-wasmcachesize)\n"
+            "    \"hits\": xxx,                 (numeric) contract calls served from the cache\n"
+            "    \"misses\": xxx,               (numeric) contract calls that instantiated the module\n"
+            "    \"evictions\": xxx             (numeric) modules evicted from the cache\n"
+            "  }\n"
             "  \"errors\": \"xxxxx\"            (string) any error messages\n"
             "}\n"
             "\nExamples:\n" +
@@ -106,6 +116,7 @@ Value getinfo(const Array& params, bool fHelp) {
     Object obj;
     obj.push_back(Pair("version",               fullVersion));
     obj.push_back(Pair("protocol_version",      PROTOCOL_VERSION));
+    obj.push_back(Pair("sha256_impl",           sha256Impl));
     obj.push_back(Pair("net_type",              NetTypeNames[SysCfg().NetworkID()]));
     obj.push_back(Pair("proxy",                 (proxy.first.IsValid() ? proxy.first.ToStringIPPort() : string())));
     obj.push_back(Pair("public_ip",             publicIp));
@@ -142,6 +153,17 @@ Value getinfo(const Array& params, bool fHelp) {
     obj.push_back(Pair("local_finblock_hash",    localFinIndex->GetBlockHash().GetHex())) ;
 
     obj.push_back(Pair("connections",           (int32_t)vNodes.size()));
+
+    wasm::wasm_code_cache_stats wasmCacheStats = wasm::get_wasm_code_cache_stats();
+    Object wasmCache;
+    wasmCache.push_back(Pair("count",           wasmCacheStats.count));
+    wasmCache.push_back(Pair("size",            wasmCacheStats.memory_size));
+    wasmCache.push_back(Pair("max_size",        wasmCacheStats.max_memory_size));
+    wasmCache.push_back(Pair("hits",            wasmCacheStats.hits));
+    wasmCache.push_back(Pair("misses",          wasmCacheStats.misses));
+    wasmCache.push_back(Pair("evictions",       wasmCacheStats.evictions));
+    obj.push_back(Pair("wasm_cache",            wasmCache));
+
     obj.push_back(Pair("errors",                GetWarnings("statusbar")));
 
     return obj;
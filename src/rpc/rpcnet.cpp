@@ -8,6 +8,7 @@
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
+#include "p2p/blockmessagecache.h"
 #include "p2p/protocol.h"
 #include "sync.h"
 #include "commons/util/util.h"
@@ -341,6 +342,13 @@ Value getnetworkinfo(const Array& params, bool fHelp) {
             "    \"port\": xxx,              (numeric) network port\n"
             "    \"score\": xxx              (numeric) relative score\n"
             "  ]\n"
+            "  \"block_cache\": {           (object) cache of the serialized recent blocks served to peers\n"
+            "    \"count\": xxx,             (numeric) number of cached blocks\n"
+            "    \"size\": xxx,              (numeric) total size of the cached blocks in bytes\n"
+            "    \"hits\": xxx,              (numeric) block requests served from the cache\n"
+            "    \"misses\": xxx,            (numeric) block requests read from disk\n"
+            "    \"evictions\": xxx          (numeric) blocks evicted from the cache\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getnetworkinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getnetworkinfo", ""));
@@ -368,6 +376,15 @@ Value getnetworkinfo(const Array& params, bool fHelp) {
         }
     }
     obj.push_back(Pair("localaddresses",    localAddresses));
+
+    CBlockMessageCacheStats blockCacheStats = blockMessageCache.GetStats();
+    Object blockCache;
+    blockCache.push_back(Pair("count",      blockCacheStats.count));
+    blockCache.push_back(Pair("size",       blockCacheStats.size));
+    blockCache.push_back(Pair("hits",       blockCacheStats.hits));
+    blockCache.push_back(Pair("misses",     blockCacheStats.misses));
+    blockCache.push_back(Pair("evictions",  blockCacheStats.evictions));
+    obj.push_back(Pair("block_cache",       blockCache));
     return obj;
 }
 
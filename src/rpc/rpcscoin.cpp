@@ -411,17 +411,18 @@ Value getusercdp(const Array& params, bool fHelp){
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid addr");
     }
 
+    auto pView = GetSnapshotView();
     CAccount account;
-    if (!pCdMan->pAccountCache->GetAccount(*pUserId, account)) {
+    if (!pView->pAccountCache->GetAccount(*pUserId, account)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("The account not exists! userId=%s", pUserId->ToString()));
     }
 
-    uint64_t bcoinMedianPrice = pCdMan->pBlockCache->GetMedianPrice(CoinPricePair(SYMB::WICC, SYMB::USD));
+    uint64_t bcoinMedianPrice = pView->pBlockCache->GetMedianPrice(CoinPricePair(SYMB::WICC, SYMB::USD));
 
     Object obj;
     Array cdps;
     vector<CUserCDP> userCdps;
-    if (pCdMan->pCdpCache->GetCDPList(account.regid, userCdps)) {
+    if (pView->pCdpCache->GetCDPList(account.regid, userCdps)) {
         for (auto& cdp : userCdps) {
             cdps.push_back(cdp.ToJson(bcoinMedianPrice));
         }
@@ -447,11 +448,12 @@ Value getcdp(const Array& params, bool fHelp){
         );
     }
 
-    uint64_t bcoinMedianPrice = pCdMan->pBlockCache->GetMedianPrice(CoinPricePair(SYMB::WICC, SYMB::USD));
+    auto pView = GetSnapshotView();
+    uint64_t bcoinMedianPrice = pView->pBlockCache->GetMedianPrice(CoinPricePair(SYMB::WICC, SYMB::USD));
 
     uint256 cdpTxId(uint256S(params[0].get_str()));
     CUserCDP cdp;
-    if (!pCdMan->pCdpCache->GetCDP(cdpTxId, cdp)) {
+    if (!pView->pCdpCache->GetCDP(cdpTxId, cdp)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("CDP (%s) does not exist!", cdpTxId.GetHex()));
     }
 
@@ -699,11 +701,12 @@ extern Value getasset(const Array& params, bool fHelp) {
     }
     const TokenSymbol& assetSymbol = RPC_PARAM::GetAssetIssueSymbol(params[0]);
 
+    auto pView = GetSnapshotView();
     CAsset asset;
-    if (!pCdMan->pAssetCache->GetAsset(assetSymbol, asset))
+    if (!pView->pAssetCache->GetAsset(assetSymbol, asset))
         throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("asset not exist! asset_symbol=%s", assetSymbol));
 
-    Object obj = AssetToJson(*pCdMan->pAccountCache, asset);
+    Object obj = AssetToJson(*pView->pAccountCache, asset);
     return obj;
 }
 
@@ -721,14 +724,15 @@ extern Value getassets(const Array& params, bool fHelp) {
         );
     }
 
-    auto pAssetsIt = pCdMan->pAssetCache->CreateUserAssetsIterator();
+    auto pView = GetSnapshotView();
+    auto pAssetsIt = pView->pAssetCache->CreateUserAssetsIterator();
     if (!pAssetsIt) {
         throw JSONRPCError(RPC_INVALID_PARAMS, "get all user issued assets iterator error!");
     }
 
     Array assetArray;
     for (pAssetsIt->First(); pAssetsIt->IsValid(); pAssetsIt->Next()) {
-        assetArray.push_back(AssetToJson(*pCdMan->pAccountCache, pAssetsIt->GetAsset()));
+        assetArray.push_back(AssetToJson(*pView->pAccountCache, pAssetsIt->GetAsset()));
     }
 
     Object obj;
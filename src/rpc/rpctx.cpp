@@ -711,23 +711,8 @@ Value listaddr(const Array& params, bool fHelp) {
     return retArray;
 }
 
-Value listtx(const Array& params, bool fHelp) {
-if (fHelp || params.size() > 2) {
-        throw runtime_error("listtx\n"
-                "\nget all confirmed transactions and all unconfirmed transactions from wallet.\n"
-                "\nArguments:\n"
-                "1. count          (numeric, optional, default=10) The number of transactions to return\n"
-                "2. from           (numeric, optional, default=0) The number of transactions to skip\n"
-                "\nResult:\n"
-                "\nExamples:\n"
-                "\nList the most recent 10 transactions in the system\n"
-                + HelpExampleCli("listtx", "") +
-                "\nList transactions 100 to 120\n"
-                + HelpExampleCli("listtx", "20 100")
-            );
-    }
-
-    Object retObj;
+/** the txids of the confirmed wallet txs selected by the listtx params, the most recent first */
+static void ListConfirmedWalletTxids(const Array& params, vector<uint256> &confirmedTxids) {
     int32_t nDefCount = 10;
     int32_t nFrom = 0;
     if (params.size() > 0) {
@@ -739,7 +724,6 @@ if (fHelp || params.size() > 2) {
     }
     assert(pWalletMain != nullptr);
 
-    Array confirmedTxArray;
     int32_t nCount = 0;
     map<int32_t, uint256, std::greater<int32_t> > blockInfoMap;
     for (auto const &wtx : pWalletMain->mapInBlockTx) {
@@ -749,7 +733,7 @@ if (fHelp || params.size() > 2) {
     }
     bool bUpLimited = false;
     for (auto const &blockInfo : blockInfoMap) {
-        CAccountTx accountTx = pWalletMain->mapInBlockTx[blockInfo.second];
+        const CAccountTx &accountTx = pWalletMain->mapInBlockTx[blockInfo.second];
         for (auto const & item : accountTx.mapAccountTx) {
             if (nFrom-- > 0)
                 continue;
@@ -757,12 +741,37 @@ if (fHelp || params.size() > 2) {
                 bUpLimited = true;
                 break;
             }
-            confirmedTxArray.push_back(item.first.GetHex());
+            confirmedTxids.push_back(item.first);
         }
         if (bUpLimited) {
             break;
         }
     }
+}
+
+Value listtx(const Array& params, bool fHelp) {
+if (fHelp || params.size() > 2) {
+        throw runtime_error("listtx\n"
+                "\nget all confirmed transactions and all unconfirmed transactions from wallet.\n"
+                "\nArguments:\n"
+                "1. count          (numeric, optional, default=10) The number of transactions to return\n"
+                "2. from           (numeric, optional, default=0) The number of transactions to skip\n"
+                "\nResult:\n"
+                "\nExamples:\n"
+                "\nList the most recent 10 transactions in the system\n"
+                + HelpExampleCli("listtx", "") +
+                "\nList transactions 100 to 120\n"
+                + HelpExampleCli("listtx", "20 100")
+            );
+    }
+
+    vector<uint256> confirmedTxids;
+    ListConfirmedWalletTxids(params, confirmedTxids);
+
+    Object retObj;
+    Array confirmedTxArray;
+    for (const auto &txid : confirmedTxids)
+        confirmedTxArray.push_back(txid.GetHex());
     retObj.push_back(Pair("confirmed_tx", confirmedTxArray));
 
     Array unconfirmedTxArray;
@@ -775,6 +784,26 @@ if (fHelp || params.size() > 2) {
     return retObj;
 }
 
+void listtx_stream(const Array& params, CJsonWriter& writer) {
+    if (params.size() > 2)
+        listtx(params, true);
+
+    vector<uint256> confirmedTxids;
+    ListConfirmedWalletTxids(params, confirmedTxids);
+
+    writer.BeginObject();
+    writer.Key("confirmed_tx").BeginArray();
+    for (const auto &txid : confirmedTxids)
+        writer.Write(txid.GetHex());
+    writer.EndArray();
+
+    writer.Key("unconfirmed_tx").BeginArray();
+    for (auto const &tx : pWalletMain->unconfirmedTx)
+        writer.Write(tx.first.GetHex());
+    writer.EndArray();
+    writer.EndObject();
+}
+
 Value getaccountinfo(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 1) {
         throw runtime_error(
@@ -1159,6 +1188,66 @@ Value submittxraw(const Array& params, bool fHelp) {
     return obj;
 }
 
+Value submittxbatch(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 1) {
+        throw runtime_error(
+            "submittxbatch [\"rawtx\",...]\n"
+            "\nsubmit raw transactions (hex format) in one batch, accepted to the mempool in order\n"
+            "\nArguments:\n"
+            "1.\"rawtxs\":   (array of string, required) The raw transactions, at most " +
+            strprintf("%u", MAX_SUBMIT_TX_BATCH_SIZE) + "\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"accepted\": n,       (numeric) The number of accepted transactions\n"
+            "  \"results\": [         (array) The result of each raw transaction, in the order of the arguments\n"
+            "    {\"txid\": \"txid\"} or {\"error\": \"reason\"}\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("submittxbatch", "\"[\\\"0b01848908020001145e...\\\", \\\"0b0184890802000114b5...\\\"]\"") +
+            "\nAs json rpc call\n" +
+            HelpExampleRpc("submittxbatch", "[\"0b01848908020001145e...\", \"0b0184890802000114b5...\"]"));
+    }
+
+    const Array& rawTxs = params[0].get_array();
+    if (rawTxs.empty() || rawTxs.size() > MAX_SUBMIT_TX_BATCH_SIZE)
+        throw JSONRPCError(RPC_INVALID_PARAMETER,
+                           strprintf("The number of rawtxs must be in [1, %u]", MAX_SUBMIT_TX_BATCH_SIZE));
+
+    vector<std::shared_ptr<CBaseTx>> vptx;
+    vptx.reserve(rawTxs.size());
+    for (const auto& rawTx : rawTxs) {
+        vector<uint8_t> vch(ParseHex(rawTx.get_str()));
+        if (vch.size() > MAX_RPC_SIG_STR_LEN)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "The rawtx is too long.");
+
+        CDataStream stream(vch, SER_DISK, CLIENT_VERSION);
+        std::shared_ptr<CBaseTx> tx;
+        stream >> tx;
+        vptx.push_back(tx);
+    }
+
+    auto results = pWalletMain->CommitTxBatch(vptx);
+
+    uint32_t nAccepted = 0;
+    Array arrResults;
+    for (const auto& ret : results) {
+        Object item;
+        if (std::get<0>(ret)) {
+            item.push_back(Pair("txid", std::get<1>(ret)));
+            nAccepted++;
+        } else {
+            item.push_back(Pair("error", std::get<1>(ret)));
+        }
+        arrResults.push_back(item);
+    }
+
+    Object obj;
+    obj.push_back(Pair("accepted", (uint64_t)nAccepted));
+    obj.push_back(Pair("results", arrResults));
+    return obj;
+}
+
 class CTxMultiSigner {
 public:
     struct SigningItem {
@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "p2p/blockencodings.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+#include "tx/txmempool.h"
+#include "tx/txserializer.h"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(blockencodings_tests)
+
+static CBlock BuildBlock(const int32_t txCount) {
+    CBlock block;
+    block.SetHeight(100);
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(UnsignedCharArray(), 0, 100));
+    for (int32_t i = 0; i < txCount; i++) {
+        block.vptx.push_back(
+            std::make_shared<CBaseCoinTransferTx>(CRegID(1, i), CRegID(2, i), 100, 10000 + i, 10000, ""));
+    }
+    block.SetMerkleRootHash(block.BuildMerkleTree());
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(rebuild_with_missing_txs)
+{
+    CBlock block = BuildBlock(5);
+    CBlockHeaderAndShortTxIDs cmpctBlock(block);
+    BOOST_CHECK_EQUAL(cmpctBlock.prefilledTxs.size(), 1U);
+    BOOST_CHECK_EQUAL(cmpctBlock.shortTxIds.size(), 5U);
+
+    // the receiver derives the same short ids from the deserialized header and nonce
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << cmpctBlock;
+    CBlockHeaderAndShortTxIDs received;
+    ss >> received;
+    BOOST_CHECK(received.header.GetHash() == block.GetHash());
+    for (size_t i = 1; i < block.vptx.size(); i++)
+        BOOST_CHECK_EQUAL(received.GetShortID(block.vptx[i]->GetHash()), cmpctBlock.shortTxIds[i - 1]);
+
+    // an empty mempool misses every tx but the block reward
+    CTxMemPool pool;
+    CPartiallyDownloadedBlock partialBlock;
+    BOOST_CHECK(partialBlock.InitData(received, pool) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.IsTxAvailable(0));
+    vector<std::shared_ptr<CBaseTx>> missingTxs;
+    for (size_t i = 1; i < block.vptx.size(); i++) {
+        BOOST_CHECK(!partialBlock.IsTxAvailable(i));
+        missingTxs.push_back(block.vptx[i]);
+    }
+
+    CBlock rebuilt;
+    BOOST_CHECK(partialBlock.FillBlock(rebuilt, missingTxs) == READ_STATUS_OK);
+    BOOST_CHECK(rebuilt.GetHash() == block.GetHash());
+    BOOST_CHECK(rebuilt.BuildMerkleTree() == block.GetMerkleRootHash());
+
+    // too few or too many txs are malformed, wrong txs fail the merkle root check
+    vector<std::shared_ptr<CBaseTx>> fewerTxs(missingTxs.begin() + 1, missingTxs.end());
+    BOOST_CHECK(partialBlock.FillBlock(rebuilt, fewerTxs) == READ_STATUS_INVALID);
+    vector<std::shared_ptr<CBaseTx>> moreTxs = missingTxs;
+    moreTxs.push_back(missingTxs[0]);
+    BOOST_CHECK(partialBlock.FillBlock(rebuilt, moreTxs) == READ_STATUS_INVALID);
+    vector<std::shared_ptr<CBaseTx>> swappedTxs = missingTxs;
+    std::swap(swappedTxs[0], swappedTxs[1]);
+    BOOST_CHECK(partialBlock.FillBlock(rebuilt, swappedTxs) == READ_STATUS_FAILED);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_prefilled_txs)
+{
+    CBlock block = BuildBlock(2);
+    CTxMemPool pool;
+
+    CBlockHeaderAndShortTxIDs outOfRange(block);
+    outOfRange.prefilledTxs[0].index = 3;
+    CPartiallyDownloadedBlock partialBlock;
+    BOOST_CHECK(partialBlock.InitData(outOfRange, pool) == READ_STATUS_INVALID);
+
+    CBlockHeaderAndShortTxIDs duplicated(block);
+    duplicated.prefilledTxs.push_back(duplicated.prefilledTxs[0]);
+    duplicated.shortTxIds.pop_back();
+    CPartiallyDownloadedBlock partialBlock2;
+    BOOST_CHECK(partialBlock2.InitData(duplicated, pool) == READ_STATUS_INVALID);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/util/util.h"
+#include "config/const.h"
+#include "p2p/blockmessagecache.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(blockmessagecache_tests)
+
+static uint256 BlockHash(const uint32_t i) { return uint256S(strprintf("%064x", i + 1)); }
+
+static CSerializeDataPtr NewMessage(const size_t size) { return std::make_shared<CSerializeData>(size, 'b'); }
+
+BOOST_AUTO_TEST_CASE(lru_eviction)
+{
+    CBlockMessageCache cache(100);
+    cache.Put(BlockHash(1), NewMessage(40));
+    cache.Put(BlockHash(2), NewMessage(40));
+
+    // the use of block 1 makes block 2 the least recently used one
+    BOOST_CHECK(cache.Get(BlockHash(1)) != nullptr);
+    cache.Put(BlockHash(3), NewMessage(40));
+    BOOST_CHECK(cache.Get(BlockHash(2)) == nullptr);
+    BOOST_CHECK(cache.Get(BlockHash(1)) != nullptr);
+    BOOST_CHECK(cache.Get(BlockHash(3)) != nullptr);
+
+    // a message larger than the whole cache is not cached and evicts nothing
+    cache.Put(BlockHash(4), NewMessage(101));
+    BOOST_CHECK(cache.Get(BlockHash(4)) == nullptr);
+
+    CBlockMessageCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.count, 2U);
+    BOOST_CHECK_EQUAL(stats.size, 80U);
+    BOOST_CHECK_EQUAL(stats.evictions, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(size_accounting)
+{
+    CBlockMessageCache cache(MAX_BLOCK_MESSAGE_CACHE_SIZE);
+    const uint64_t messageSize = 1024 * 1024;
+    const uint32_t fitCount    = MAX_BLOCK_MESSAGE_CACHE_SIZE / messageSize;
+    BOOST_CHECK_EQUAL(fitCount, 64U);
+
+    // the bytes of a message shared by several blocks are counted for each of them
+    CSerializeDataPtr pMessage = NewMessage(messageSize);
+    for (uint32_t i = 0; i < fitCount; i++)
+        cache.Put(BlockHash(i), pMessage);
+
+    CBlockMessageCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.count, fitCount);
+    BOOST_CHECK_EQUAL(stats.size, MAX_BLOCK_MESSAGE_CACHE_SIZE);
+    BOOST_CHECK_EQUAL(stats.evictions, 0U);
+
+    // a cached block is not counted twice
+    cache.Put(BlockHash(0), NewMessage(10));
+    BOOST_CHECK_EQUAL(cache.GetStats().size, MAX_BLOCK_MESSAGE_CACHE_SIZE);
+    BOOST_CHECK(cache.Get(BlockHash(0)) == pMessage);
+
+    // one more byte evicts the least recently used block, block 0 has just been used
+    cache.Put(BlockHash(fitCount), NewMessage(1));
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.count, fitCount);
+    BOOST_CHECK_EQUAL(stats.size, MAX_BLOCK_MESSAGE_CACHE_SIZE - messageSize + 1);
+    BOOST_CHECK_EQUAL(stats.evictions, 1U);
+    BOOST_CHECK(cache.Get(BlockHash(1)) == nullptr);
+    BOOST_CHECK(cache.Get(BlockHash(0)) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(hit_miss_stats)
+{
+    CBlockMessageCache cache(100);
+    BOOST_CHECK(cache.Get(BlockHash(1)) == nullptr);
+
+    CSerializeDataPtr pMessage = NewMessage(10);
+    cache.Put(BlockHash(1), pMessage);
+    BOOST_CHECK(cache.Get(BlockHash(1)) == pMessage);
+    BOOST_CHECK(cache.Get(BlockHash(1)) == pMessage);
+    BOOST_CHECK(cache.Get(BlockHash(2)) == nullptr);
+
+    CBlockMessageCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.hits, 2U);
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+    BOOST_CHECK_EQUAL(stats.evictions, 0U);
+    BOOST_CHECK_EQUAL(stats.count, 1U);
+    BOOST_CHECK_EQUAL(stats.size, 10U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -181,4 +181,201 @@ BOOST_AUTO_TEST_CASE(dbcache_cache_size_test)
     BOOST_CHECK(!pDBCache2->IsCalcSize() && pDBCache2->GetCacheSize() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(dbcache_copy_on_write_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache1->SetData("regid-1", "keyid-1");
+    pDBCache1->SetData("regid-2", "keyid-2");
+
+    // read falls through without copying into the upper level
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+    auto pDBCache3 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache2.get());
+    string value;
+    BOOST_CHECK(pDBCache3->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(pDBCache3->HaveData(string("regid-2")));
+    BOOST_CHECK(pDBCache2->GetMapData().empty() && pDBCache3->GetMapData().empty());
+
+    // only writes are materialized, the base is untouched until flush
+    pDBCache3->SetData("regid-1", "keyid-1a");
+    pDBCache3->EraseData("regid-2");
+    BOOST_CHECK(pDBCache3->GetMapData().size() == 2);
+    BOOST_CHECK(pDBCache1->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(pDBCache1->HaveData(string("regid-2")));
+    BOOST_CHECK(!pDBCache3->HaveData(string("regid-2")));
+
+    pDBCache3->Flush();
+    pDBCache2->Flush();
+    BOOST_CHECK(pDBCache1->GetData(string("regid-1"), value) && value == "keyid-1a");
+    BOOST_CHECK(!pDBCache1->HaveData(string("regid-2")));
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_read_keys_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache1 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache1->SetData("regid-1", "keyid-1");
+    pDBCache1->SetData("regid-2", "keyid-2");
+
+    // the keys read and written through the upper level are recorded, without values
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache1.get());
+    CDBOpLogMap dbOpLogMap;
+    CDBKeySet readKeys, writtenKeys;
+    dbOpLogMap.SetReadKeys(&readKeys);
+    pDBCache2->SetDbOpLogMap(&dbOpLogMap);
+    string value;
+    BOOST_CHECK(pDBCache2->GetData(string("regid-1"), value));
+    BOOST_CHECK(!pDBCache2->HaveData(string("regid-3")));
+    pDBCache2->SetData("regid-2", "keyid-2a");
+    writtenKeys.AddKeys(dbOpLogMap);
+
+    CDBKeySet expected;
+    expected.AddKey(prefix, string("regid-1"));
+    expected.AddKey(prefix, string("regid-3"));
+    BOOST_CHECK(readKeys.GetMap() == expected.GetMap());
+    expected.Clear();
+    expected.AddKey(prefix, string("regid-2"));
+    BOOST_CHECK(writtenKeys.GetMap() == expected.GetMap());
+
+    // a range read depends on all the keys of the prefix
+    map<string, string> elements;
+    BOOST_CHECK(pDBCache2->GetAllElements(elements));
+    BOOST_CHECK(readKeys.GetMap().at(dbk::GetKeyPrefix(prefix)).count(string()));
+
+    // the dropped keys are read through from base again
+    pDBCache2->DropDataList(writtenKeys.GetMap().at(dbk::GetKeyPrefix(prefix)));
+    BOOST_CHECK(pDBCache2->GetMapData().empty());
+    BOOST_CHECK(pDBCache2->GetData(string("regid-2"), value) && value == "keyid-2");
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_missing_key_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache->SetData("regid-1", "keyid-1");
+    pDBCache->Flush();
+
+    pDBCache->InitBloomFilter();
+    string value;
+    BOOST_CHECK(pDBCache->GetData(string("regid-1"), value) && value == "keyid-1");
+    BOOST_CHECK(!pDBCache->HaveData(string("regid-2")));
+    BOOST_CHECK(!pDBCache->HaveData(string("regid-2")));
+    BOOST_CHECK(pDBCache->GetMapData().count("regid-2") == 0);
+
+    // the missing key written by flush must be found again
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache.get());
+    pDBCache2->SetData("regid-2", "keyid-2");
+    pDBCache2->Flush();
+    pDBCache->Flush();
+    BOOST_CHECK(pDBCache->GetData(string("regid-2"), value) && value == "keyid-2");
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_key_index_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    for (uint32_t i = 1; i <= 5; i++)
+        pDBCache->SetData(strprintf("regid-%u", i), "keyid");
+    pDBCache->Flush();
+    pDBCache->InitKeyIndex();
+
+    // the changes of upper level caches are merged over the index
+    auto pDBCache2 = make_shared< CCompositeKVCache<prefix, string, string> >(pDBCache.get());
+    pDBCache2->EraseData("regid-1");
+    pDBCache2->SetData("regid-0", "keyid");
+    set<string> keys;
+    BOOST_CHECK(pDBCache2->GetTopNElements(3, keys));
+    BOOST_CHECK(keys == set<string>({"regid-0", "regid-2", "regid-3"}));
+
+    // the index follows the flushed changes, the same as walking the db
+    pDBCache2->Flush();
+    pDBCache->Flush();
+    auto pNoIndexCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    set<string> indexKeys, dbKeys;
+    BOOST_CHECK(pDBCache->GetTopNElements(5, indexKeys));
+    BOOST_CHECK(pNoIndexCache->GetTopNElements(5, dbKeys));
+    BOOST_CHECK(indexKeys == dbKeys);
+    BOOST_CHECK(indexKeys.count("regid-0") && !indexKeys.count("regid-1"));
+}
+
+BOOST_AUTO_TEST_CASE(dbcache_pending_batch_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBAccess->BeginBatch();
+    pDBCache->SetData("regid-1", "keyid-1");
+    pDBCache->SetData("regid-2", "keyid-2");
+    pDBCache->Flush();
+    BOOST_CHECK(pDBAccess->HasPendingWrites());
+
+    // not written to db before commit
+    string value1;
+    BOOST_CHECK(!pDBAccess->GetData(prefix, string("regid-1"), value1));
+
+    pDBAccess->CommitBatch(true);
+    BOOST_CHECK(!pDBAccess->HasPendingWrites());
+    BOOST_CHECK(pDBAccess->GetData(prefix, string("regid-1"), value1));
+    BOOST_CHECK( value1 == "keyid-1" );
+}
+
+BOOST_AUTO_TEST_CASE(dbaccess_batch_redo_test)
+{
+    const bool isWipe = true;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ACCOUNT, false, isWipe);
+
+    auto pDBCache = make_shared< CCompositeKVCache<prefix, string, string> >(pDBAccess.get());
+    pDBCache->SetData("regid-1", "keyid-1");
+    pDBCache->SetData("regid-2", "keyid-2");
+    pDBCache->Flush();
+
+    // the redo of a pending batch writes the same puts and deletes again
+    pDBAccess->BeginBatch();
+    BOOST_CHECK(pDBAccess->GetPendingRedo().empty());
+    pDBCache->EraseData("regid-1");
+    pDBCache->SetData("regid-3", "keyid-3");
+    pDBCache->Flush();
+    string redo = pDBAccess->GetPendingRedo();
+    BOOST_CHECK(!redo.empty());
+
+    CLevelDBBatch batch;
+    BOOST_CHECK(batch.LoadRedo(redo));
+    BOOST_CHECK_EQUAL(batch.Count(), 2U);
+    BOOST_CHECK(batch.GetRedo() == redo);
+    pDBAccess->WriteBatch(batch, true);
+
+    string value;
+    BOOST_CHECK(!pDBAccess->GetData(prefix, string("regid-1"), value));
+    BOOST_CHECK(pDBAccess->GetData(prefix, string("regid-3"), value) && value == "keyid-3");
+
+    // written twice, as when a flush interrupted after some of its batches is finished at startup
+    pDBAccess->CommitBatch(true);
+    BOOST_CHECK(!pDBAccess->GetData(prefix, string("regid-1"), value));
+    BOOST_CHECK(pDBAccess->GetData(prefix, string("regid-2"), value) && value == "keyid-2");
+    BOOST_CHECK(pDBAccess->GetData(prefix, string("regid-3"), value) && value == "keyid-3");
+
+    BOOST_CHECK(!batch.LoadRedo(redo.substr(0, redo.size() - 1)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chain/chain.h"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(headerschain_tests)
+
+static vector<CBlock> BuildHeaders(const uint256 &prevHash, const int32_t startHeight, const int32_t count,
+                                   const uint32_t nonce) {
+    vector<CBlock> vHeaders;
+    uint256 hash = prevHash;
+    for (int32_t i = 0; i < count; i++) {
+        CBlock header;
+        header.SetPrevBlockHash(hash);
+        header.SetHeight(startHeight + i);
+        header.SetTime(startHeight + i);
+        header.SetNonce(nonce);
+        hash = header.GetHash();
+        vHeaders.push_back(header);
+    }
+    return vHeaders;
+}
+
+BOOST_AUTO_TEST_CASE(connect_and_prune)
+{
+    // a chain of one genesis block we have
+    uint256 genesisHash = uint256S("0x01");
+    CBlockIndex genesis;
+    genesis.pBlockHash = &genesisHash;
+    map<uint256, CBlockIndex *> mapBlockIndex;
+    mapBlockIndex[genesisHash] = &genesis;
+    CChain chain;
+    chain.SetTip(&genesis);
+
+    CHeadersChain headersChain;
+    vector<CBlock> vHeaders = BuildHeaders(genesisHash, 1, 10, 0);
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vHeaders, vector<bool>(10, false)));
+    BOOST_CHECK_EQUAL(headersChain.Height(), 10);
+    BOOST_CHECK(headersChain[5] == vHeaders[4].GetHash());
+    BOOST_CHECK(!headersChain.IsChecked(vHeaders[0].GetHash()));
+
+    // the same headers again, now checked, and headers extending them
+    vector<bool> vChecked(10, false);
+    vChecked[0] = true;
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vHeaders, vChecked));
+    BOOST_CHECK(headersChain.IsChecked(vHeaders[0].GetHash()));
+    vector<CBlock> vMore = BuildHeaders(vHeaders.back().GetHash(), 11, 5, 0);
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vMore, vector<bool>(5, false)));
+    BOOST_CHECK_EQUAL(headersChain.Height(), 15);
+
+    // headers not linked to anything known
+    BOOST_CHECK(!headersChain.Connect(mapBlockIndex, BuildHeaders(uint256S("0x02"), 1, 3, 0), vector<bool>(3, false)));
+
+    // a lower fork is ignored, so is a higher one that is not checked, a checked higher one replaces the branch
+    vector<CBlock> vFork = BuildHeaders(vHeaders[4].GetHash(), 6, 5, 1);
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vFork, vector<bool>(5, true)));
+    BOOST_CHECK(headersChain[6] == vHeaders[5].GetHash());
+    vFork = BuildHeaders(vHeaders[4].GetHash(), 6, 20, 1);
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vFork, vector<bool>(20, false)));
+    BOOST_CHECK(headersChain[6] == vHeaders[5].GetHash());
+    BOOST_CHECK_EQUAL(headersChain.Height(), 15);
+    vChecked.assign(20, false);
+    vChecked[0] = true;
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, vFork, vChecked));
+    BOOST_CHECK_EQUAL(headersChain.Height(), 25);
+    BOOST_CHECK(headersChain.IsChecked(vFork[0].GetHash()));
+    BOOST_CHECK(!headersChain.IsChecked(vFork[1].GetHash()));
+    BOOST_CHECK(headersChain[6] == vFork[0].GetHash());
+    BOOST_CHECK(!headersChain.Contains(vMore[0].GetHash()));
+    BOOST_CHECK(headersChain.GetLocator(chain).vHave.front() == vFork.back().GetHash());
+
+    // an unchecked branch off a block we have does not replace the current one either
+    BOOST_CHECK(headersChain.Connect(mapBlockIndex, BuildHeaders(genesisHash, 1, 30, 2), vector<bool>(30, false)));
+    BOOST_CHECK(headersChain[6] == vFork[0].GetHash());
+
+    // connected blocks are pruned, a branch off the active chain is dropped
+    headersChain.Prune(chain);
+    BOOST_CHECK_EQUAL(headersChain.Height(), 25);
+    uint256 hash1 = uint256S("0x03");
+    CBlockIndex block1;
+    block1.pBlockHash = &hash1;
+    block1.pprev      = &genesis;
+    block1.height     = 1;
+    chain.SetTip(&block1);
+    headersChain.Prune(chain);
+    BOOST_CHECK_EQUAL(headersChain.Height(), -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/json/json_spirit_writer_template.h"
+#include "commons/json/json_stream_writer.h"
+
+#include <limits>
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+using namespace json_spirit;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(jsonwriter_tests)
+
+static const char *kStrings[] = {"", "plain", "quote\"back\\slash", "ctrl\b\f\n\r\t\x01\x1f", "utf8 \xe4\xb8\xad", "\x7f"};
+
+BOOST_AUTO_TEST_CASE(same_output_as_value_tree)
+{
+    Object obj;
+    Array strs;
+    for (auto str : kStrings)
+        strs.push_back(str);
+    obj.push_back(Pair("strings", strs));
+    obj.push_back(Pair("int", -12345));
+    obj.push_back(Pair("int64_min", std::numeric_limits<int64_t>::min()));
+    obj.push_back(Pair("uint64_max", std::numeric_limits<uint64_t>::max()));
+    obj.push_back(Pair("real", 1.0 / 3));
+    obj.push_back(Pair("real_big", 123456789012.5));
+    obj.push_back(Pair("real_neg", -0.000000001));
+    obj.push_back(Pair("true", true));
+    obj.push_back(Pair("false", false));
+    obj.push_back(Pair("null", Value::null));
+    obj.push_back(Pair("empty_obj", Object()));
+    obj.push_back(Pair("empty_array", Array()));
+    const string expected = write_string(Value(obj), false);
+
+    string out;
+    CJsonWriter writer(out);
+    writer.BeginObject();
+    writer.Key("strings").BeginArray();
+    for (auto str : kStrings)
+        writer.Write(str);
+    writer.EndArray();
+    writer.Pair("int", -12345);
+    writer.Pair("int64_min", std::numeric_limits<int64_t>::min());
+    writer.Pair("uint64_max", std::numeric_limits<uint64_t>::max());
+    writer.Pair("real", 1.0 / 3);
+    writer.Pair("real_big", 123456789012.5);
+    writer.Pair("real_neg", -0.000000001);
+    writer.Pair("true", true);
+    writer.Pair("false", false);
+    writer.Key("null").Null();
+    writer.Key("empty_obj").BeginObject().EndObject();
+    writer.Key("empty_array").BeginArray().EndArray();
+    writer.EndObject();
+
+    BOOST_CHECK_EQUAL(writer.GetDepth(), 0U);
+    BOOST_CHECK_EQUAL(out, expected);
+
+    // an existing value tree is written unchanged
+    string out2;
+    CJsonWriter(out2).Write(Value(obj));
+    BOOST_CHECK_EQUAL(out2, expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
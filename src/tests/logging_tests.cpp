@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/util/util.h"
+#include "logging.h"
+
+#include <future>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(logging_tests)
+
+BOOST_AUTO_TEST_CASE(ring_buffer_wraparound)
+{
+    // the capacity is rounded up to a power of two
+    BCLog::LogRingBuffer queue(3);
+    string line;
+    BOOST_CHECK(!queue.TryPop(line));
+
+    // the slots are reused round after round, in push order, and every round fills the 4 slots
+    uint32_t pushed = 0, popped = 0;
+    BOOST_CHECK(queue.TryPush(strprintf("line %u", pushed++)));
+    for (uint32_t round = 0; round < 10; round++) {
+        for (uint32_t i = 0; i < 3; i++)
+            BOOST_CHECK(queue.TryPush(strprintf("line %u", pushed++)));
+        for (uint32_t i = 0; i < 3; i++) {
+            BOOST_CHECK(queue.TryPop(line));
+            BOOST_CHECK_EQUAL(line, strprintf("line %u", popped++));
+        }
+    }
+    while (queue.TryPop(line))
+        BOOST_CHECK_EQUAL(line, strprintf("line %u", popped++));
+    BOOST_CHECK_EQUAL(popped, pushed);
+}
+
+BOOST_AUTO_TEST_CASE(ring_buffer_full)
+{
+    BCLog::LogRingBuffer queue(4);
+    for (uint32_t i = 0; i < 4; i++)
+        BOOST_CHECK(queue.TryPush(strprintf("line %u", i)));
+
+    // a full queue refuses the line and keeps the queued ones
+    string rejected = "line 4";
+    BOOST_CHECK(!queue.TryPush(std::move(rejected)));
+
+    string line;
+    BOOST_CHECK(queue.TryPop(line));
+    BOOST_CHECK_EQUAL(line, "line 0");
+    BOOST_CHECK(queue.TryPush("line 5"));
+    BOOST_CHECK(!queue.TryPush("line 6"));
+
+    vector<string> lines;
+    while (queue.TryPop(line))
+        lines.push_back(line);
+    BOOST_CHECK(lines == vector<string>({"line 1", "line 2", "line 3", "line 5"}));
+}
+
+BOOST_AUTO_TEST_CASE(category_rate_limit)
+{
+    BCLog::Logger logger;
+    logger.m_rate_limit = 3;
+
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 10; i++)
+        accepted += logger.AcceptLine(BCLog::NET, "net line\n");
+    // the whole burst falls in one second, unless it straddles two
+    BOOST_CHECK(accepted >= 3 && accepted <= 6);
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(BCLog::NET), 10U - accepted);
+
+    // every category has its own limit and counter, errors are never dropped
+    BOOST_CHECK(logger.AcceptLine(BCLog::MINER, "miner line\n"));
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(BCLog::MINER), 0U);
+    for (uint32_t i = 0; i < 10; i++)
+        BOOST_CHECK(logger.AcceptLine(BCLog::ERROR, "error line\n"));
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(BCLog::ERROR), 0U);
+
+    // no limit by default
+    BCLog::Logger unlimited;
+    for (uint32_t i = 0; i < 100; i++)
+        BOOST_CHECK(unlimited.AcceptLine(BCLog::NET, "net line\n"));
+    BOOST_CHECK_EQUAL(unlimited.GetDroppedCount(BCLog::NET), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(queue_full_drop_count)
+{
+    BCLog::Logger logger;
+    logger.m_queue_size     = 2;
+    logger.m_log_timestamps = false;
+
+    // the writer thread blocks on the first line, so the queue fills up behind it
+    promise<void> entered, release;
+    shared_future<void> released = release.get_future().share();
+    vector<string> lines;
+    logger.PushBackCallback([&](const string &line) {
+        if (lines.empty()) {
+            entered.set_value();
+            released.wait();
+        }
+        lines.push_back(line);
+    });
+    BOOST_CHECK(logger.StartLogging());
+
+    logger.LogPrintStr(BCLog::NET, __FILE__, __LINE__, "line 0\n");
+    entered.get_future().wait();
+    for (uint32_t i = 1; i <= 5; i++)
+        logger.LogPrintStr(BCLog::NET, __FILE__, __LINE__, strprintf("line %u\n", i));
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(BCLog::NET), 3U);
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(BCLog::MINER), 0U);
+
+    release.set_value();
+    logger.StopLogging();
+    BOOST_CHECK(lines == vector<string>({"[NET] line 0\n", "[NET] line 1\n", "[NET] line 2\n"}));
+
+    // the lines logged after the stop are written synchronously
+    logger.LogPrintStr(BCLog::NET, __FILE__, __LINE__, "line 6\n");
+    BOOST_CHECK_EQUAL(lines.size(), 4U);
+    BOOST_CHECK_EQUAL(lines.back(), "[NET] line 6\n");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,72 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chain/merkletree.h"
+#include "crypto/sha256.h"
+#include "tx/blockrewardtx.h"
+#include "tx/cointransfertx.h"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(merkle_tests)
+
+static CBlock BuildBlock(const int32_t txCount) {
+    CBlock block;
+    block.vptx.push_back(std::make_shared<CBlockRewardTx>(UnsignedCharArray(), 0, 100));
+    for (int32_t i = 1; i < txCount; i++) {
+        block.vptx.push_back(
+            std::make_shared<CBaseCoinTransferTx>(CRegID(1, i), CRegID(2, i), 100, 10000 + i, 10000, ""));
+    }
+    return block;
+}
+
+// the merkle root hashed one pair at a time
+static uint256 NaiveMerkleRoot(vector<uint256> vLevel) {
+    while (vLevel.size() > 1) {
+        vector<uint256> vNext;
+        for (size_t i = 0; i < vLevel.size(); i += 2) {
+            const uint256 &left = vLevel[i], &right = vLevel[min(i + 1, vLevel.size() - 1)];
+            vNext.push_back(Hash(BEGIN(left), END(left), BEGIN(right), END(right)));
+        }
+        vLevel.swap(vNext);
+    }
+    return vLevel.empty() ? uint256() : vLevel[0];
+}
+
+BOOST_AUTO_TEST_CASE(multi_lane_merkle_root)
+{
+    BOOST_TEST_MESSAGE("SHA256 implementation: " << SHA256AutoDetect());
+
+    for (int32_t txCount = 1; txCount <= 40; txCount++) {
+        CBlock block = BuildBlock(txCount);
+        vector<uint256> vTxid;
+        for (const auto &ptx : block.vptx)
+            vTxid.push_back(ptx->GetHash());
+
+        uint256 root = block.BuildMerkleTree();
+        BOOST_CHECK(root == NaiveMerkleRoot(vTxid));
+
+        // the branch of every tx leads to the same root
+        for (int32_t i = 0; i < txCount; i++)
+            BOOST_CHECK(CBlock::CheckMerkleBranch(vTxid[i], block.GetMerkleBranch(i), i) == root);
+
+        // a partial tree of every third tx keeps the root and the matched txids
+        vector<bool> vMatch;
+        vector<uint256> vExpected;
+        for (int32_t i = 0; i < txCount; i++) {
+            vMatch.push_back(i % 3 == 1);
+            if (vMatch.back())
+                vExpected.push_back(vTxid[i]);
+        }
+        CPartialMerkleTree partialTree(vTxid, vMatch);
+        vector<uint256> vMatched;
+        BOOST_CHECK(partialTree.ExtractMatches(vMatched) == root);
+        BOOST_CHECK(vMatched == vExpected);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "persistence/pricefeeddb.h"
+#include "config/scoin.h"
+#include "commons/util/util.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(pricefeed_tests)
+
+static const CoinPricePair kPair(SYMB::WICC, SYMB::USD);
+
+// the prices of every block as seen by the top cache, the reference for the median window
+typedef map<int32_t, map<CRegID, uint64_t>> RefPriceMap;
+
+static uint64_t RefMedianPrice(const RefPriceMap &prices, const int32_t blockHeight, const uint64_t slideWindow) {
+    vector<uint64_t> numbers;
+    int32_t beginBlockHeight = std::max<int32_t>((blockHeight - slideWindow), 0);
+    for (int32_t height = blockHeight; height > beginBlockHeight; --height) {
+        auto iter = prices.find(height);
+        if (iter != prices.end()) {
+            for (const auto &userPrice : iter->second)
+                numbers.push_back(userPrice.second);
+        }
+    }
+
+    size_t size = numbers.size();
+    if (size < 2)
+        return size == 0 ? 0 : numbers[0];
+    sort(numbers.begin(), numbers.end());
+    return (size % 2 == 0) ? (numbers[size / 2 - 1] + numbers[size / 2]) / 2 : numbers[size / 2];
+}
+
+static void AddBlockPrices(CPricePointMemCache &cache, RefPriceMap &ref, const int32_t height, const int32_t feeders) {
+    for (int32_t i = 0; i < feeders; i++) {
+        CRegID regId(1, i);
+        uint64_t price = 10000 + GetRandInt(2000);
+        BOOST_CHECK(cache.AddPrice(height, regId, {CPricePoint(kPair, price)}));
+        ref[height][regId] = price;
+    }
+}
+
+static void DeleteBlockPrices(CPricePointMemCache &cache, RefPriceMap &ref, const int32_t height) {
+    CBlock block;
+    block.SetHeight(height);
+    BOOST_CHECK(cache.DeleteBlockFromCache(block));
+    ref.erase(height);
+}
+
+BOOST_AUTO_TEST_CASE(median_window)
+{
+    CMedianPriceWindow window;
+    vector<uint64_t> numbers;
+    for (int32_t i = 0; i < 200; i++) {
+        uint64_t price = GetRandInt(50);
+        if (!numbers.empty() && GetRandInt(3) == 0) {
+            auto it = numbers.begin() + GetRandInt(numbers.size());
+            BOOST_CHECK(window.Remove(*it));
+            numbers.erase(it);
+        } else {
+            window.Add(price);
+            numbers.push_back(price);
+        }
+
+        vector<uint64_t> sorted = numbers;
+        sort(sorted.begin(), sorted.end());
+        size_t size = sorted.size();
+        uint64_t expected = size == 0 ? 0 : (size % 2 ? sorted[size / 2] : (sorted[size / 2 - 1] + sorted[size / 2]) / 2);
+        BOOST_CHECK_EQUAL(window.GetMedian(), expected);
+        BOOST_CHECK_EQUAL(window.GetSize(), size);
+    }
+    BOOST_CHECK(!window.Remove(1000));
+}
+
+BOOST_AUTO_TEST_CASE(layered_caches)
+{
+    const uint64_t slideWindow = 11;
+    CPricePointMemCache base;
+    RefPriceMap ref;
+
+    for (int32_t height = 1; height <= 100; height++) {
+        AddBlockPrices(base, ref, height, 1 + GetRandInt(11));
+        if (height > 11)
+            DeleteBlockPrices(base, ref, height - 11);
+        BOOST_CHECK_EQUAL(base.ComputeBlockMedianPrice(height, slideWindow, kPair), RefMedianPrice(ref, height, slideWindow));
+
+        // a block connected in a child cache, like ConnectBlock or the miner does
+        CPricePointMemCache child(&base);
+        RefPriceMap childRef = ref;
+        AddBlockPrices(child, childRef, height + 1, 11);
+        BOOST_CHECK_EQUAL(child.ComputeBlockMedianPrice(height + 1, slideWindow, kPair),
+                          RefMedianPrice(childRef, height + 1, slideWindow));
+
+        // the base view changes after the child window was built
+        if (height % 10 == 0) {
+            DeleteBlockPrices(base, ref, height);
+            DeleteBlockPrices(child, childRef, height - 1);
+            childRef.erase(height);
+            BOOST_CHECK_EQUAL(child.ComputeBlockMedianPrice(height + 1, slideWindow, kPair),
+                              RefMedianPrice(childRef, height + 1, slideWindow));
+            AddBlockPrices(base, ref, height, 5);
+        }
+    }
+
+    // jump back, as a reorg does
+    BOOST_CHECK_EQUAL(base.ComputeBlockMedianPrice(95, slideWindow, kPair), RefMedianPrice(ref, 95, slideWindow));
+    BOOST_CHECK_EQUAL(base.ComputeBlockMedianPrice(100, 5, kPair), RefMedianPrice(ref, 100, 5));
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_round_trip)
+{
+    const uint64_t slideWindow = 11;
+    CPricePointMemCache base;
+    RefPriceMap ref;
+    for (int32_t height = 1; height <= 20; height++) {
+        AddBlockPrices(base, ref, height, 1 + GetRandInt(11));
+        if (height > 11)
+            DeleteBlockPrices(base, ref, height - 11);
+    }
+    BOOST_CHECK_EQUAL(base.ComputeBlockMedianPrice(20, slideWindow, kPair), RefMedianPrice(ref, 20, slideWindow));
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << base;
+    CPricePointMemCache loaded;
+    ss >> loaded;
+    BOOST_CHECK_EQUAL(loaded.ComputeBlockMedianPrice(20, slideWindow, kPair), RefMedianPrice(ref, 20, slideWindow));
+
+    // the loaded window is rebuilt over a cache that kept working
+    AddBlockPrices(loaded, ref, 21, 5);
+    DeleteBlockPrices(loaded, ref, 10);
+    BOOST_CHECK_EQUAL(loaded.ComputeBlockMedianPrice(21, slideWindow, kPair), RefMedianPrice(ref, 21, slideWindow));
+}
+
+// compares the incremental window with sorting the prices of the whole window on every block
+BOOST_AUTO_TEST_CASE(median_window_bench)
+{
+    const uint64_t slideWindow = 11;
+    const int32_t feeders      = 21;
+    const int32_t blocks       = 2000;
+
+    CPricePointMemCache base;
+    RefPriceMap ref;
+    int64_t windowTime = 0, sortTime = 0;
+    for (int32_t height = 1; height <= blocks; height++) {
+        AddBlockPrices(base, ref, height, feeders);
+        if (height > (int32_t)slideWindow)
+            DeleteBlockPrices(base, ref, height - slideWindow);
+
+        int64_t start   = GetTimeMicros();
+        uint64_t median = base.ComputeBlockMedianPrice(height, slideWindow, kPair);
+        windowTime += GetTimeMicros() - start;
+
+        start = GetTimeMicros();
+        uint64_t expected = RefMedianPrice(ref, height, slideWindow);
+        sortTime += GetTimeMicros() - start;
+
+        BOOST_CHECK_EQUAL(median, expected);
+    }
+
+    BOOST_TEST_MESSAGE(strprintf("median of %d feeders in %d blocks: window %.3fus, sort %.3fus per block", feeders,
+                                 slideWindow, (double)windowTime / blocks, (double)sortTime / blocks));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,12 +9,16 @@
 #include "persistence/txdb.h"
 #include "tx/tx.h"
 #include "miner/miner.h"
+#include "persistence/blockundo.h"
+
+#include <deque>
 
 using namespace std;
 
 CTxMemPoolEntry::CTxMemPoolEntry() {
     nTxSize   = 0;
     dPriority = 0.0;
+    dFeePerKb = 0.0;
 
     nTime   = 0;
     height = 0;
@@ -25,6 +29,8 @@ CTxMemPoolEntry::CTxMemPoolEntry(CBaseTx *pBaseTx, int64_t time, uint32_t height
     nFees     = pTx->GetFees();
     nTxSize   = ::GetSerializeSize(*pTx, SER_NETWORK, PROTOCOL_VERSION);
     dPriority = pTx->GetPriority();
+    dFeePerKb = 0.0;
+    txid      = pTx->GetHash();
 }
 
 CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry &other) {
@@ -32,39 +38,60 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry &other) {
     this->nFees     = other.nFees;
     this->nTxSize   = other.nTxSize;
     this->dPriority = other.dPriority;
+    this->dFeePerKb = other.dFeePerKb;
+    this->txid      = other.txid;
+    this->readKeys    = other.readKeys;
+    this->writtenKeys = other.writtenKeys;
 
     this->nTime  = other.nTime;
     this->height = other.height;
 }
 
+int32_t CTxMemPoolEntry::GetValidHeight() const { return pTx->valid_height; }
+
+void CTxMemPoolEntry::UpdateFeePerKb(int32_t height, uint32_t fuelRate) {
+    dFeePerKb = double(std::get<1>(nFees) - pTx->GetFuel(height, fuelRate)) / nTxSize * 1000.0;
+}
+
 CTxMemPool::CTxMemPool() {
     // Sanity checks off by default for performance, because otherwise
     // accepting transactions becomes O(N^2) where N is the number
     // of transactions in the pool
     fSanityCheck         = false;
+    fFullRescan          = true;
 }
 
 void CTxMemPool::Remove(CBaseTx *pBaseTx, list<std::shared_ptr<CBaseTx> > &removed, bool fRecursive) {
     // Remove transaction from memory pool
     LOCK(cs);
     uint256 txid = pBaseTx->GetHash();
-    if (memPoolTxs.count(txid)) {
-        removed.push_front(std::shared_ptr<CBaseTx>(memPoolTxs[txid].GetTransaction()));
-        memPoolTxs.erase(txid);
+    auto it = memPoolTxs.find(txid);
+    if (it != memPoolTxs.end()) {
+        RemoveKeys(*it);
+        removed.push_front(it->GetTransaction());
+        memPoolTxs.erase(it);
         EraseTransaction(txid);
     }
 }
 
-bool CTxMemPool::AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state) {
+bool CTxMemPool::AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state,
+                              CCacheWrapper *pBatchCw) {
     // Add to memory pool without checking anything.
     // Used by main.cpp AcceptToMemoryPool(), which DOES
     // all the appropriate checks.
     LOCK(cs);
     {
-        if (!CheckTxInMemPool(txid, entry, state))
+        CDBKeySet readKeys, writtenKeys;
+        if (!CheckTxInMemPool(txid, entry, state, true, &readKeys, &writtenKeys, pBatchCw))
             return false;
 
-        memPoolTxs.insert(make_pair(txid, entry));
+        // the ordered view for block packing is maintained on insert, so the miner need not sort the whole pool
+        CTxMemPoolEntry newEntry(entry);
+        newEntry.SetDbKeys(std::move(readKeys), std::move(writtenKeys));
+        CBlockIndex *pTip = chainActive.Tip();
+        newEntry.UpdateFeePerKb(pTip->height + 1, GetElementForBurn(pTip));
+        IndexKeys(newEntry);
+        memPoolTxs.insert(std::move(newEntry));
     }
     return true;
 }
@@ -74,25 +101,33 @@ void CTxMemPool::QueryHash(vector<uint256> &txids) {
 
     txids.clear();
     txids.reserve(memPoolTxs.size());
-    for (typename map<uint256, CTxMemPoolEntry>::iterator mi = memPoolTxs.begin(); mi != memPoolTxs.end(); ++mi) {
-        txids.push_back((*mi).first);
+    for (const auto &entry : memPoolTxs) {
+        txids.push_back(entry.GetHash());
     }
 }
 
 bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &memPoolEntry, CValidationState &state,
-                                  bool bExecute) {
+                                  bool bExecute, CDBKeySet *pReadKeys, CDBKeySet *pWrittenKeys,
+                                  CCacheWrapper *pBatchCw) {
     // is it within valid height
     static int validHeight = SysCfg().GetTxCacheHeight();
     if (!memPoolEntry.GetTransaction()->IsValidHeight(chainActive.Height(), validHeight))
         return state.Invalid(ERRORMSG("CheckTxInMemPool() : txid: %s beyond the scope of valid height", txid.GetHex()),
                              REJECT_INVALID, "tx-invalid-height");
 
+    CCacheWrapper *pBaseCw = pBatchCw != nullptr ? pBatchCw : cw.get();
+
     // is it already confirmed in block
-    if (cw->txCache.HaveTx(txid))
+    if (pBaseCw->txCache.HaveTx(txid))
         return state.Invalid(ERRORMSG("CheckTxInMemPool() : txid: %s has been confirmed", txid.GetHex()), REJECT_INVALID,
                              "tx-duplicate-confirmed");
 
-    auto spCW = std::make_shared<CCacheWrapper>(cw.get());
+    auto spCW = std::make_shared<CCacheWrapper>(pBaseCw);
+    // record the keys read and written by the tx as its dependencies
+    CDBOpLogMap dbOpLogMap;
+    dbOpLogMap.SetReadKeys(pReadKeys);
+    if (pReadKeys != nullptr || pWrittenKeys != nullptr)
+        spCW->SetDbOpLogMap(&dbOpLogMap);
 
     if (bExecute) {
         CBlockIndex *pTip =  chainActive.Tip();
@@ -108,6 +143,8 @@ bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &me
     }
 
     spCW->Flush();
+    if (pWrittenKeys != nullptr)
+        pWrittenKeys->AddKeys(dbOpLogMap);
 
     return true;
 }
@@ -116,27 +153,201 @@ void CTxMemPool::SetMemPoolCache() {
     cw.reset(new CCacheWrapper(pCdMan));
 }
 
-void CTxMemPool::ReScanMemPoolTx() {
-    cw.reset(new CCacheWrapper(pCdMan));
+void CTxMemPool::IndexKeys(const CTxMemPoolEntry &entry) {
+    for (const CDBKeySet *pKeySet : {&entry.GetReadKeys(), &entry.GetWrittenKeys()}) {
+        for (const auto &keysPair : pKeySet->GetMap()) {
+            auto &prefixKeyTxids = keyTxids[keysPair.first];
+            for (const auto &key : keysPair.second)
+                prefixKeyTxids[key].insert(entry.GetHash());
+        }
+    }
+    if (entry.GetTransaction()->IsPriceFeedTx())
+        priceFeedTxids.insert(entry.GetHash());
+}
+
+void CTxMemPool::UnindexKeys(const CTxMemPoolEntry &entry) {
+    for (const CDBKeySet *pKeySet : {&entry.GetReadKeys(), &entry.GetWrittenKeys()}) {
+        for (const auto &keysPair : pKeySet->GetMap()) {
+            auto itPrefix = keyTxids.find(keysPair.first);
+            if (itPrefix == keyTxids.end())
+                continue;
+            for (const auto &key : keysPair.second) {
+                auto it = itPrefix->second.find(key);
+                if (it == itPrefix->second.end())
+                    continue;
+                it->second.erase(entry.GetHash());
+                if (it->second.empty())
+                    itPrefix->second.erase(it);
+            }
+            if (itPrefix->second.empty())
+                keyTxids.erase(itPrefix);
+        }
+    }
+    priceFeedTxids.erase(entry.GetHash());
+}
+
+void CTxMemPool::RemoveKeys(const CTxMemPoolEntry &entry) {
+    UnindexKeys(entry);
+    modifiedKeys.AddKeys(entry.GetWrittenKeys());
+}
 
+void CTxMemPool::RemoveForBlock(const CBlock &block, const CBlockUndo &blockUndo) {
     LOCK(cs);
+    for (const auto &pTx : block.vptx) {
+        auto it = memPoolTxs.find(pTx->GetHash());
+        if (it != memPoolTxs.end()) {
+            RemoveKeys(*it);
+            memPoolTxs.erase(it);
+        }
+    }
+
+    for (const auto &txUndo : blockUndo.vtxundo)
+        modifiedKeys.AddKeys(txUndo.dbOpLogMap);
+}
+
+void CTxMemPool::FullReScan() {
+    cw.reset(new CCacheWrapper(pCdMan));
+    keyTxids.clear();
+    priceFeedTxids.clear();
+
     CValidationState state;
-    for (map<uint256, CTxMemPoolEntry>::iterator iterTx = memPoolTxs.begin(); iterTx != memPoolTxs.end();) {
-        if (!CheckTxInMemPool(iterTx->first, iterTx->second, state, true)) {
-            uint256 txid = iterTx->first;
-            iterTx       = memPoolTxs.erase(iterTx++);
+    for (auto iterTx = memPoolTxs.begin(); iterTx != memPoolTxs.end();) {
+        CDBKeySet readKeys, writtenKeys;
+        if (!CheckTxInMemPool(iterTx->GetHash(), *iterTx, state, true, &readKeys, &writtenKeys)) {
+            uint256 txid = iterTx->GetHash();
+            iterTx       = memPoolTxs.erase(iterTx);
             EraseTransaction(txid);
             continue;
         }
+        memPoolTxs.modify(iterTx, [&](CTxMemPoolEntry &entry) {
+            entry.SetDbKeys(std::move(readKeys), std::move(writtenKeys));
+        });
+        IndexKeys(*iterTx);
         ++iterTx;
     }
 }
 
+bool CTxMemPool::IncrementalReScan(uint32_t &executedCount) {
+    // Find the txs that read or wrote the modified keys, and the txs depending on the keys written by them
+    // transitively, as the writes of all of them will be dropped from mempool cache.
+    set<uint256> affectedTxids;
+    set<pair<string, string>> visitedKeys;
+    std::deque<pair<string, string>> pendingKeys;
+    auto addPendingKeys = [&](const CDBKeySet &keySet) {
+        for (const auto &keysPair : keySet.GetMap()) {
+            for (const auto &key : keysPair.second)
+                pendingKeys.emplace_back(keysPair.first, key);
+        }
+    };
+    auto addAffectedTxids = [&](const set<uint256> &txids) {
+        for (const auto &txid : txids) {
+            if (affectedTxids.insert(txid).second)
+                addPendingKeys(memPoolTxs.find(txid)->GetWrittenKeys());
+        }
+    };
+
+    addPendingKeys(modifiedKeys);
+    addAffectedTxids(priceFeedTxids);
+    while (!pendingKeys.empty()) {
+        auto prefixKey = std::move(pendingKeys.front());
+        pendingKeys.pop_front();
+        if (!visitedKeys.insert(prefixKey).second)
+            continue;
+
+        auto itPrefix = keyTxids.find(prefixKey.first);
+        if (itPrefix == keyTxids.end())
+            continue;
+        if (prefixKey.second.empty()) {
+            // all the keys of the prefix may be modified
+            for (const auto &keyTxidsPair : itPrefix->second)
+                addAffectedTxids(keyTxidsPair.second);
+            continue;
+        }
+        // the txs that read or wrote the key, and the ones that read all the keys of the prefix
+        for (const string &key : {prefixKey.second, string()}) {
+            auto it = itPrefix->second.find(key);
+            if (it != itPrefix->second.end())
+                addAffectedTxids(it->second);
+        }
+    }
+
+    // Drop the stale data from mempool cache, then re-execute the affected txs on top of it.
+    if (!cw->DropData(modifiedKeys))
+        return false;
+    for (const auto &txid : affectedTxids) {
+        const CTxMemPoolEntry &entry = *memPoolTxs.find(txid);
+        if (!cw->DropData(entry.GetWrittenKeys()))
+            return false;
+    }
+    cw->ppCache = CPricePointMemCache(pCdMan->pPpCache);
+
+    CValidationState state;
+    for (const auto &txid : affectedTxids) {
+        auto iterTx = memPoolTxs.find(txid);
+        UnindexKeys(*iterTx);
+        CDBKeySet readKeys, writtenKeys;
+        if (!CheckTxInMemPool(txid, *iterTx, state, true, &readKeys, &writtenKeys)) {
+            memPoolTxs.erase(iterTx);
+            EraseTransaction(txid);
+            continue;
+        }
+        memPoolTxs.modify(iterTx, [&](CTxMemPoolEntry &entry) {
+            entry.SetDbKeys(std::move(readKeys), std::move(writtenKeys));
+        });
+        IndexKeys(*iterTx);
+    }
+    executedCount = affectedTxids.size();
+    return true;
+}
+
+void CTxMemPool::ReScanMemPoolTx() {
+    LOCK(cs);
+    int64_t nStart = GetTimeMicros();
+
+    RemoveExpired(chainActive.Height());
+
+    uint32_t executedCount = 0;
+    bool fFull = fFullRescan || !cw;
+    if (!fFull && !IncrementalReScan(executedCount)) {
+        LogPrint(BCLog::ERROR, "%s(), drop the modified keys from mempool cache failed, rescan all the txs\n",
+                 __FUNCTION__);
+        fFull = true;
+    }
+    if (fFull) {
+        FullReScan();
+        executedCount = memPoolTxs.size();
+    }
+    fFullRescan = false;
+    modifiedKeys.Clear();
+
+    if (SysCfg().IsBenchmark())
+        LogPrint(BCLog::INFO, "- Rescan mempool: %u txs, %u re-executed%s, %.2fms\n", memPoolTxs.size(),
+                 executedCount, fFull ? " (full)" : "", (GetTimeMicros() - nStart) * 0.001);
+}
+
+void CTxMemPool::RemoveExpired(int32_t height) {
+    LOCK(cs);
+    static int32_t txCacheHeight = SysCfg().GetTxCacheHeight();
+
+    auto &heightIndex = memPoolTxs.get<valid_height_index>();
+    auto itEnd        = heightIndex.lower_bound(height - txCacheHeight / 2);
+    for (auto it = heightIndex.begin(); it != itEnd;) {
+        uint256 txid = it->GetHash();
+        RemoveKeys(*it);
+        it           = heightIndex.erase(it);
+        EraseTransaction(txid);
+    }
+}
+
 void CTxMemPool::Clear() {
     LOCK(cs);
 
     memPoolTxs.clear();
     cw.reset(new CCacheWrapper(pCdMan));
+    modifiedKeys.Clear();
+    keyTxids.clear();
+    priceFeedTxids.clear();
+    fFullRescan = false;
 }
 
 uint64_t CTxMemPool::Size() {
@@ -151,8 +362,8 @@ bool CTxMemPool::Exists(const uint256 txid) {
 
 std::shared_ptr<CBaseTx> CTxMemPool::Lookup(const uint256 txid) const {
     LOCK(cs);
-    typename map<uint256, CTxMemPoolEntry>::const_iterator i = memPoolTxs.find(txid);
-    if (i == memPoolTxs.end())
+    auto it = memPoolTxs.find(txid);
+    if (it == memPoolTxs.end())
         return std::shared_ptr<CBaseTx>();
-    return i->second.GetTransaction();
+    return it->GetTransaction();
 }
\ No newline at end of file
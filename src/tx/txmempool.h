@@ -7,6 +7,7 @@
 #ifndef COIN_TXMEMPOOL_H
 #define COIN_TXMEMPOOL_H
 
+#include "config/scoin.h"
 #include "entities/account.h"
 #include "persistence/cachewrapper.h"
 #include "sync.h"
@@ -14,11 +15,20 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
+
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/identity.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
 
 using namespace std;
 
 class CValidationState;
 class CBaseTx;
+class CBlock;
+class CBlockUndo;
 class uint256;
 
 /*
@@ -30,6 +40,10 @@ private:
     std::pair<TokenSymbol, uint64_t> nFees;  // Cached to avoid expensive parent-transaction lookups
     uint32_t nTxSize;                     // Cached to avoid recomputing tx size
     double dPriority;                     // Cached to avoid recomputing priority
+    double dFeePerKb;                     // Fees exclude fuel per KB, cached for the priority index
+    uint256 txid;                         // Cached to avoid rehashing the tx in the indexes
+    CDBKeySet readKeys;                   // Keys read by executing the tx in mempool, the data it depends on
+    CDBKeySet writtenKeys;                // Keys written by executing the tx in mempool
 
     int64_t nTime;     // Local time when entering the mempool
     uint32_t height;  // Chain height when entering the mempool
@@ -38,17 +52,80 @@ public:
     CTxMemPoolEntry(CBaseTx *ptx, int64_t time, uint32_t height);
     CTxMemPoolEntry();
     CTxMemPoolEntry(const CTxMemPoolEntry &other);
+    CTxMemPoolEntry(CTxMemPoolEntry &&other) = default;
 
     std::shared_ptr<CBaseTx> GetTransaction() const { return pTx; }
 
     inline std::pair<TokenSymbol, uint64_t> GetFees() const { return nFees; }
     inline uint32_t GetTxSize() const { return nTxSize; }
     inline double GetPriority() const { return dPriority; }
+    inline double GetFeePerKb() const { return dFeePerKb; }
+    inline const uint256& GetHash() const { return txid; }
+    int32_t GetValidHeight() const;
+
+    // fuel is known after the tx has been executed, call it before adding the entry to mempool
+    void UpdateFeePerKb(int32_t height, uint32_t fuelRate);
+
+    inline const CDBKeySet& GetReadKeys() const { return readKeys; }
+    inline const CDBKeySet& GetWrittenKeys() const { return writtenKeys; }
+    inline void SetDbKeys(CDBKeySet &&readKeysIn, CDBKeySet &&writtenKeysIn) {
+        readKeys    = std::move(readKeysIn);
+        writtenKeys = std::move(writtenKeysIn);
+    }
 
     inline int64_t GetTime() const { return nTime; }
     inline uint32_t GetHeight() const { return height; }
 };
 
+/**
+ * Strict weak ordering of the packing priority: the priority class first (price feed, price
+ * median and all the normal txs), then fees per KB, then txid.
+ */
+inline bool ComparePackPriority(double priorityA, double feePerKbA, const uint256 &txidA,
+                                double priorityB, double feePerKbB, const uint256 &txidB) {
+    int64_t classA = priorityA / TRANSACTION_PRIORITY_CEILING;
+    int64_t classB = priorityB / TRANSACTION_PRIORITY_CEILING;
+    if (classA != classB)
+        return classA < classB;
+    if (feePerKbA != feePerKbB)
+        return feePerKbA < feePerKbB;
+    return txidA < txidB;
+}
+
+struct CompareTxMemPoolEntryByPriority {
+    bool operator()(const CTxMemPoolEntry &a, const CTxMemPoolEntry &b) const {
+        return ComparePackPriority(a.GetPriority(), a.GetFeePerKb(), a.GetHash(),
+                                   b.GetPriority(), b.GetFeePerKb(), b.GetHash());
+    }
+};
+
+// tags of the mempool indexes
+struct txid_index {};
+struct priority_index {};
+struct valid_height_index {};
+
+typedef boost::multi_index_container<
+    CTxMemPoolEntry,
+    boost::multi_index::indexed_by<
+        // sorted by txid
+        boost::multi_index::ordered_unique<
+            boost::multi_index::tag<txid_index>,
+            boost::multi_index::const_mem_fun<CTxMemPoolEntry, const uint256&, &CTxMemPoolEntry::GetHash>
+        >,
+        // sorted by packing priority, the highest at the end
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<priority_index>,
+            boost::multi_index::identity<CTxMemPoolEntry>,
+            CompareTxMemPoolEntryByPriority
+        >,
+        // sorted by valid height of tx for expiry
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<valid_height_index>,
+            boost::multi_index::const_mem_fun<CTxMemPoolEntry, int32_t, &CTxMemPoolEntry::GetValidHeight>
+        >
+    >
+> indexed_transaction_set;
+
 /*
  * CTxMemPool stores valid-according-to-the-current-best-chain
  * transactions that may be included in the next block.
@@ -62,7 +139,7 @@ public:
 class CTxMemPool {
 public:
     mutable CCriticalSection cs;
-    map<uint256, CTxMemPoolEntry > memPoolTxs;
+    indexed_transaction_set memPoolTxs;
     std::shared_ptr<CCacheWrapper> cw;
 
 public:
@@ -70,21 +147,45 @@ public:
 
 public:
     void SetSanityCheck(bool fSanityCheckIn) { fSanityCheck = fSanityCheckIn; }
-    bool AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state);
+    // pBatchCw: the cache layer of a tx batch to execute the tx on instead of cw, flushed by the caller
+    bool AddUnchecked(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state,
+                      CCacheWrapper *pBatchCw = nullptr);
     void Remove(CBaseTx *pBaseTx, list<std::shared_ptr<CBaseTx> > &removed, bool fRecursive = false);
     void QueryHash(vector<uint256> &txids);
     bool CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &entry, CValidationState &state,
-                          bool bExecute = true);
+                          bool bExecute = true, CDBKeySet *pReadKeys = nullptr, CDBKeySet *pWrittenKeys = nullptr,
+                          CCacheWrapper *pBatchCw = nullptr);
     void SetMemPoolCache();
+    // Revalidate the txs after the tip changed. Only the txs that read or wrote the keys modified since
+    // last rescan are re-executed, unless a full rescan is required.
     void ReScanMemPoolTx();
+    // remove the txs confirmed by the connected block, and mark the keys modified by the block
+    void RemoveForBlock(const CBlock &block, const CBlockUndo &blockUndo);
+    // the state of mempool cache can not be revalidated incrementally, e.g. the tip was disconnected
+    void SetFullRescan() { fFullRescan = true; }
+    // remove the txs whose valid height is out of the tx cache scope of height
+    void RemoveExpired(int32_t height);
     void Clear();
 
     uint64_t Size();
     bool Exists(const uint256 txid);
     std::shared_ptr<CBaseTx> Lookup(const uint256 txid) const;
 
+private:
+    void FullReScan();
+    // returns false if the mempool cache could not be revalidated incrementally
+    bool IncrementalReScan(uint32_t &executedCount);
+    void IndexKeys(const CTxMemPoolEntry &entry);
+    void UnindexKeys(const CTxMemPoolEntry &entry);
+    // unindex the keys of a tx leaving the pool, its writes are still in mempool cache
+    void RemoveKeys(const CTxMemPoolEntry &entry);
+
 private:
     bool fSanityCheck; // Normally false, true if -checkmempool or -regtest
+    bool fFullRescan;  // the mempool cache must be rebuilt by re-executing all the txs
+    CDBKeySet modifiedKeys; // the keys modified in base cache or by removed txs since last rescan
+    map<string, map<string, set<uint256>>> keyTxids; // prefix -> key -> the txids that read or wrote it
+    set<uint256> priceFeedTxids; // the price points of mempool cache are kept by block height, not by keys
 };
 
 
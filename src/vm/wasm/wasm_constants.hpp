@@ -21,6 +21,7 @@ namespace wasm {
     const static uint32_t max_wasm_api_data_bytes      = 64*1024;
     const static uint16_t max_inline_transactions_size = 1024;
     const static uint16_t max_signatures_size          = 16;
+    const static uint64_t default_wasm_code_cache_size = 256*1024*1024;//bytes
 
     const static uint64_t wasmio       = N(wasmio);
     const static uint64_t wasmio_bank  = N(wasmio.bank);
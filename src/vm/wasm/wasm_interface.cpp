@@ -15,6 +15,9 @@
 #include "wasm/exception/exceptions.hpp"
 
 #include "crypto/hash.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include <openssl/ripemd.h>
 #include <openssl/sha.h>
 
@@ -37,9 +40,92 @@ namespace wasm {
     using backend_validate_t = backend<wasm::wasm_context_interface, vm::interpreter>;
     using rhf_t              = eosio::vm::registered_host_functions<wasm_context_interface>;
 
-    std::optional<std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>>& get_wasm_instantiation_cache(){
-        static std::optional<std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>> wasm_instantiation_cache;
-        return wasm_instantiation_cache;
+    class wasm_code_cache {
+    public:
+        wasm_code_cache() { stats.max_memory_size = default_wasm_code_cache_size; }
+
+        std::shared_ptr<wasm_instantiated_module_interface> get(const code_version_t &code_id) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = index.find(code_id);
+            if (it == index.end()) {
+                stats.misses++;
+                return nullptr;
+            }
+            stats.hits++;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->module;
+        }
+
+        std::shared_ptr<wasm_instantiated_module_interface> put(const code_version_t &code_id, const vector<uint8_t> &code,
+                                                                std::shared_ptr<wasm_instantiated_module_interface> module) {
+            std::lock_guard<std::mutex> lock(mtx);
+            // instantiated concurrently by another caller
+            auto it = index.find(code_id);
+            if (it != index.end())
+                return it->second->module;
+
+            uint64_t memory_size = module->memory_size() + code.size();
+            entries.push_front({code_id, code, module, memory_size});
+            index[code_id] = entries.begin();
+            stats.memory_size += memory_size;
+            evict();
+            return module;
+        }
+
+        void set_max_memory_size(uint64_t max_memory_size) {
+            std::lock_guard<std::mutex> lock(mtx);
+            stats.max_memory_size = max_memory_size;
+            evict();
+        }
+
+        wasm_code_cache_stats get_stats() {
+            std::lock_guard<std::mutex> lock(mtx);
+            stats.count = entries.size();
+            return stats;
+        }
+
+        std::vector<std::vector<uint8_t>> get_codes() {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::vector<std::vector<uint8_t>> codes;
+            for (const auto &entry : entries)
+                codes.push_back(entry.code);
+            return codes;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mtx);
+            entries.clear();
+            index.clear();
+            stats.memory_size = 0;
+        }
+
+    private:
+        struct cache_entry {
+            code_version_t                                      code_id;
+            vector<uint8_t>                                     code;
+            std::shared_ptr<wasm_instantiated_module_interface> module;
+            uint64_t                                            memory_size;
+        };
+
+        // keep at least the most recently used module, a module being executed is held by its caller
+        void evict() {
+            while (entries.size() > 1 && stats.memory_size > stats.max_memory_size) {
+                stats.memory_size -= entries.back().memory_size;
+                stats.evictions++;
+                index.erase(entries.back().code_id);
+                entries.pop_back();
+            }
+        }
+
+        std::mutex                                                             mtx;
+        std::list<cache_entry>                                                 entries;
+        std::unordered_map<code_version_t, std::list<cache_entry>::iterator, CUint256Hasher> index;
+        wasm_code_cache_stats                                                  stats;
+    };
+
+    wasm_code_cache& get_wasm_code_cache(){
+        static wasm_code_cache code_cache;
+        return code_cache;
     }
 
     std::shared_ptr <wasm_runtime_interface>& get_runtime_interface(){
@@ -47,6 +133,18 @@ namespace wasm {
         return runtime_interface;
     }
 
+    void set_wasm_code_cache_size(uint64_t max_memory_size) {
+        get_wasm_code_cache().set_max_memory_size(max_memory_size);
+    }
+
+    wasm_code_cache_stats get_wasm_code_cache_stats() {
+        return get_wasm_code_cache().get_stats();
+    }
+
+    std::vector<std::vector<uint8_t>> get_wasm_cached_codes() {
+        return get_wasm_code_cache().get_codes();
+    }
+
 
     wasm_interface::wasm_interface() {}
     wasm_interface::~wasm_interface() {}
@@ -57,21 +155,14 @@ namespace wasm {
 
     std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const vector <uint8_t> &code) {
 
-        try {
-            if(!get_wasm_instantiation_cache().has_value()){
-                 get_wasm_instantiation_cache() = std::map <code_version_t, std::shared_ptr<wasm_instantiated_module_interface>>{};
-            }
+        auto code_id             = Hash(code.begin(), code.end());
+        auto pInstantiated_module = get_wasm_code_cache().get(code_id);
+        if (pInstantiated_module)
+            return pInstantiated_module;
 
-            auto code_id = Hash(code.begin(), code.end());
-            auto it = get_wasm_instantiation_cache()->find(code_id);
-            if (it == get_wasm_instantiation_cache()->end()) {
-                get_wasm_instantiation_cache().value()[code_id] = get_runtime_interface()->instantiate_module((const char*)code.data(), code.size());
-                return get_wasm_instantiation_cache().value()[code_id];
-            }
-            return it->second;
-        } catch (...) {
-            throw;
-        }
+        // parse out of the cache lock, modules of different contracts can be instantiated in parallel
+        pInstantiated_module = get_runtime_interface()->instantiate_module((const char*)code.data(), code.size());
+        return get_wasm_code_cache().put(code_id, code, pInstantiated_module);
 
     }
 
@@ -104,8 +195,21 @@ namespace wasm {
 
     }
 
+    void wasm_interface::preload(const vector <uint8_t> &code) {
+
+        get_instantiated_backend(code);
+
+    }
+
     void wasm_interface::initialize(vm_type vm) {
 
+        // the cached modules refer to the runtime they were instantiated by, keep it once created
+        static std::optional<vm_type> runtime_vm;
+        if (get_runtime_interface() && runtime_vm == vm)
+            return;
+
+        get_wasm_code_cache().clear();
+        runtime_vm = vm;
         if (vm == wasm::vm_type::eos_vm)
             get_runtime_interface() = std::make_shared<wasm::wasm_vm_runtime<vm::interpreter>>();
         else if (vm == wasm::vm_type::eos_vm_jit)
@@ -989,5 +1093,5 @@ namespace wasm {
 
 extern  void wasm_code_cache_free() {
      //free heap before shut down
-     wasm::get_wasm_instantiation_cache().reset();
+     wasm::get_wasm_code_cache().clear();
 }
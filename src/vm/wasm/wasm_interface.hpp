@@ -14,6 +14,21 @@ namespace wasm {
         eos_vm_jit
     };
 
+    struct wasm_code_cache_stats {
+        uint64_t hits            = 0;
+        uint64_t misses          = 0;
+        uint64_t evictions       = 0;
+        uint64_t count           = 0;
+        uint64_t memory_size     = 0;
+        uint64_t max_memory_size = 0;
+    };
+
+    // bound the memory of the instantiated module cache, the least recently used modules are evicted
+    void set_wasm_code_cache_size(uint64_t max_memory_size);
+    wasm_code_cache_stats get_wasm_code_cache_stats();
+    // the codes of the cached modules, the most recently used first
+    std::vector<std::vector<uint8_t>> get_wasm_cached_codes();
+
     class wasm_interface {
 
     public:
@@ -25,6 +40,8 @@ namespace wasm {
         void initialize(vm_type vm);
         void execute(const vector <uint8_t>& code, wasm_context_interface *pWasmContext);
         void validate(const vector <uint8_t>& code);
+        // instantiate the code into the module cache ahead of its first call
+        void preload(const vector <uint8_t>& code);
         void exit();
 
     };
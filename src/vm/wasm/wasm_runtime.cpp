@@ -24,7 +24,13 @@ namespace wasm {
 
         wasm_vm_instantiated_module(wasm_vm_runtime <Impl> *runtime, std::shared_ptr <backend_t> mod) :
                 _runtime(runtime),
-                _instantiated_module(std::move(mod)) {}
+                _instantiated_module(std::move(mod)) {
+            // the module allocator is finalized after parsing, jit code is moved out of it
+            const auto &allocator = _instantiated_module->get_module().allocator;
+            _memory_size = allocator._capacity + (allocator.is_jit ? allocator._code_size : 0);
+        }
+
+        size_t memory_size() const override { return _memory_size; }
 
         void apply(wasm::wasm_context_interface *pContext) override {
 
@@ -65,6 +71,7 @@ namespace wasm {
     private:
         wasm_vm_runtime <Impl> *    _runtime;
         std::shared_ptr <backend_t> _instantiated_module;
+        size_t                      _memory_size = 0;
     };
 
     template<typename Impl>
@@ -8,6 +8,8 @@ namespace wasm {
     class wasm_instantiated_module_interface {
        public:
           virtual void apply(wasm_context_interface* context) = 0;
+          // bytes of memory held by the parsed module and its code
+          virtual size_t memory_size() const = 0;
           virtual ~wasm_instantiated_module_interface();
     };
 
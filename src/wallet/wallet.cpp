@@ -245,6 +245,51 @@ std::tuple<bool, string> CWallet::CommitTx(CBaseTx *pTx) {
 
 }
 
+vector<std::tuple<bool, string>> CWallet::CommitTxBatch(const vector<std::shared_ptr<CBaseTx>> &vptx) {
+    // verify the signatures in parallel before cs_main is held for the whole batch
+    PreVerifyTxSignatures(vptx);
+
+    vector<std::tuple<bool, string>> results;
+    vector<std::shared_ptr<CBaseTx>> acceptedTxs;
+    {
+        LOCK2(cs_main, cs_wallet);
+        vector<CValidationState> states;
+        vector<bool> accepted;
+        uint32_t nAccepted = ::AcceptTxBatchToMemoryPool(mempool, vptx, states, accepted, true);
+        LogPrint(BCLog::INFO, "CommitTxBatch() : accepted %u of %u txs\n", nAccepted, vptx.size());
+
+        CWalletDB walletdb(strWalletFile);
+        results.reserve(vptx.size());
+        acceptedTxs.reserve(nAccepted);
+        for (size_t i = 0; i < vptx.size(); i++) {
+            if (!accepted[i]) {
+                LogPrint(BCLog::INFO, "CommitTxBatch() : invalid transaction %s\n", states[i].GetRejectReason());
+                results.push_back(std::make_tuple(false, states[i].GetRejectReason()));
+                continue;
+            }
+
+            uint256 txid        = vptx[i]->GetHash();
+            unconfirmedTx[txid] = vptx[i]->GetNewInstance();
+            bool flag           = walletdb.WriteUnconfirmedTx(txid, unconfirmedTx[txid]);
+            string message      = txid.ToString();
+            if (!flag)
+                message = strprintf("write unconfirmed tx failed: %s, corrupted wallet?", txid.GetHex());
+
+            // the return of a wasm contract tx replaces the txid, as CommitTx does
+            if (vptx[i]->nTxType == WASM_CONTRACT_TX)
+                message = states[i].GetReturn();
+
+            results.push_back(std::make_tuple(flag, message));
+            acceptedTxs.push_back(vptx[i]);
+        }
+    }
+
+    if (!acceptedTxs.empty())
+        ::RelayTransactions(acceptedTxs);
+
+    return results;
+}
+
 DBErrors CWallet::LoadWallet(bool fFirstRunRet) {
     // fFirstRunRet = false;
     return CWalletDB(strWalletFile, "cr+").LoadWallet(this);
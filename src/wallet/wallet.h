@@ -137,6 +137,8 @@ public:
     static CWallet* GetInstance();
 
     std::tuple<bool,string>  CommitTx(CBaseTx *pTx);
+    // commit the txs in order like CommitTx(), the result of each tx is its txid or the reject reason
+    vector<std::tuple<bool, string>> CommitTxBatch(const vector<std::shared_ptr<CBaseTx>> &vptx);
 };
 
 /** Private key that includes an expiration date in case it never gets used. */